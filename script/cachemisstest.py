@@ -0,0 +1,92 @@
+#!/usr/bin/python
+
+import sys
+import os
+
+
+def count_misses(input_program, set_type, thread, iteration, txn_size, key_range, insertion, deletion):
+    pipe = os.popen(
+        "perf stat -x, -e cache-misses "
+        + input_program
+        + " {0} {1} {2} {3} {4} {5} {6} 2>&1".format(
+            set_type, thread, iteration, txn_size, key_range, insertion, deletion
+        )
+    )
+    misses = 0
+    for line in pipe:
+        fields = line.strip().split(",")
+        if len(fields) > 2 and fields[2] == "cache-misses" and fields[0].isdigit():
+            misses = int(fields[0])
+    pipe.close()
+    return misses
+
+
+def main():
+    import optparse
+
+    parser = optparse.OptionParser(
+        usage="\n\t%executable_name num_threads num_iterations txn_size percent_insertion percent_deletion average"
+    )
+
+    (options, args) = parser.parse_args(sys.argv[1:])
+    input_program = args[0]
+
+    # Cache misses per operation of the pointer based skiplist against the
+    # wide node B+-tree. A run without iterations only fills the set, its
+    # misses are taken off so that what is left belongs to the operations.
+    pq_dict = {
+        3: "TXNSKIP",
+        15: "TXNBTREE",
+    }
+
+    thread = int(args[1])
+    iteration = int(args[2])
+    txn_size = int(args[3])
+    insertion = int(args[4])
+    deletion = int(args[5])
+    average = int(args[6])
+    ops = thread * iteration * txn_size
+    for pq_type in [3, 15]:
+        list_type = pq_dict[pq_type]
+        rows = []
+        for key_range in [1000, 10000, 100000, 1000000, 10000000]:
+            misses = 0.0
+            for i in range(0, average):
+                total = count_misses(
+                    input_program, pq_type, thread, iteration, txn_size,
+                    key_range, insertion, deletion,
+                )
+                prefill = count_misses(
+                    input_program, pq_type, thread, 0, txn_size,
+                    key_range, insertion, deletion,
+                )
+                misses = misses + float(total - prefill) / ops / average
+            print(
+                list_type
+                + " Key {0} Thread {1} Txn {2}".format(key_range, thread, txn_size)
+                + " Cache Misses per Op: {0}".format(misses)
+            )
+            rows.append([str(key_range), str(misses)])
+        f = open(
+            "cachemiss_"
+            + list_type
+            + "_thread_"
+            + str(thread)
+            + "_iter_"
+            + str(iteration)
+            + "_txn_"
+            + str(txn_size)
+            + "_ins_"
+            + str(insertion)
+            + "_del_"
+            + str(deletion),
+            "w",
+        )
+        for r in rows:
+            f.write(", ".join(r))
+            f.write(",\n")
+        f.close()
+
+
+if __name__ == "__main__":
+    main()
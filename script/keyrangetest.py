@@ -0,0 +1,93 @@
+#!/usr/bin/python
+
+import sys
+import os
+import re
+
+
+re_time = re.compile(r"CPU Time: (.*?)s Wall Time: (.*?)s")
+re_txn = re.compile(r"Total commit (.*?), abort \(total/fake\) (.*?)/(.*?)$")
+
+
+def main():
+    import optparse
+
+    parser = optparse.OptionParser(
+        usage="\n\t%executable_name num_threads num_iterations txn_size percent_insertion percent_deletion average"
+    )
+
+    (options, args) = parser.parse_args(sys.argv[1:])
+    input_program = args[0]
+
+    # Ordered sets compared as the key range grows from 1K to 100M
+    pq_dict = {
+        3: "TXNSKIP",
+        5: "STMSKIP",
+        11: "TXNBST",
+    }
+
+    thread = int(args[1])
+    iteration = int(args[2])
+    txn_size = int(args[3])
+    insertion = int(args[4])
+    deletion = int(args[5])
+    average = int(args[6])
+    for pq_type in [3, 5, 11]:
+        list_type = pq_dict[pq_type]
+        rows = []
+        for key_range in [1000, 10000, 100000, 1000000, 10000000, 100000000]:
+            wall_time = 0.0
+            commit = 0
+            fake_abort = 0
+            for i in range(0, average):
+                pipe = os.popen(
+                    input_program
+                    + " {0} {1} {2} {3} {4} {5} {6}".format(
+                        pq_type,
+                        thread,
+                        iteration,
+                        txn_size,
+                        key_range,
+                        insertion,
+                        deletion,
+                    )
+                )
+                for line in pipe:
+                    match = re_time.match(line)
+                    if match:
+                        wall_time = wall_time + float(match.group(2)) / average
+                    match = re_txn.match(line)
+                    if match:
+                        commit = commit + int(match.group(1)) / average
+                        fake_abort = fake_abort + int(match.group(3)) / average
+            print(
+                list_type
+                + " Key {0} Thread {1} Txn {2}".format(key_range, thread, txn_size)
+                + " Wall Time: {0} Commit: {1}, Fake Abort {2}".format(
+                    wall_time, commit, fake_abort
+                )
+            )
+            rows.append([str(key_range), str(wall_time), str(commit), str(fake_abort)])
+        f = open(
+            "walltime_keyrange_"
+            + list_type
+            + "_thread_"
+            + str(thread)
+            + "_iter_"
+            + str(iteration)
+            + "_txn_"
+            + str(txn_size)
+            + "_ins_"
+            + str(insertion)
+            + "_del_"
+            + str(deletion),
+            "w",
+        )
+        for r in rows:
+            f.write(", ".join(r))
+            f.write(",\n")
+        f.close()
+
+
+if __name__ == "__main__":
+    main()
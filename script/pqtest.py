@@ -13,7 +13,7 @@ def main():
     import optparse
 
     parser = optparse.OptionParser(
-        usage="\n\t%executable_name num_iterations key_range percent_insertion percent_deletion percent_update average"
+        usage="\n\t%executable_name num_iterations key_range percent_insertion percent_deletion percent_update average [scan_length]"
     )
 
     (options, args) = parser.parse_args(sys.argv[1:])
@@ -34,6 +34,28 @@ def main():
         7: "BSTMAP",
         8: "OBSSKIP",
         9: "OBSLIST",
+        10: "TXNHASH",
+        11: "TXNBST",
+        12: "TXNPQ",
+        13: "TXNSPRAYPQ",
+        14: "TXNQUEUE",
+        15: "TXNBTREE",
+        16: "TXNBTREEMAP",
+        17: "TXNSKIPMAP",
+        18: "TXNMDLIST",
+        19: "TXNUNROLLEDLIST",
+        20: "TXNVECTOR",
+        21: "TXNGRAPH",
+        22: "TXNSTRMAP",
+        23: "TXNSKIPBATCH",
+        24: "TRANSMAPBATCH",
+        25: "TXNMULTI",
+        26: "TXNLISTDYN",
+        27: "TXNSKIPDYN",
+        28: "TXNLISTWF",
+        29: "TXNSKIPWF",
+        30: "TXNSKIPRANGE",
+        31: "TXNMAPCOUNTER",
     }
 
     iteration = int(args[1])
@@ -42,6 +64,8 @@ def main():
     deletion = int(args[4])
     update = int(args[5])
     average = int(args[6])
+    # Keys per scan for TXNSKIPRANGE, meant to be swept from 10 to 10000
+    scan_length = int(args[7]) if len(args) > 7 else 100
     # for pq_type in [0, 1, 2, 3, 4, 5]:
     for pq_type in [7]:
         list_type = pq_dict[pq_type]
@@ -50,7 +74,11 @@ def main():
         wall_time_perpq = []
         for thread in [1, 2, 4, 8, 16, 32, 64, 128]:
             wall_time_perthread = []
-            for txn_size in [1, 2, 4, 8, 16]:
+            # Batches for TXNSKIPBATCH, meant to run on a key_range of 10M
+            txn_sizes = [1, 2, 4, 8, 16]
+            if pq_type == 23:
+                txn_sizes = [16, 64, 256, 1024, 4096]
+            for txn_size in txn_sizes:
                 cpu_time = 0.0
                 wall_time = 0.0
                 commit = 0
@@ -59,7 +87,7 @@ def main():
                 for i in range(0, average):
                     pipe = os.popen(
                         input_program
-                        + " {0} {1} {2} {3} {4} {5} {6} {7}".format(
+                        + " {0} {1} {2} {3} {4} {5} {6} {7} {8}".format(
                             pq_type,
                             thread,
                             iteration,
@@ -68,6 +96,7 @@ def main():
                             insertion,
                             deletion,
                             update,
+                            scan_length,
                         )
                     )
                     for line in pipe:
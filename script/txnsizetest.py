@@ -0,0 +1,88 @@
+#!/usr/bin/python
+
+import sys
+import os
+import re
+
+
+re_time = re.compile(r"CPU Time: (.*?)s Wall Time: (.*?)s")
+re_txn = re.compile(r"Total commit (.*?), abort \(total/fake\) (.*?)/(.*?)$")
+
+
+def main():
+    import optparse
+
+    parser = optparse.OptionParser(
+        usage="\n\t%executable_name num_threads num_iterations key_range average"
+    )
+
+    (options, args) = parser.parse_args(sys.argv[1:])
+    input_program = args[0]
+
+    # Batch ingest and purge as the transaction grows from 1K to 64K ops
+    pq_dict = {
+        23: "TXNSKIPBATCH",
+        24: "TRANSMAPBATCH",
+    }
+
+    thread = int(args[1])
+    iteration = int(args[2])
+    key_range = int(args[3])
+    average = int(args[4])
+    for pq_type in [23, 24]:
+        list_type = pq_dict[pq_type]
+        rows = []
+        for txn_size in [1024, 2048, 4096, 8192, 16384, 32768, 65536]:
+            wall_time = 0.0
+            commit = 0
+            abort = 0
+            for i in range(0, average):
+                pipe = os.popen(
+                    input_program
+                    + " {0} {1} {2} {3} {4}".format(
+                        pq_type,
+                        thread,
+                        iteration,
+                        txn_size,
+                        key_range,
+                    )
+                )
+                for line in pipe:
+                    match = re_time.match(line)
+                    if match:
+                        wall_time = wall_time + float(match.group(2)) / average
+                    match = re_txn.match(line)
+                    if match:
+                        commit = commit + int(match.group(1)) / average
+                        abort = abort + int(match.group(2)) / average
+            ops_per_sec = commit * txn_size / wall_time if wall_time > 0 else 0
+            print(
+                list_type
+                + " Txn {0} Thread {1} Key {2}".format(txn_size, thread, key_range)
+                + " Wall Time: {0} Commit: {1}, Abort {2}, Ops/s {3}".format(
+                    wall_time, commit, abort, ops_per_sec
+                )
+            )
+            rows.append(
+                [str(txn_size), str(wall_time), str(commit), str(abort),
+                 str(ops_per_sec)]
+            )
+        f = open(
+            "walltime_txnsize_"
+            + list_type
+            + "_thread_"
+            + str(thread)
+            + "_iter_"
+            + str(iteration)
+            + "_key_"
+            + str(key_range),
+            "w",
+        )
+        for r in rows:
+            f.write(", ".join(r))
+            f.write(",\n")
+        f.close()
+
+
+if __name__ == "__main__":
+    main()
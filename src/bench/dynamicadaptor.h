@@ -0,0 +1,157 @@
+#ifndef DYNAMICADAPTOR_H
+#define DYNAMICADAPTOR_H
+
+#include <vector>
+
+#include "bench/setadaptor.h"
+#include "common/allocator.h"
+#include "common/metrics.h"
+#include "translink/list/translist.h"
+#include "translink/skiplist/transskip.h"
+
+// The codes match those of TransList and TransSkip
+enum DynamicOpType { DYNAMIC_FIND = 0, DYNAMIC_INSERT, DYNAMIC_DELETE };
+
+enum DynamicGuard {
+  DYNAMIC_ALWAYS = 0,
+  DYNAMIC_IF_SUCCEEDED,
+  DYNAMIC_IF_FAILED
+};
+
+enum DynamicResult {
+  DYNAMIC_PENDING = 0,
+  DYNAMIC_SUCCEEDED,
+  DYNAMIC_FAILED,
+  DYNAMIC_SKIPPED
+};
+
+struct DynamicOperator {
+  uint8_t type;
+  uint8_t guard;
+  uint32_t dep;  // op the guard reads
+  uint32_t key;
+  uint8_t result;  // written back by ExecuteOps
+};
+
+typedef std::vector<DynamicOperator> DynamicOpArray;
+
+template <typename T>
+class DynamicAdaptor {};
+
+// In wait-free mode a transaction can be rerun once for each older one, so
+// there is room for that many descriptors
+template <>
+class DynamicAdaptor<TransList> {
+ public:
+  DynamicAdaptor(uint64_t cap, uint64_t threadCount, uint32_t transSize,
+                 bool waitFree)
+      : m_descAllocator(cap * threadCount *
+                            TransList::DynamicSizeOf(transSize) *
+                            (waitFree ? threadCount : 1),
+                        threadCount, TransList::DynamicSizeOf(transSize)),
+        m_nodeAllocator(cap * threadCount * sizeof(TransList::Node) * transSize,
+                        threadCount, sizeof(TransList::Node)),
+        m_nodeDescAllocator(cap * threadCount * sizeof(TransList::NodeDesc) *
+                                transSize * (waitFree ? threadCount : 1),
+                            threadCount, sizeof(TransList::NodeDesc)),
+        m_list(&m_nodeAllocator, &m_descAllocator, &m_nodeDescAllocator),
+        m_waitFree(waitFree) {}
+
+  void Init() {
+    m_descAllocator.Init();
+    m_nodeAllocator.Init();
+    m_nodeDescAllocator.Init();
+  }
+
+  void Uninit() {}
+
+  bool ExecuteOps(DynamicOpArray& ops) {
+    TransList::Desc* desc = m_list.AllocateDesc(ops.size());
+    TransList::Program* program = TransList::GetProgram(desc);
+
+    for (uint32_t i = 0; i < ops.size(); ++i) {
+      desc->ops[i].type = ops[i].type;
+      desc->ops[i].key = ops[i].key;
+      program->steps[i].guard = ops[i].guard;
+      program->steps[i].dep = ops[i].dep;
+    }
+
+    bool ret = m_list.ExecuteDynamic(desc, m_waitFree);
+
+    program = TransList::GetProgram(desc);
+    for (uint32_t i = 0; i < ops.size(); ++i) {
+      ops[i].result = program->steps[i].result;
+    }
+
+    return ret;
+  }
+
+  Metrics GetMetrics() { return m_list.GetMetrics(); }
+
+ private:
+  Allocator<TransList::Desc> m_descAllocator;
+  Allocator<TransList::Node> m_nodeAllocator;
+  Allocator<TransList::NodeDesc> m_nodeDescAllocator;
+  TransList m_list;
+  bool m_waitFree;
+};
+
+template <>
+class DynamicAdaptor<trans_skip> {
+ public:
+  DynamicAdaptor(uint64_t cap, uint64_t threadCount, uint32_t transSize,
+                 bool waitFree)
+      : m_descAllocator(cap * threadCount * Desc::DynamicSizeOf(transSize) *
+                            (waitFree ? threadCount : 1),
+                        threadCount, Desc::DynamicSizeOf(transSize)),
+        m_nodeDescAllocator(cap * threadCount * sizeof(NodeDesc) * transSize *
+                                (waitFree ? threadCount : 1),
+                            threadCount, sizeof(NodeDesc)),
+        m_waitFree(waitFree) {
+    m_skiplist = transskip_alloc(&m_descAllocator, &m_nodeDescAllocator);
+    init_transskip_subsystem();
+  }
+
+  ~DynamicAdaptor() { transskip_free(m_skiplist); }
+
+  void Init() {
+    m_descAllocator.Init();
+    m_nodeDescAllocator.Init();
+  }
+
+  void Uninit() { destroy_transskip_subsystem(); }
+
+  bool ExecuteOps(DynamicOpArray& ops) {
+    Desc* desc = m_descAllocator.Alloc();
+    desc->size = ops.size();
+    desc->status = LIVE;
+    Program* program = GetProgram(desc);
+
+    for (uint32_t i = 0; i < ops.size(); ++i) {
+      desc->ops[i].type = ops[i].type;
+      desc->ops[i].key = ops[i].key;
+      desc->ops[i].value = ops[i].key;
+      program->steps[i].guard = ops[i].guard;
+      program->steps[i].dep = ops[i].dep;
+    }
+
+    bool ret = execute_dynamic(m_skiplist, desc, m_waitFree);
+
+    program = GetProgram(desc);
+    for (uint32_t i = 0; i < ops.size(); ++i) {
+      ops[i].result = program->steps[i].result;
+    }
+
+    return ret;
+  }
+
+  Metrics GetMetrics() { return ::GetMetrics(m_skiplist); }
+
+ private:
+  Allocator<Desc> m_descAllocator;
+  Allocator<NodeDesc> m_nodeDescAllocator;
+  trans_skip* m_skiplist;
+  bool m_waitFree;
+};
+
+#endif /* end of include guard: DYNAMICADAPTOR_H */
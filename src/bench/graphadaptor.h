@@ -0,0 +1,86 @@
+#ifndef GRAPHADAPTOR_H
+#define GRAPHADAPTOR_H
+
+#include <vector>
+
+#include "common/allocator.h"
+#include "common/metrics.h"
+#include "translink/graph/transgraph.h"
+
+enum GraphOpType {
+  GRAPH_FIND_VERTEX = 0,
+  GRAPH_INSERT_VERTEX,
+  GRAPH_DELETE_VERTEX,
+  GRAPH_FIND_EDGE,
+  GRAPH_INSERT_EDGE,
+  GRAPH_DELETE_EDGE
+};
+
+struct GraphOperator {
+  uint8_t type;
+  uint32_t src;
+  uint32_t dst;  // ignored by the vertex ops
+};
+
+typedef std::vector<GraphOperator> GraphOpArray;
+
+template <typename T>
+class GraphAdaptor {};
+
+template <>
+class GraphAdaptor<TransGraph> {
+ public:
+  GraphAdaptor(uint64_t cap, uint64_t threadCount, uint32_t transSize,
+               uint32_t vertexCount)
+      : m_descAllocator(cap * threadCount * TransGraph::SizeOf(transSize),
+                        threadCount, TransGraph::SizeOf(transSize)),
+        m_nodeDescAllocator(
+            cap * threadCount * sizeof(TransGraph::NodeDesc) * transSize,
+            threadCount, sizeof(TransGraph::NodeDesc)),
+        m_graph(&m_descAllocator, &m_nodeDescAllocator, vertexCount,
+                threadCount) {}
+
+  void Init() {
+    m_descAllocator.Init();
+    m_nodeDescAllocator.Init();
+  }
+
+  void Uninit() {}
+
+  bool ExecuteOps(const GraphOpArray& ops, int threadId) {
+    TransGraph::Desc* desc = m_graph.AllocateDesc(ops.size());
+    uint32_t* targets = TransGraph::Targets(desc);
+
+    for (uint32_t i = 0; i < ops.size(); ++i) {
+      // TransMap takes a zero value for a missing key
+      desc->ops[i].value = 1;
+
+      if (ops[i].type < GRAPH_FIND_EDGE) {
+        desc->ops[i].type = ops[i].type - GRAPH_FIND_VERTEX;
+        desc->ops[i].key = ops[i].src;
+        targets[i] = TransGraph::VERTEX_TABLE;
+      } else {
+        desc->ops[i].type = ops[i].type - GRAPH_FIND_EDGE;
+        desc->ops[i].key = ops[i].dst;
+        targets[i] = ops[i].src;
+      }
+    }
+
+    return m_graph.ExecuteOps(desc, threadId);
+  }
+
+  uint64_t BreadthFirst(uint32_t root) { return m_graph.BreadthFirst(root); }
+
+  void GetEdges(uint32_t src, std::vector<uint32_t>& dsts) {
+    m_graph.GetEdges(src, dsts);
+  }
+
+  Metrics GetMetrics() { return m_graph.GetMetrics(); }
+
+ private:
+  Allocator<TransGraph::Desc> m_descAllocator;
+  Allocator<TransGraph::NodeDesc> m_nodeDescAllocator;
+  TransGraph m_graph;
+};
+
+#endif /* end of include guard: GRAPHADAPTOR_H */
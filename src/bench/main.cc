@@ -6,6 +6,7 @@
 
 #include <sched.h>
 
+#include <algorithm>
 #include <array>
 #include <boost/random.hpp>
 #include <cassert>
@@ -16,11 +17,73 @@
 #include <thread>
 #include <vector>
 
+#include "bench/dynamicadaptor.h"
+#include "bench/graphadaptor.h"
 #include "bench/mapadaptor.h"
+#include "bench/multiadaptor.h"
+#include "bench/pqadaptor.h"
+#include "bench/queueadaptor.h"
+#include "bench/rangeadaptor.h"
 #include "bench/setadaptor.h"
+#include "bench/vectoradaptor.h"
+#include "common/metrics.h"
 #include "common/threadbarrier.h"
 #include "common/timehelper.h"
 
+// Only the timed phase is reported; prefill transactions are excluded by
+// diffing snapshots taken around it. Memory and the shape of a table are
+// those at the end of the run.
+void PrintMetrics(const Metrics& before, const Metrics& after) {
+  Metrics delta = after - before;
+
+  printf("Total commit %lu, abort (total/fake) %lu/%lu\n", delta.commits,
+         delta.aborts, delta.fakeAborts);
+
+  if (delta.parts & METRICS_TRAVERSAL) {
+    const TraversalStats& t = delta.traversal;
+    printf("Traversal searches %lu, visited %lu, marked skipped %lu, restarts "
+           "%lu, unlink CAS failures %lu\n",
+           t.searches, t.visited, t.markedSkipped, t.restarts,
+           t.unlinkCasFailures);
+  }
+
+  if (delta.parts & METRICS_MEMORY) {
+    const MemoryStats& m = delta.memory;
+    printf("Memory live nodes %lu, deleted nodes %lu, descriptors %lu, bytes "
+           "(used/reserved) %lu/%lu\n",
+           m.liveNodes, m.deletedNodes, m.descriptors, m.bytesUsed,
+           m.bytesReserved);
+  }
+
+  if (delta.parts & METRICS_TABLE) {
+    const TableStats& t = delta.table;
+    printf("Table buckets %lu\n", t.buckets);
+
+    if (t.depth > 0) {
+      printf("Spines (allocated/reused/linked) %lu/%lu/%lu, expansions (CAS "
+             "failure/collision) %lu/%lu\n",
+             t.spineAllocations, t.spineReuses, t.spinesLinked,
+             t.casFailureExpansions, t.collisionExpansions);
+      printf("Lookup depth");
+      for (uint32_t i = 0; i < TABLE_MAX_DEPTH; i++) {
+        printf(" %lu", t.lookupDepth[i]);
+      }
+      printf("\n");
+    }
+
+    for (uint32_t i = 0; i < t.depth; i++) {
+      printf("Level %u spines %lu, slots %lu, data nodes %lu, sub spines "
+             "%lu\n",
+             i, t.levels[i].spines, t.levels[i].slots, t.levels[i].dataNodes,
+             t.levels[i].subSpines);
+    }
+  }
+
+  if (delta.parts & METRICS_GC) {
+    fr_gc_print_stats(&delta.gc);
+  }
+}
+
 template <typename T>
 void WorkThread(uint32_t numThread, int threadId, uint32_t testSize,
                 uint32_t tranSize, uint32_t keyRange, uint32_t insertion,
@@ -76,8 +139,6 @@ void Tester(uint32_t numThread, uint32_t testSize, uint32_t tranSize,
 
   SetOpArray ops(1);
 
-  // TODO: don't count the aborts caused in the prefill? the prefill is already
-  // untimed
   for (unsigned int i = 0; i < keyRange; ++i) {
     ops[0].type = INSERT;
     ops[0].key = randomDist(randomGen);
@@ -97,6 +158,8 @@ void Tester(uint32_t numThread, uint32_t testSize, uint32_t tranSize,
                             std::ref(barrier), std::ref(set));
   }
 
+  Metrics before = set.GetMetrics();
+
   barrier.Wait();
 
   {
@@ -108,6 +171,8 @@ void Tester(uint32_t numThread, uint32_t testSize, uint32_t tranSize,
     }
   }
 
+  PrintMetrics(before, set.GetMetrics());
+
   set.Uninit();
 }
 
@@ -198,6 +263,103 @@ void MapTester(uint32_t numThread, uint32_t testSize, uint32_t tranSize,
                             update, std::ref(barrier), std::ref(map));
   }
 
+  Metrics before = map.GetMetrics();
+
+  barrier.Wait();
+
+  {
+    ScopedTimer timer(true);
+
+    // Wait for the threads to finish
+    for (unsigned i = 0; i < thread.size(); i++) {
+      thread[i].join();
+    }
+  }
+
+  PrintMetrics(before, map.GetMetrics());
+
+  map.Uninit();
+}
+
+// Ingest and purge in large transactions: every thread inserts tranSize keys
+// of its own above the key range and then deletes them again, so no
+// transaction fails on a key another one holds and the time is down to the
+// size of the transactions
+template <typename T>
+void BatchWorkThread(uint32_t numThread, int threadId, uint32_t testSize,
+                     uint32_t tranSize, uint32_t keyRange,
+                     ThreadBarrier& barrier, T& map) {
+  // set affinity for each thread
+  cpu_set_t cpu = {{0}};
+  CPU_SET(threadId, &cpu);
+  sched_setaffinity(0, sizeof(cpu_set_t), &cpu);
+
+  map.Init();
+
+  barrier.Wait();
+
+  MapOpArray ops(tranSize);
+  uint32_t base = keyRange + 1 + (threadId - 1) * tranSize;
+
+  for (unsigned int i = 0; i < testSize; ++i) {
+    for (uint32_t t = 0; t < tranSize; ++t) {
+      ops[t].type = i % 2 == 0 ? MAP_INSERT : MAP_DELETE;
+      ops[t].key = base + t;
+      ops[t].value = base + t;
+    }
+
+    map.ExecuteOps(ops, threadId);
+  }
+
+  map.Uninit();
+}
+
+template <typename T>
+void BatchTester(uint32_t numThread, uint32_t testSize, uint32_t tranSize,
+                 uint32_t keyRange, MapAdaptor<T>& map) {
+  std::vector<std::thread> thread(numThread);
+  ThreadBarrier barrier(numThread + 1);
+
+  double startTime = Time::GetWallTime();
+  boost::mt19937 randomGen;
+  randomGen.seed(startTime - 10);
+  boost::uniform_int<uint32_t> randomDist(1, keyRange);
+
+  map.Init();
+
+  // Descriptors are sized for whole batches, so the prefill goes in batches
+  // too. Keys are drawn as in MapTester and each goes in once, in order.
+  std::set<uint32_t> keys;
+  for (unsigned int i = 0; i < keyRange; ++i) {
+    keys.insert(randomDist(randomGen));
+  }
+
+  MapOpArray ops;
+  ops.reserve(tranSize);
+
+  for (std::set<uint32_t>::iterator it = keys.begin(); it != keys.end();) {
+    ops.clear();
+
+    for (; it != keys.end() && ops.size() < tranSize; ++it) {
+      MapOperator op;
+      op.type = MAP_INSERT;
+      op.key = *it;
+      op.value = randomDist(randomGen);
+      ops.push_back(op);
+    }
+
+    map.ExecuteOps(ops, 0);
+  }
+
+  // Create joinable threads
+  for (unsigned i = 0; i < numThread; i++) {
+    thread[i] = std::thread(BatchWorkThread<MapAdaptor<T> >, numThread, i + 1,
+                            testSize, tranSize, keyRange, std::ref(barrier),
+                            std::ref(map));
+  }
+
+  Metrics before = map.GetMetrics();
+
   barrier.Wait();
 
   {
@@ -209,6 +371,8 @@ void MapTester(uint32_t numThread, uint32_t testSize, uint32_t tranSize,
     }
   }
 
+  PrintMetrics(before, map.GetMetrics());
+
   map.Uninit();
 }
 
@@ -318,6 +482,8 @@ void BoostingMapTester(uint32_t numThread, uint32_t testSize, uint32_t tranSize,
                             deletion, update, std::ref(barrier), std::ref(set));
   }
 
+  Metrics before = set.GetMetrics();
+
   barrier.Wait();
 
   {
@@ -329,93 +495,1134 @@ void BoostingMapTester(uint32_t numThread, uint32_t testSize, uint32_t tranSize,
     }
   }
 
+  PrintMetrics(before, set.GetMetrics());
+
   set.Uninit();
 }
 
-int main(int argc, const char* argv[]) {
-  uint32_t setType = 0;
-  uint32_t numThread = 1;
-  uint32_t testSize = 100;
-  uint32_t tranSize = 1;
-  uint32_t keyRange = 100;
-  uint32_t insertion = 50;
-  uint32_t deletion = 50;
-  uint32_t update = 0;
+template <typename T>
+void PQWorkThread(uint32_t numThread, int threadId, uint32_t testSize,
+                  uint32_t tranSize, uint32_t keyRange, uint32_t insertion,
+                  ThreadBarrier& barrier, T& pq) {
+  // set affinity for each thread
+  cpu_set_t cpu = {{0}};
+  CPU_SET(threadId, &cpu);
+  sched_setaffinity(0, sizeof(cpu_set_t), &cpu);
 
-  if (argc > 1) setType = atoi(argv[1]);
-  if (argc > 2) numThread = atoi(argv[2]);
-  if (argc > 3) testSize = atoi(argv[3]);
-  if (argc > 4) tranSize = atoi(argv[4]);
-  if (argc > 5) keyRange = atoi(argv[5]);
-  if (argc > 6) insertion = atoi(argv[6]);
-  if (argc > 7) deletion = atoi(argv[7]);
-  if (argc > 8) update = atoi(argv[8]);
+  double startTime = Time::GetWallTime();
 
-  assert(setType < 10);
-  assert(keyRange < 0xffffffff);
+  boost::mt19937 randomGenKey;
+  boost::mt19937 randomGenOp;
+  randomGenKey.seed(startTime + threadId);
+  randomGenOp.seed(startTime + threadId + 1000);
+  boost::uniform_int<uint32_t> randomDistKey(1, keyRange);
+  boost::uniform_int<uint32_t> randomDistOp(1, 100);
 
-  const char* setName[] = {"TransList",
-                           "RSTMList",
-                           "BoostingList",
-                           "TransSkip",
-                           "BoostingSkip",
-                           "OSTMSkip",
-                           "TransMap",
-                           "BoostingMap"
-                           "ObsSkip",
-                           "ObsList"};
+  pq.Init();
 
-  printf(
-      "Start testing %s with %d threads %d iterations %d txnsize %d unique "
-      "keys %d%% insert %d%% delete %d%% update.\n",
-      setName[setType], numThread, testSize, tranSize, keyRange, insertion,
-      deletion, update);  //(insertion + deletion) >= 100 ? 100 - insertion :
-                          // deletion, update);
+  barrier.Wait();
 
-  uint64_t numNodes = keyRange + testSize;  // note: is this too much?
+  PQOpArray ops(tranSize);
 
-  switch (setType) {
-    case 0: {
-      SetAdaptor<TransList> set(numNodes, numThread + 1, tranSize);
-      Tester(numThread, testSize, tranSize, keyRange, insertion, deletion, set);
-    } break;
-    case 1: {
-      SetAdaptor<RSTMList> set;
-      Tester(numThread, testSize, tranSize, keyRange, insertion, deletion, set);
-    } break;
-    case 2: {
-      SetAdaptor<BoostingList> set;
-      Tester(numThread, testSize, tranSize, keyRange, insertion, deletion, set);
-    } break;
-    case 3: {
-      SetAdaptor<trans_skip> set(numNodes, numThread + 1, tranSize);
-      Tester(numThread, testSize, tranSize, keyRange, insertion, deletion, set);
-    } break;
-    case 4: {
-      SetAdaptor<BoostingSkip> set;
-      Tester(numThread, testSize, tranSize, keyRange, insertion, deletion, set);
-    } break;
-    case 5: {
-      SetAdaptor<stm_skip> set;
-      Tester(numThread, testSize, tranSize, keyRange, insertion, deletion, set);
-    } break;
-    case 6: {
-      MapAdaptor<TransMap> map(numNodes, numThread + 1, tranSize);
-      MapTester(numThread, testSize, tranSize, keyRange, insertion, deletion,
-                update, map);
-    } break;
-    case 7: {
-      MapAdaptor<BoostingMap> map(numNodes, numThread + 1);
-      BoostingMapTester(numThread, testSize, tranSize, keyRange, insertion,
-                        deletion, update, map);
-    } break;
-    case 8: {
-      SetAdaptor<obs_skip> set(testSize, numThread + 1, tranSize);
-      Tester(numThread, testSize, tranSize, keyRange, insertion, deletion, set);
-    } break;
-    case 9: {
-      SetAdaptor<ObsList> set(testSize, numThread + 1, tranSize);
-      Tester(numThread, testSize, tranSize, keyRange, insertion, deletion, set);
+  // Everything that is not an insert pops the minimum
+  for (unsigned int i = 0; i < testSize; ++i) {
+    for (uint32_t t = 0; t < tranSize; ++t) {
+      uint32_t op_dist = randomDistOp(randomGenOp);
+      ops[t].type = op_dist <= insertion ? PQ_INSERT : PQ_DELETEMIN;
+      ops[t].key = randomDistKey(randomGenKey);
+    }
+
+    pq.ExecuteOps(ops);
+  }
+
+  pq.Uninit();
+}
+
+template <typename T>
+void PQTester(uint32_t numThread, uint32_t testSize, uint32_t tranSize,
+              uint32_t keyRange, uint32_t insertion, PQAdaptor<T>& pq) {
+  std::vector<std::thread> thread(numThread);
+  ThreadBarrier barrier(numThread + 1);
+
+  double startTime = Time::GetWallTime();
+  boost::mt19937 randomGen;
+  randomGen.seed(startTime - 10);
+  boost::uniform_int<uint32_t> randomDist(1, keyRange);
+
+  pq.Init();
+
+  PQOpArray ops(1);
+
+  for (unsigned int i = 0; i < keyRange; ++i) {
+    ops[0].type = PQ_INSERT;
+    ops[0].key = randomDist(randomGen);
+    pq.ExecuteOps(ops);
+  }
+
+  // Create joinable threads
+  for (unsigned i = 0; i < numThread; i++) {
+    thread[i] =
+        std::thread(PQWorkThread<PQAdaptor<T> >, numThread, i + 1, testSize,
+                    tranSize, keyRange, insertion, std::ref(barrier),
+                    std::ref(pq));
+  }
+
+  Metrics before = pq.GetMetrics();
+
+  barrier.Wait();
+
+  {
+    ScopedTimer timer(true);
+
+    // Wait for the threads to finish
+    for (unsigned i = 0; i < thread.size(); i++) {
+      thread[i].join();
+    }
+  }
+
+  PrintMetrics(before, pq.GetMetrics());
+
+  pq.Uninit();
+}
+
+// Producers only enqueue and consumers only dequeue. A lone thread does both,
+// enqueueing insertion percent of the time.
+template <typename T>
+void QueueWorkThread(uint32_t numThread, int threadId, uint32_t testSize,
+                     uint32_t tranSize, uint32_t keyRange, uint32_t insertion,
+                     uint32_t producers, ThreadBarrier& barrier, T& queue) {
+  // set affinity for each thread
+  cpu_set_t cpu = {{0}};
+  CPU_SET(threadId, &cpu);
+  sched_setaffinity(0, sizeof(cpu_set_t), &cpu);
+
+  double startTime = Time::GetWallTime();
+
+  boost::mt19937 randomGenKey;
+  boost::mt19937 randomGenOp;
+  randomGenKey.seed(startTime + threadId);
+  randomGenOp.seed(startTime + threadId + 1000);
+  boost::uniform_int<uint32_t> randomDistKey(1, keyRange);
+  boost::uniform_int<uint32_t> randomDistOp(1, 100);
+
+  queue.Init();
+
+  barrier.Wait();
+
+  QueueOpArray ops(tranSize);
+
+  for (unsigned int i = 0; i < testSize; ++i) {
+    for (uint32_t t = 0; t < tranSize; ++t) {
+      bool produce = numThread == 1 ? randomDistOp(randomGenOp) <= insertion
+                                    : (uint32_t)threadId <= producers;
+      ops[t].type = produce ? QUEUE_ENQUEUE : QUEUE_DEQUEUE;
+      ops[t].value = randomDistKey(randomGenKey);
+    }
+
+    queue.ExecuteOps(ops);
+  }
+
+  queue.Uninit();
+}
+
+template <typename T>
+void QueueTester(uint32_t numThread, uint32_t testSize, uint32_t tranSize,
+                 uint32_t keyRange, uint32_t insertion,
+                 QueueAdaptor<T>& queue) {
+  std::vector<std::thread> thread(numThread);
+  ThreadBarrier barrier(numThread + 1);
+
+  double startTime = Time::GetWallTime();
+  boost::mt19937 randomGen;
+  randomGen.seed(startTime - 10);
+  boost::uniform_int<uint32_t> randomDist(1, keyRange);
+
+  // insertion percent of the threads produce, at least one of each kind
+  uint32_t producers = numThread * insertion / 100;
+  if (producers < 1) producers = 1;
+  if (producers > numThread - 1 && numThread > 1) producers = numThread - 1;
+
+  queue.Init();
+
+  QueueOpArray ops(1);
+
+  // Start with keyRange items queued
+  for (unsigned int i = 0; i < keyRange; ++i) {
+    ops[0].type = QUEUE_ENQUEUE;
+    ops[0].value = randomDist(randomGen);
+    queue.ExecuteOps(ops);
+  }
+
+  // Create joinable threads
+  for (unsigned i = 0; i < numThread; i++) {
+    thread[i] = std::thread(QueueWorkThread<QueueAdaptor<T> >, numThread,
+                            i + 1, testSize, tranSize, keyRange, insertion,
+                            producers, std::ref(barrier), std::ref(queue));
+  }
+
+  Metrics before = queue.GetMetrics();
+
+  barrier.Wait();
+
+  {
+    ScopedTimer timer(true);
+
+    // Wait for the threads to finish
+    for (unsigned i = 0; i < thread.size(); i++) {
+      thread[i].join();
+    }
+  }
+
+  PrintMetrics(before, queue.GetMetrics());
+
+  queue.Uninit();
+}
+
+// Reads and writes go to random indices below keyRange, the size the vector
+// starts with, so they fail once pops shrink it below the index
+template <typename T>
+void VectorWorkThread(uint32_t numThread, int threadId, uint32_t testSize,
+                      uint32_t tranSize, uint32_t keyRange, uint32_t insertion,
+                      uint32_t deletion, uint32_t update,
+                      ThreadBarrier& barrier, T& vector) {
+  // set affinity for each thread
+  cpu_set_t cpu = {{0}};
+  CPU_SET(threadId, &cpu);
+  sched_setaffinity(0, sizeof(cpu_set_t), &cpu);
+
+  double startTime = Time::GetWallTime();
+
+  boost::mt19937 randomGenKey;
+  boost::mt19937 randomGenOp;
+  randomGenKey.seed(startTime + threadId);
+  randomGenOp.seed(startTime + threadId + 1000);
+  boost::uniform_int<uint32_t> randomDistKey(0, keyRange - 1);
+  boost::uniform_int<uint32_t> randomDistOp(1, 100);
+
+  vector.Init();
+
+  barrier.Wait();
+
+  VectorOpArray ops(tranSize);
+
+  for (unsigned int i = 0; i < testSize; ++i) {
+    for (uint32_t t = 0; t < tranSize; ++t) {
+      uint32_t op_dist = randomDistOp(randomGenOp);
+
+      if (op_dist <= insertion) {
+        ops[t].type = VECTOR_PUSH;
+      } else if (op_dist <= insertion + deletion) {
+        ops[t].type = VECTOR_POP;
+      } else if (op_dist <= insertion + deletion + update) {
+        ops[t].type = VECTOR_WRITE;
+      } else {
+        ops[t].type = VECTOR_READ;
+      }
+
+      ops[t].index = randomDistKey(randomGenKey);
+      ops[t].value = randomDistKey(randomGenKey);
+    }
+
+    vector.ExecuteOps(ops);
+  }
+
+  vector.Uninit();
+}
+
+template <typename T>
+void VectorTester(uint32_t numThread, uint32_t testSize, uint32_t tranSize,
+                  uint32_t keyRange, uint32_t insertion, uint32_t deletion,
+                  uint32_t update, VectorAdaptor<T>& vector) {
+  std::vector<std::thread> thread(numThread);
+  ThreadBarrier barrier(numThread + 1);
+
+  double startTime = Time::GetWallTime();
+  boost::mt19937 randomGen;
+  randomGen.seed(startTime - 10);
+  boost::uniform_int<uint32_t> randomDist(1, keyRange);
+
+  vector.Init();
+
+  VectorOpArray ops(1);
+
+  // Start with keyRange elements
+  for (unsigned int i = 0; i < keyRange; ++i) {
+    ops[0].type = VECTOR_PUSH;
+    ops[0].value = randomDist(randomGen);
+    vector.ExecuteOps(ops);
+  }
+
+  // Create joinable threads
+  for (unsigned i = 0; i < numThread; i++) {
+    thread[i] = std::thread(VectorWorkThread<VectorAdaptor<T> >, numThread,
+                            i + 1, testSize, tranSize, keyRange, insertion,
+                            deletion, update, std::ref(barrier),
+                            std::ref(vector));
+  }
+
+  Metrics before = vector.GetMetrics();
+
+  barrier.Wait();
+
+  {
+    ScopedTimer timer(true);
+
+    // Wait for the threads to finish
+    for (unsigned i = 0; i < thread.size(); i++) {
+      thread[i].join();
+    }
+  }
+
+  PrintMetrics(before, vector.GetMetrics());
+
+  vector.Uninit();
+}
+
+// Edges go between random vertices. An update moves an edge: it deletes one
+// and inserts one from the same vertex in the same transaction.
+template <typename T>
+void GraphWorkThread(uint32_t numThread, int threadId, uint32_t testSize,
+                     uint32_t tranSize, uint32_t keyRange, uint32_t insertion,
+                     uint32_t deletion, uint32_t update, ThreadBarrier& barrier,
+                     T& graph) {
+  // set affinity for each thread
+  cpu_set_t cpu = {{0}};
+  CPU_SET(threadId, &cpu);
+  sched_setaffinity(0, sizeof(cpu_set_t), &cpu);
+
+  double startTime = Time::GetWallTime();
+
+  boost::mt19937 randomGenKey;
+  boost::mt19937 randomGenOp;
+  randomGenKey.seed(startTime + threadId);
+  randomGenOp.seed(startTime + threadId + 1000);
+  boost::uniform_int<uint32_t> randomDistKey(0, keyRange - 1);
+  boost::uniform_int<uint32_t> randomDistOp(1, 100);
+
+  graph.Init();
+
+  barrier.Wait();
+
+  GraphOpArray ops(tranSize);
+  std::vector<uint32_t> edges;
+
+  for (unsigned int i = 0; i < testSize; ++i) {
+    for (uint32_t t = 0; t < tranSize; ++t) {
+      uint32_t op_dist = randomDistOp(randomGenOp);
+
+      ops[t].src = randomDistKey(randomGenKey);
+      ops[t].dst = randomDistKey(randomGenKey);
+
+      if (op_dist <= insertion) {
+        ops[t].type = GRAPH_INSERT_EDGE;
+        continue;
+      }
+
+      // A random edge to delete, find or move is almost never there, and the
+      // transaction would abort on it. Take one the source has instead.
+      graph.GetEdges(ops[t].src, edges);
+
+      if (!edges.empty()) {
+        ops[t].dst = edges[randomDistKey(randomGenKey) % edges.size()];
+      }
+
+      if (op_dist <= insertion + deletion) {
+        ops[t].type = GRAPH_DELETE_EDGE;
+      } else if (op_dist <= insertion + deletion + update &&
+                 t + 1 < tranSize) {
+        ops[t].type = GRAPH_DELETE_EDGE;
+        ops[t + 1].type = GRAPH_INSERT_EDGE;
+        ops[t + 1].src = ops[t].src;
+        ops[t + 1].dst = randomDistKey(randomGenKey);
+        t++;
+      } else {
+        ops[t].type = GRAPH_FIND_EDGE;
+      }
+    }
+
+    graph.ExecuteOps(ops, threadId);
+  }
+
+  graph.Uninit();
+}
+
+// Searches from random roots until the updating threads are done
+template <typename T>
+void GraphSearchThread(int threadId, uint32_t keyRange, ThreadBarrier& barrier,
+                       volatile bool& done, uint64_t& searches,
+                       uint64_t& reached, T& graph) {
+  cpu_set_t cpu = {{0}};
+  CPU_SET(threadId, &cpu);
+  sched_setaffinity(0, sizeof(cpu_set_t), &cpu);
+
+  boost::mt19937 randomGen;
+  randomGen.seed(Time::GetWallTime() + threadId);
+  boost::uniform_int<uint32_t> randomDist(0, keyRange - 1);
+
+  barrier.Wait();
+
+  while (!done) {
+    reached += graph.BreadthFirst(randomDist(randomGen));
+    searches++;
+  }
+}
+
+// Every vertex starts out with prefillEdges edges, added in the transaction
+// that adds the vertex. One more thread than asked for runs breadth first
+// searches while the others update.
+template <typename T>
+void GraphTester(uint32_t numThread, uint32_t testSize, uint32_t tranSize,
+                 uint32_t keyRange, uint32_t insertion, uint32_t deletion,
+                 uint32_t update, uint32_t prefillEdges,
+                 GraphAdaptor<T>& graph) {
+  std::vector<std::thread> thread(numThread);
+  ThreadBarrier barrier(numThread + 2);
+
+  double startTime = Time::GetWallTime();
+  boost::mt19937 randomGen;
+  randomGen.seed(startTime - 10);
+  boost::uniform_int<uint32_t> randomDist(0, keyRange - 1);
+
+  graph.Init();
+
+  GraphOpArray ops;
+
+  for (unsigned int i = 0; i < keyRange; ++i) {
+    ops.resize(1);
+    ops[0].type = GRAPH_INSERT_VERTEX;
+    ops[0].src = i;
+
+    while (ops.size() < 1 + prefillEdges && ops.size() < keyRange) {
+      GraphOperator op = {GRAPH_INSERT_EDGE, i, randomDist(randomGen)};
+      bool duplicate = false;
+
+      for (uint32_t j = 1; j < ops.size(); j++) {
+        duplicate = duplicate || ops[j].dst == op.dst;
+      }
+
+      if (!duplicate) {
+        ops.push_back(op);
+      }
+    }
+
+    graph.ExecuteOps(ops, 0);
+  }
+
+  // Create joinable threads
+  for (unsigned i = 0; i < numThread; i++) {
+    thread[i] = std::thread(GraphWorkThread<GraphAdaptor<T> >, numThread,
+                            i + 1, testSize, tranSize, keyRange, insertion,
+                            deletion, update, std::ref(barrier),
+                            std::ref(graph));
+  }
+
+  volatile bool done = false;
+  uint64_t searches = 0;
+  uint64_t reached = 0;
+  std::thread search(GraphSearchThread<GraphAdaptor<T> >, numThread + 1,
+                     keyRange, std::ref(barrier), std::ref(done),
+                     std::ref(searches), std::ref(reached), std::ref(graph));
+
+  Metrics before = graph.GetMetrics();
+
+  barrier.Wait();
+
+  {
+    ScopedTimer timer(true);
+
+    // Wait for the threads to finish
+    for (unsigned i = 0; i < thread.size(); i++) {
+      thread[i].join();
+    }
+  }
+
+  done = true;
+  search.join();
+
+  PrintMetrics(before, graph.GetMetrics());
+  printf("Searches %lu, vertices reached per search %.1f\n", searches,
+         searches > 0 ? (double)reached / searches : 0.0);
+
+  graph.Uninit();
+}
+
+// Ops go to a list, a skip list and a hash map picked at random. An update
+// moves a key between the skip list and the map: it deletes it from one and
+// inserts it into the other in the same transaction. A quarter of the updates
+// instead hand a key from the map over to a queue, deleting and enqueueing it
+// together, and another quarter dequeue one, so the queue stays short.
+template <typename T>
+void MultiWorkThread(uint32_t numThread, int threadId, uint32_t testSize,
+                     uint32_t tranSize, uint32_t keyRange, uint32_t insertion,
+                     uint32_t deletion, uint32_t update, ThreadBarrier& barrier,
+                     T& multi) {
+  // set affinity for each thread
+  cpu_set_t cpu = {{0}};
+  CPU_SET(threadId, &cpu);
+  sched_setaffinity(0, sizeof(cpu_set_t), &cpu);
+
+  double startTime = Time::GetWallTime();
+
+  boost::mt19937 randomGenKey;
+  boost::mt19937 randomGenOp;
+  randomGenKey.seed(startTime + threadId);
+  randomGenOp.seed(startTime + threadId + 1000);
+  boost::uniform_int<uint32_t> randomDistKey(1, keyRange);
+  boost::uniform_int<uint32_t> randomDistOp(1, 100);
+  boost::uniform_int<uint32_t> randomDistTarget(MULTI_LIST, MULTI_MAP);
+  boost::uniform_int<uint32_t> randomDistMove(0, 3);
+
+  multi.Init();
+
+  barrier.Wait();
+
+  MultiOpArray ops(tranSize);
+
+  for (unsigned int i = 0; i < testSize; ++i) {
+    for (uint32_t t = 0; t < tranSize; ++t) {
+      uint32_t op_dist = randomDistOp(randomGenOp);
+
+      ops[t].target = randomDistTarget(randomGenOp);
+      ops[t].key = randomDistKey(randomGenKey);
+      ops[t].value = ops[t].key;
+
+      if (op_dist <= insertion) {
+        ops[t].type = MULTI_INSERT;
+      } else if (op_dist <= insertion + deletion) {
+        ops[t].type = MULTI_DELETE;
+      } else if (op_dist <= insertion + deletion + update &&
+                 t + 1 < tranSize) {
+        // Where each move takes the key from and to, the last one only
+        // dequeues
+        const uint8_t from[] = {MULTI_SKIP, MULTI_MAP, MULTI_MAP, MULTI_QUEUE};
+        const uint8_t to[] = {MULTI_MAP, MULTI_SKIP, MULTI_QUEUE};
+        uint32_t move = randomDistMove(randomGenOp);
+
+        ops[t].type = MULTI_DELETE;
+        ops[t].target = from[move];
+
+        if (ops[t].target != MULTI_QUEUE) {
+          ops[t + 1] = ops[t];
+          ops[t + 1].type = MULTI_INSERT;
+          ops[t + 1].target = to[move];
+          t++;
+        }
+      } else {
+        ops[t].type = MULTI_FIND;
+      }
+    }
+
+    multi.ExecuteOps(ops, threadId);
+  }
+
+  multi.Uninit();
+}
+
+template <typename T>
+void MultiTester(uint32_t numThread, uint32_t testSize, uint32_t tranSize,
+                 uint32_t keyRange, uint32_t insertion, uint32_t deletion,
+                 uint32_t update, MultiAdaptor<T>& multi) {
+  std::vector<std::thread> thread(numThread);
+  ThreadBarrier barrier(numThread + 1);
+
+  double startTime = Time::GetWallTime();
+  boost::mt19937 randomGen;
+  randomGen.seed(startTime - 10);
+  boost::uniform_int<uint32_t> randomDist(1, keyRange);
+  boost::uniform_int<uint32_t> randomDistTarget(MULTI_LIST, MULTI_MAP);
+
+  multi.Init();
+
+  MultiOpArray ops(1);
+
+  for (unsigned int i = 0; i < keyRange; ++i) {
+    ops[0].type = MULTI_INSERT;
+    ops[0].target = randomDistTarget(randomGen);
+    ops[0].key = randomDist(randomGen);
+    ops[0].value = ops[0].key;
+    multi.ExecuteOps(ops, 0);
+  }
+
+  // Create joinable threads
+  for (unsigned i = 0; i < numThread; i++) {
+    thread[i] = std::thread(MultiWorkThread<MultiAdaptor<T> >, numThread,
+                            i + 1, testSize, tranSize, keyRange, insertion,
+                            deletion, update, std::ref(barrier),
+                            std::ref(multi));
+  }
+
+  Metrics before = multi.GetMetrics();
+
+  barrier.Wait();
+
+  {
+    ScopedTimer timer(true);
+
+    // Wait for the threads to finish
+    for (unsigned i = 0; i < thread.size(); i++) {
+      thread[i].join();
+    }
+  }
+
+  PrintMetrics(before, multi.GetMetrics());
+
+  multi.Uninit();
+}
+
+// Writes depend on a read earlier in the same transaction: an insert only
+// goes ahead when the key read before it was missing, a delete only when it
+// was there. The choice is made while the transaction runs, on what it reads.
+template <typename T>
+void DynamicWorkThread(uint32_t numThread, int threadId, uint32_t testSize,
+                       uint32_t tranSize, uint32_t keyRange,
+                       uint32_t insertion, uint32_t deletion,
+                       ThreadBarrier& barrier, T& set) {
+  // set affinity for each thread
+  cpu_set_t cpu = {{0}};
+  CPU_SET(threadId, &cpu);
+  sched_setaffinity(0, sizeof(cpu_set_t), &cpu);
+
+  double startTime = Time::GetWallTime();
+
+  boost::mt19937 randomGenKey;
+  boost::mt19937 randomGenOp;
+  randomGenKey.seed(startTime + threadId);
+  randomGenOp.seed(startTime + threadId + 1000);
+  boost::uniform_int<uint32_t> randomDistKey(1, keyRange);
+  boost::uniform_int<uint32_t> randomDistOp(1, 100);
+
+  set.Init();
+
+  barrier.Wait();
+
+  DynamicOpArray ops(tranSize);
+
+  for (unsigned int i = 0; i < testSize; ++i) {
+    for (uint32_t t = 0; t < tranSize; ++t) {
+      uint32_t op_dist = randomDistOp(randomGenOp);
+
+      ops[t].type = DYNAMIC_FIND;
+      ops[t].guard = DYNAMIC_ALWAYS;
+      ops[t].dep = 0;
+      ops[t].key = randomDistKey(randomGenKey);
+
+      if (op_dist <= insertion + deletion && t + 1 < tranSize) {
+        ops[t + 1].type =
+            op_dist <= insertion ? DYNAMIC_INSERT : DYNAMIC_DELETE;
+        ops[t + 1].guard =
+            op_dist <= insertion ? DYNAMIC_IF_FAILED : DYNAMIC_IF_SUCCEEDED;
+        ops[t + 1].dep = t;
+        ops[t + 1].key = randomDistKey(randomGenKey);
+        t++;
+      }
+    }
+
+    set.ExecuteOps(ops);
+  }
+
+  set.Uninit();
+}
+
+template <typename T>
+void DynamicTester(uint32_t numThread, uint32_t testSize, uint32_t tranSize,
+                   uint32_t keyRange, uint32_t insertion, uint32_t deletion,
+                   DynamicAdaptor<T>& set) {
+  std::vector<std::thread> thread(numThread);
+  ThreadBarrier barrier(numThread + 1);
+
+  double startTime = Time::GetWallTime();
+  boost::mt19937 randomGen;
+  randomGen.seed(startTime - 10);
+  boost::uniform_int<uint32_t> randomDist(1, keyRange);
+
+  set.Init();
+
+  DynamicOpArray ops(1);
+
+  for (unsigned int i = 0; i < keyRange; ++i) {
+    ops[0].type = DYNAMIC_INSERT;
+    ops[0].guard = DYNAMIC_ALWAYS;
+    ops[0].dep = 0;
+    ops[0].key = randomDist(randomGen);
+    set.ExecuteOps(ops);
+  }
+
+  // Create joinable threads
+  for (unsigned i = 0; i < numThread; i++) {
+    thread[i] = std::thread(DynamicWorkThread<DynamicAdaptor<T> >, numThread,
+                            i + 1, testSize, tranSize, keyRange, insertion,
+                            deletion, std::ref(barrier), std::ref(set));
+  }
+
+  Metrics before = set.GetMetrics();
+
+  barrier.Wait();
+
+  {
+    ScopedTimer timer(true);
+
+    // Wait for the threads to finish
+    for (unsigned i = 0; i < thread.size(); i++) {
+      thread[i].join();
+    }
+  }
+
+  PrintMetrics(before, set.GetMetrics());
+
+  set.Uninit();
+}
+
+// Point ops mixed with range scans over scanLength keys from a random one.
+// The update share of the ops are scans, so readers of whole ranges compete
+// with writers to single keys.
+template <typename T>
+void RangeWorkThread(uint32_t numThread, int threadId, uint32_t testSize,
+                     uint32_t tranSize, uint32_t keyRange, uint32_t insertion,
+                     uint32_t deletion, uint32_t update, uint32_t scanLength,
+                     ThreadBarrier& barrier, T& set) {
+  // set affinity for each thread
+  cpu_set_t cpu = {{0}};
+  CPU_SET(threadId, &cpu);
+  sched_setaffinity(0, sizeof(cpu_set_t), &cpu);
+
+  double startTime = Time::GetWallTime();
+
+  boost::mt19937 randomGenKey;
+  boost::mt19937 randomGenOp;
+  randomGenKey.seed(startTime + threadId);
+  randomGenOp.seed(startTime + threadId + 1000);
+  boost::uniform_int<uint32_t> randomDistKey(1, keyRange);
+  boost::uniform_int<uint32_t> randomDistOp(1, 100);
+
+  set.Init();
+
+  barrier.Wait();
+
+  RangeOpArray ops(tranSize);
+
+  for (unsigned int i = 0; i < testSize; ++i) {
+    for (uint32_t t = 0; t < tranSize; ++t) {
+      uint32_t op_dist = randomDistOp(randomGenOp);
+
+      ops[t].key = randomDistKey(randomGenKey);
+      ops[t].hi = ops[t].key + scanLength;
+
+      if (op_dist <= insertion) {
+        ops[t].type = RANGE_INSERT;
+      } else if (op_dist <= insertion + deletion) {
+        ops[t].type = RANGE_DELETE;
+      } else if (op_dist <= insertion + deletion + update) {
+        ops[t].type = RANGE_SCAN;
+      } else {
+        ops[t].type = RANGE_FIND;
+      }
+    }
+
+    set.ExecuteOps(ops, threadId);
+  }
+
+  set.Uninit();
+}
+
+template <typename T>
+void RangeTester(uint32_t numThread, uint32_t testSize, uint32_t tranSize,
+                 uint32_t keyRange, uint32_t insertion, uint32_t deletion,
+                 uint32_t update, uint32_t scanLength, RangeAdaptor<T>& set) {
+  std::vector<std::thread> thread(numThread);
+  ThreadBarrier barrier(numThread + 1);
+
+  double startTime = Time::GetWallTime();
+  boost::mt19937 randomGen;
+  randomGen.seed(startTime - 10);
+  boost::uniform_int<uint32_t> randomDist(1, keyRange);
+
+  set.Init();
+
+  RangeOpArray ops(1);
+
+  for (unsigned int i = 0; i < keyRange; ++i) {
+    ops[0].type = RANGE_INSERT;
+    ops[0].key = randomDist(randomGen);
+    set.ExecuteOps(ops, 0);
+  }
+
+  // Create joinable threads
+  for (unsigned i = 0; i < numThread; i++) {
+    thread[i] = std::thread(RangeWorkThread<RangeAdaptor<T> >, numThread,
+                            i + 1, testSize, tranSize, keyRange, insertion,
+                            deletion, update, scanLength, std::ref(barrier),
+                            std::ref(set));
+  }
+
+  Metrics before = set.GetMetrics();
+
+  barrier.Wait();
+
+  {
+    ScopedTimer timer(true);
+
+    // Wait for the threads to finish
+    for (unsigned i = 0; i < thread.size(); i++) {
+      thread[i].join();
+    }
+  }
+
+  PrintMetrics(before, set.GetMetrics());
+
+  set.Uninit();
+}
+
+// Every key is a counter. The insert share of the ops reset a counter with an
+// UPSERT, the delete share bump it with a CAS from the value this thread last
+// saw, the update share add to it with a FETCH_ADD, and the rest read it.
+// After an abort the counters of its CAS ops are read again, each in a
+// transaction of its own, so a stale value does not fail every later CAS.
+template <typename T>
+void CounterWorkThread(uint32_t numThread, int threadId, uint32_t testSize,
+                       uint32_t tranSize, uint32_t keyRange,
+                       uint32_t insertion, uint32_t deletion, uint32_t update,
+                       ThreadBarrier& barrier, T& map) {
+  // set affinity for each thread
+  cpu_set_t cpu = {{0}};
+  CPU_SET(threadId, &cpu);
+  sched_setaffinity(0, sizeof(cpu_set_t), &cpu);
+
+  double startTime = Time::GetWallTime();
+
+  boost::mt19937 randomGenKey;
+  boost::mt19937 randomGenOp;
+  randomGenKey.seed(startTime + threadId);
+  randomGenOp.seed(startTime + threadId + 1000);
+  boost::uniform_int<uint32_t> randomDistKey(1, keyRange);
+  boost::uniform_int<uint32_t> randomDistOp(1, 100);
+
+  map.Init();
+
+  barrier.Wait();
+
+  MapOpArray ops(tranSize);
+  MapOpArray refresh(1);
+  std::vector<uint32_t> seen(keyRange + 1, 1);
+
+  for (unsigned int i = 0; i < testSize; ++i) {
+    for (uint32_t t = 0; t < tranSize; ++t) {
+      uint32_t op_dist = randomDistOp(randomGenOp);
+
+      ops[t].key = randomDistKey(randomGenKey);
+
+      if (op_dist <= insertion) {
+        ops[t].type = MAP_UPSERT;
+        ops[t].value = 1;
+      } else if (op_dist <= insertion + deletion) {
+        ops[t].type = MAP_CAS;
+        ops[t].expected = seen[ops[t].key];
+        ops[t].value = seen[ops[t].key] + 1;
+      } else if (op_dist <= insertion + deletion + update) {
+        ops[t].type = MAP_FETCH_ADD;
+        ops[t].value = 1;
+      } else {
+        ops[t].type = MAP_FIND;
+        ops[t].value = 0;
+      }
+    }
+
+    if (map.ExecuteOps(ops, threadId)) {
+      for (uint32_t t = 0; t < tranSize; ++t) {
+        if (ops[t].type == MAP_FETCH_ADD) {
+          seen[ops[t].key] = ops[t].expected + ops[t].value;
+        } else {
+          seen[ops[t].key] = ops[t].value;
+        }
+      }
+    } else {
+      for (uint32_t t = 0; t < tranSize; ++t) {
+        if (ops[t].type != MAP_CAS) {
+          continue;
+        }
+
+        refresh[0].type = MAP_FIND;
+        refresh[0].key = ops[t].key;
+        refresh[0].value = 0;
+
+        if (map.ExecuteOps(refresh, threadId)) {
+          seen[ops[t].key] = refresh[0].value;
+        }
+      }
+    }
+  }
+
+  map.Uninit();
+}
+
+template <typename T>
+void CounterTester(uint32_t numThread, uint32_t testSize, uint32_t tranSize,
+                   uint32_t keyRange, uint32_t insertion, uint32_t deletion,
+                   uint32_t update, MapAdaptor<T>& map) {
+  std::vector<std::thread> thread(numThread);
+  ThreadBarrier barrier(numThread + 1);
+
+  map.Init();
+
+  MapOpArray ops(1);
+
+  // Every counter starts at 1, so no op finds its key missing
+  for (unsigned int i = 1; i <= keyRange; ++i) {
+    ops[0].type = MAP_INSERT;
+    ops[0].key = i;
+    ops[0].value = 1;
+    map.ExecuteOps(ops, 0);
+  }
+
+  // Create joinable threads
+  for (unsigned i = 0; i < numThread; i++) {
+    thread[i] = std::thread(CounterWorkThread<MapAdaptor<T> >, numThread,
+                            i + 1, testSize, tranSize, keyRange, insertion,
+                            deletion, update, std::ref(barrier),
+                            std::ref(map));
+  }
+
+  Metrics before = map.GetMetrics();
+
+  barrier.Wait();
+
+  {
+    ScopedTimer timer(true);
+
+    // Wait for the threads to finish
+    for (unsigned i = 0; i < thread.size(); i++) {
+      thread[i].join();
+    }
+  }
+
+  PrintMetrics(before, map.GetMetrics());
+
+  map.Uninit();
+}
+
+int main(int argc, const char* argv[]) {
+  uint32_t setType = 0;
+  uint32_t numThread = 1;
+  uint32_t testSize = 100;
+  uint32_t tranSize = 1;
+  uint32_t keyRange = 100;
+  uint32_t insertion = 50;
+  uint32_t deletion = 50;
+  uint32_t update = 0;
+  uint32_t scanLength = 100;
+
+  if (argc > 1) setType = atoi(argv[1]);
+  if (argc > 2) numThread = atoi(argv[2]);
+  if (argc > 3) testSize = atoi(argv[3]);
+  if (argc > 4) tranSize = atoi(argv[4]);
+  if (argc > 5) keyRange = atoi(argv[5]);
+  if (argc > 6) insertion = atoi(argv[6]);
+  if (argc > 7) deletion = atoi(argv[7]);
+  if (argc > 8) update = atoi(argv[8]);
+  if (argc > 9) scanLength = atoi(argv[9]);
+
+  assert(setType < 32);
+  assert(keyRange < 0xffffffff);
+
+  // Workers, the main thread and the graph's search thread all take a
+  // ThreadId
+  if (numThread + 2 > THREAD_ID_MAX) {
+    fprintf(stderr, "At most %d threads.\n", THREAD_ID_MAX - 2);
+    return 1;
+  }
+
+  const char* setName[] = {"TransList",
+                           "RSTMList",
+                           "BoostingList",
+                           "TransSkip",
+                           "BoostingSkip",
+                           "OSTMSkip",
+                           "TransMap",
+                           "BoostingMap",
+                           "ObsSkip",
+                           "ObsList",
+                           "TransHash",
+                           "TransBST",
+                           "TransPQ",
+                           "TransSprayPQ",
+                           "TransQueue",
+                           "TransBTree",
+                           "TransBTreeMap",
+                           "TransSkipMap",
+                           "TransMDList",
+                           "TransUnrolledList",
+                           "TransVector",
+                           "TransGraph",
+                           "TransStrMap",
+                           "TransSkipBatch",
+                           "TransMapBatch",
+                           "TransMulti",
+                           "TransListDynamic",
+                           "TransSkipDynamic",
+                           "TransListWaitFree",
+                           "TransSkipWaitFree",
+                           "TransSkipRange",
+                           "TransMapCounter"};
+
+  printf(
+      "Start testing %s with %d threads %d iterations %d txnsize %d unique "
+      "keys %d%% insert %d%% delete %d%% update.\n",
+      setName[setType], numThread, testSize, tranSize, keyRange, insertion,
+      deletion, update);  //(insertion + deletion) >= 100 ? 100 - insertion :
+                          // deletion, update);
+
+  uint64_t numNodes = keyRange + testSize;  // note: is this too much?
+
+  switch (setType) {
+    case 0: {
+      SetAdaptor<TransList> set(numNodes, numThread + 1, tranSize);
+      Tester(numThread, testSize, tranSize, keyRange, insertion, deletion, set);
+    } break;
+    case 1: {
+      SetAdaptor<RSTMList> set;
+      Tester(numThread, testSize, tranSize, keyRange, insertion, deletion, set);
+    } break;
+    case 2: {
+      SetAdaptor<BoostingList> set;
+      Tester(numThread, testSize, tranSize, keyRange, insertion, deletion, set);
+    } break;
+    case 3: {
+      SetAdaptor<trans_skip> set(numNodes, numThread + 1, tranSize);
+      Tester(numThread, testSize, tranSize, keyRange, insertion, deletion, set);
+    } break;
+    case 4: {
+      SetAdaptor<BoostingSkip> set;
+      Tester(numThread, testSize, tranSize, keyRange, insertion, deletion, set);
+    } break;
+    case 5: {
+      SetAdaptor<stm_skip> set;
+      Tester(numThread, testSize, tranSize, keyRange, insertion, deletion, set);
+    } break;
+    case 6: {
+      MapAdaptor<TransMap> map(numNodes, numThread + 1, tranSize);
+      MapTester(numThread, testSize, tranSize, keyRange, insertion, deletion,
+                update, map);
+    } break;
+    case 7: {
+      MapAdaptor<BoostingMap> map(numNodes, numThread + 1);
+      BoostingMapTester(numThread, testSize, tranSize, keyRange, insertion,
+                        deletion, update, map);
+    } break;
+    case 8: {
+      SetAdaptor<obs_skip> set(testSize, numThread + 1, tranSize);
+      Tester(numThread, testSize, tranSize, keyRange, insertion, deletion, set);
+    } break;
+    case 9: {
+      SetAdaptor<ObsList> set(testSize, numThread + 1, tranSize);
+      Tester(numThread, testSize, tranSize, keyRange, insertion, deletion, set);
+    } break;
+    case 10: {
+      SetAdaptor<TransHash> set(numNodes, numThread + 1, tranSize);
+      Tester(numThread, testSize, tranSize, keyRange, insertion, deletion, set);
+    } break;
+    case 11: {
+      SetAdaptor<TransBST> set(numNodes, numThread + 1, tranSize);
+      Tester(numThread, testSize, tranSize, keyRange, insertion, deletion, set);
+    } break;
+    case 12: {
+      PQAdaptor<trans_skip> pq(numNodes, numThread + 1, tranSize, 0);
+      PQTester(numThread, testSize, tranSize, keyRange, insertion, pq);
+    } break;
+    case 13: {
+      PQAdaptor<trans_skip> pq(numNodes, numThread + 1, tranSize, numThread);
+      PQTester(numThread, testSize, tranSize, keyRange, insertion, pq);
+    } break;
+    case 14: {
+      QueueAdaptor<TransQueue> queue(numNodes, numThread + 1, tranSize);
+      QueueTester(numThread, testSize, tranSize, keyRange, insertion, queue);
+    } break;
+    case 15: {
+      SetAdaptor<TransBTree> set(numNodes, numThread + 1, tranSize);
+      Tester(numThread, testSize, tranSize, keyRange, insertion, deletion, set);
+    } break;
+    case 16: {
+      MapAdaptor<TransBTree> map(numNodes, numThread + 1, tranSize);
+      MapTester(numThread, testSize, tranSize, keyRange, insertion, deletion,
+                update, map);
+    } break;
+    case 17: {
+      MapAdaptor<trans_skip> map(numNodes, numThread + 1, tranSize);
+      MapTester(numThread, testSize, tranSize, keyRange, insertion, deletion,
+                update, map);
+    } break;
+    case 18: {
+      SetAdaptor<TransMDList> set(numNodes, numThread + 1, tranSize);
+      Tester(numThread, testSize, tranSize, keyRange, insertion, deletion, set);
+    } break;
+    case 19: {
+      SetAdaptor<TransUnrolledList> set(numNodes, numThread + 1, tranSize);
+      Tester(numThread, testSize, tranSize, keyRange, insertion, deletion, set);
+    } break;
+    case 20: {
+      VectorAdaptor<TransVector> vector(numNodes, numThread + 1, tranSize);
+      VectorTester(numThread, testSize, tranSize, keyRange, insertion, deletion,
+                   update, vector);
+    } break;
+    case 21: {
+      // Transactions adding a vertex hold its prefill edges too
+      const uint32_t prefillEdges = 4;
+      GraphAdaptor<TransGraph> graph(numNodes, numThread + 2,
+                                     std::max(tranSize, prefillEdges + 1),
+                                     keyRange);
+      GraphTester(numThread, testSize, tranSize, keyRange, insertion, deletion,
+                  update, prefillEdges, graph);
+    } break;
+    case 22: {
+      MapAdaptor<TransStrMap> map(numNodes, numThread + 1, tranSize);
+      MapTester(numThread, testSize, tranSize, keyRange, insertion, deletion,
+                update, map);
+    } break;
+    case 23: {
+      // Pools hold a thread's batches, and the prefill's
+      uint64_t batches = testSize + keyRange / tranSize + 1;
+      MapAdaptor<trans_skip> map(batches, numThread + 1, tranSize);
+      BatchTester(numThread, testSize, tranSize, keyRange, map);
+    } break;
+    case 24: {
+      uint64_t batches = testSize + keyRange / tranSize + 1;
+      MapAdaptor<TransMap> map(batches, numThread + 1, tranSize, numNodes);
+      BatchTester(numThread, testSize, tranSize, keyRange, map);
+    } break;
+    case 25: {
+      MultiAdaptor<TransMulti> multi(numNodes, numThread + 1, tranSize);
+      MultiTester(numThread, testSize, tranSize, keyRange, insertion, deletion,
+                  update, multi);
+    } break;
+    case 26: {
+      DynamicAdaptor<TransList> set(numNodes, numThread + 1, tranSize, false);
+      DynamicTester(numThread, testSize, tranSize, keyRange, insertion,
+                    deletion, set);
+    } break;
+    case 27: {
+      DynamicAdaptor<trans_skip> set(numNodes, numThread + 1, tranSize, false);
+      DynamicTester(numThread, testSize, tranSize, keyRange, insertion,
+                    deletion, set);
+    } break;
+    case 28: {
+      DynamicAdaptor<TransList> set(numNodes, numThread + 1, tranSize, true);
+      DynamicTester(numThread, testSize, tranSize, keyRange, insertion,
+                    deletion, set);
+    } break;
+    case 29: {
+      DynamicAdaptor<trans_skip> set(numNodes, numThread + 1, tranSize, true);
+      DynamicTester(numThread, testSize, tranSize, keyRange, insertion,
+                    deletion, set);
+    } break;
+    case 30: {
+      printf("Scanning %d keys.\n", scanLength);
+      RangeAdaptor<trans_skip> set(numNodes, numThread + 1, tranSize,
+                                   scanLength);
+      RangeTester(numThread, testSize, tranSize, keyRange, insertion, deletion,
+                  update, scanLength, set);
+    } break;
+    case 31: {
+      MapAdaptor<TransMap> map(numNodes, numThread + 1, tranSize);
+      CounterTester(numThread, testSize, tranSize, keyRange, insertion,
+                    deletion, update, map);
     } break;
     default:
       break;
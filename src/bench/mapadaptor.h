@@ -1,17 +1,35 @@
 #ifndef MAPADAPTOR_H
 #define MAPADAPTOR_H
 
+#include <cstdio>
+#include <string>
+
 #include "boosting/map/boostingmap.h"
 #include "common/allocator.h"
+#include "common/metrics.h"
+#include "translink/btree/transbtree.h"
 #include "translink/map/transmap.h"
+#include "translink/map/transstrmap.h"
+#include "translink/skiplist/transskip.h"
 // #include "rstm/map/rstmhash.hpp"
 
-enum MapOpType { MAP_FIND = 0, MAP_INSERT, MAP_DELETE, MAP_UPDATE };
+// FETCH_ADD, CAS and UPSERT only run on TransMap
+enum MapOpType {
+  MAP_FIND = 0,
+  MAP_INSERT,
+  MAP_DELETE,
+  MAP_UPDATE,
+  MAP_FETCH_ADD,
+  MAP_CAS,
+  MAP_UPSERT
+};
 
 struct MapOperator {
   uint8_t type;
   uint32_t key;
   uint32_t value;
+  // For CAS, the value the key must hold. TransMap writes back the value a
+  // FETCH_ADD or UPSERT started from.
   uint32_t expected;
   uint32_t threadId;
 };
@@ -26,17 +44,19 @@ class MapAdaptor {};
 template <>
 class MapAdaptor<TransMap> {
  public:
-  MapAdaptor(uint64_t cap, uint64_t threadCount, uint32_t transSize)
-      : m_descAllocator(cap * threadCount * TransMap::Desc::SizeOf(transSize),
-                        threadCount, TransMap::Desc::SizeOf(transSize))
+  // The table starts with tableSize slots, cap of them by default
+  MapAdaptor(uint64_t cap, uint64_t threadCount, uint32_t transSize,
+             uint64_t tableSize = 0)
+      : m_descAllocator(cap * threadCount * TransMap::RmwSizeOf(transSize),
+                        threadCount, TransMap::RmwSizeOf(transSize))
         //, m_nodeAllocator(cap * threadCount *  sizeof(TransMap::Node) *
         // transSize, threadCount, sizeof(TransMap::Node))
         ,
         m_nodeDescAllocator(
             cap * threadCount * sizeof(TransMap::NodeDesc) * transSize,
             threadCount, sizeof(TransMap::NodeDesc)),
-        m_map(/*&m_nodeAllocator,*/ &m_descAllocator, &m_nodeDescAllocator, cap,
-              threadCount) {}
+        m_map(/*&m_nodeAllocator,*/ &m_descAllocator, &m_nodeDescAllocator,
+              tableSize == 0 ? cap : tableSize, threadCount) {}
 
   void Init() {
     m_descAllocator.Init();
@@ -46,31 +66,47 @@ class MapAdaptor<TransMap> {
 
   void Uninit() {}
 
-  bool ExecuteOps(const MapOpArray& ops,
-                  int threadId)  //, std::vector<VALUE> &toR)
-  {
+  // Hands back the value of each FIND in its op, and what each FETCH_ADD or
+  // UPSERT started from
+  bool ExecuteOps(MapOpArray& ops, int threadId) {
 // TransMap::Desc* desc = m_map.AllocateDesc(ops.size());
 //  TODO: left off here: put a breakpoint here, after just replacing the
 //  following with a malloc.
 #ifdef USE_MEM_POOL
     TransMap::Desc* desc = m_descAllocator.Alloc();
 #else
-    TransMap::Desc* desc = (TransMap::Desc*)malloc(
-        sizeof(uint8_t) + sizeof(uint8_t) + sizeof(MapOperator) * ops.size());
+    TransMap::Desc* desc =
+        (TransMap::Desc*)malloc(TransMap::RmwSizeOf(ops.size()));
 #endif
 
     desc->size = ops.size();
     desc->status = TransMap::MAP_ACTIVE;
+    uint32_t* prior = TransMap::Prior(desc);
 
     for (uint32_t i = 0; i < ops.size(); ++i) {
       desc->ops[i].type = ops[i].type;
       desc->ops[i].key = ops[i].key;
       desc->ops[i].value = ops[i].value;
+      prior[i] = ops[i].type == MAP_CAS ? ops[i].expected : 0;
+    }
+
+    bool ret = m_map.ExecuteOps(desc, threadId);
+
+    if (ret) {
+      for (uint32_t i = 0; i < ops.size(); ++i) {
+        if (ops[i].type == MAP_FIND) {
+          ops[i].value = desc->ops[i].value;
+        } else if (ops[i].type == MAP_FETCH_ADD || ops[i].type == MAP_UPSERT) {
+          ops[i].expected = prior[i];
+        }
+      }
     }
 
-    return m_map.ExecuteOps(desc, threadId);  //, toR);
+    return ret;
   }
 
+  Metrics GetMetrics() { return m_map.GetMetrics(); }
+
  private:
   Allocator<TransMap::Desc> m_descAllocator;
   // Allocator<TransMap::DataNode> m_nodeAllocator;
@@ -78,6 +114,183 @@ class MapAdaptor<TransMap> {
   TransMap m_map;
 };
 
+template <>
+class MapAdaptor<TransBTree> {
+ public:
+  MapAdaptor(uint64_t cap, uint64_t threadCount, uint32_t transSize)
+      : m_descAllocator(
+            cap * threadCount * TransBTree::Desc::SizeOf(transSize),
+            threadCount, TransBTree::Desc::SizeOf(transSize)),
+        // A split leaves two half full nodes, keep room for twice that
+        m_nodeAllocator((cap * transSize * 4 / TransBTree::LEAF_SLOTS + 16) *
+                            threadCount * sizeof(TransBTree::Leaf),
+                        threadCount, sizeof(TransBTree::Leaf)),
+        m_entryAllocator(
+            cap * threadCount * sizeof(TransBTree::Entry) * transSize,
+            threadCount, sizeof(TransBTree::Entry)),
+        m_nodeDescAllocator(
+            cap * threadCount * sizeof(TransBTree::NodeDesc) * transSize,
+            threadCount, sizeof(TransBTree::NodeDesc)),
+        m_map(&m_nodeAllocator, &m_entryAllocator, &m_descAllocator,
+              &m_nodeDescAllocator) {}
+
+  void Init() {
+    m_descAllocator.Init();
+    m_nodeAllocator.Init();
+    m_entryAllocator.Init();
+    m_nodeDescAllocator.Init();
+  }
+
+  void Uninit() {}
+
+  bool ExecuteOps(MapOpArray& ops, int threadId) {
+    TransBTree::Desc* desc = m_map.AllocateDesc(ops.size());
+
+    for (uint32_t i = 0; i < ops.size(); ++i) {
+      desc->ops[i].type = ops[i].type;
+      desc->ops[i].key = ops[i].key;
+      desc->ops[i].value = ops[i].value;
+    }
+
+    bool ret = m_map.ExecuteOps(desc);
+
+    if (ret) {
+      for (uint32_t i = 0; i < ops.size(); ++i) {
+        if (ops[i].type == MAP_FIND) {
+          ops[i].value = desc->ops[i].value;
+        }
+      }
+    }
+
+    return ret;
+  }
+
+  Metrics GetMetrics() { return m_map.GetMetrics(); }
+
+ private:
+  Allocator<TransBTree::Desc> m_descAllocator;
+  Allocator<TransBTree::Leaf> m_nodeAllocator;
+  Allocator<TransBTree::Entry> m_entryAllocator;
+  Allocator<TransBTree::NodeDesc> m_nodeDescAllocator;
+  TransBTree m_map;
+};
+
+// TransSkip used as an ordered map, values are kept in its descriptors
+template <>
+class MapAdaptor<trans_skip> {
+ public:
+  MapAdaptor(uint64_t cap, uint64_t threadCount, uint32_t transSize)
+      : m_descAllocator(cap * threadCount * Desc::SizeOf(transSize),
+                        threadCount, Desc::SizeOf(transSize)),
+        m_nodeDescAllocator(cap * threadCount * sizeof(NodeDesc) * transSize,
+                            threadCount, sizeof(NodeDesc)) {
+    m_skiplist = transskip_alloc(&m_descAllocator, &m_nodeDescAllocator);
+    init_transskip_subsystem();
+  }
+
+  ~MapAdaptor() { transskip_free(m_skiplist); }
+
+  void Init() {
+    m_descAllocator.Init();
+    m_nodeDescAllocator.Init();
+  }
+
+  void Uninit() { destroy_transskip_subsystem(); }
+
+  bool ExecuteOps(MapOpArray& ops, int threadId) {
+    Desc* desc = m_descAllocator.Alloc();
+    desc->size = ops.size();
+    desc->status = MAP_ACTIVE;
+
+    for (uint32_t i = 0; i < ops.size(); ++i) {
+      // DELETEMIN takes the slot MAP_UPDATE has in the other maps
+      desc->ops[i].type = ops[i].type == MAP_UPDATE ? OP_UPDATE : ops[i].type;
+      desc->ops[i].key = ops[i].key;
+      desc->ops[i].value = ops[i].value;
+    }
+
+    bool ret = execute_ops(m_skiplist, desc);
+
+    if (ret) {
+      for (uint32_t i = 0; i < ops.size(); ++i) {
+        if (ops[i].type == MAP_FIND) {
+          ops[i].value = desc->ops[i].value;
+        }
+      }
+    }
+
+    return ret;
+  }
+
+  Metrics GetMetrics() { return ::GetMetrics(m_skiplist); }
+
+ private:
+  Allocator<Desc> m_descAllocator;
+  Allocator<NodeDesc> m_nodeDescAllocator;
+  trans_skip* m_skiplist;
+};
+
+// TransStrMap with the integer keys of the bench spelled out, even ones as
+// session ids that fit inline and odd ones as URLs that do not
+template <>
+class MapAdaptor<TransStrMap> {
+ public:
+  MapAdaptor(uint64_t cap, uint64_t threadCount, uint32_t transSize)
+      : m_descAllocator(
+            cap * threadCount * TransStrMap::Desc::SizeOf(transSize),
+            threadCount, TransStrMap::Desc::SizeOf(transSize)),
+        m_nodeAllocator(
+            cap * threadCount * sizeof(TransStrMap::Node) * transSize,
+            threadCount, sizeof(TransStrMap::Node)),
+        m_nodeDescAllocator(
+            cap * threadCount * sizeof(TransStrMap::NodeDesc) * transSize,
+            threadCount, sizeof(TransStrMap::NodeDesc)),
+        m_map(&m_nodeAllocator, &m_descAllocator, &m_nodeDescAllocator, cap),
+        m_keys(cap + 1) {
+    char buf[64];
+
+    for (uint64_t k = 0; k <= cap; k++) {
+      int size = k % 2 == 0
+                     ? snprintf(buf, sizeof(buf), "session:%08lx", k)
+                     : snprintf(buf, sizeof(buf),
+                                "https://example.com/static/%lu.html", k);
+      m_keys[k].assign(buf, size);
+    }
+  }
+
+  void Init() {
+    m_descAllocator.Init();
+    m_nodeAllocator.Init();
+    m_nodeDescAllocator.Init();
+  }
+
+  void Uninit() {}
+
+  bool ExecuteOps(const MapOpArray& ops, int threadId) {
+    TransStrMap::Desc* desc = m_map.AllocateDesc(ops.size());
+
+    for (uint32_t i = 0; i < ops.size(); ++i) {
+      const std::string& key = m_keys[ops[i].key];
+
+      desc->ops[i].type = ops[i].type;
+      desc->ops[i].key.Set(key.data(), key.size());
+      desc->ops[i].value.Set((const char*)&ops[i].value, sizeof(uint32_t));
+    }
+
+    return m_map.ExecuteOps(desc);
+  }
+
+  Metrics GetMetrics() { return m_map.GetMetrics(); }
+
+ private:
+  Allocator<TransStrMap::Desc> m_descAllocator;
+  Allocator<TransStrMap::Node> m_nodeAllocator;
+  Allocator<TransStrMap::NodeDesc> m_nodeDescAllocator;
+  TransStrMap m_map;
+  // Long keys are not copied into the descriptors, so they stay here
+  std::vector<std::string> m_keys;
+};
+
 template <>
 class MapAdaptor<BoostingMap> {
  public:
@@ -122,6 +335,8 @@ class MapAdaptor<BoostingMap> {
     return ret;
   }
 
+  Metrics GetMetrics() { return m_list.GetMetrics(); }
+
  private:
   BoostingMap m_list;
 };
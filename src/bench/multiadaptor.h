@@ -0,0 +1,160 @@
+#ifndef MULTIADAPTOR_H
+#define MULTIADAPTOR_H
+
+#include <vector>
+
+#include "common/allocator.h"
+#include "common/metrics.h"
+#include "translink/multi/transmulti.h"
+
+enum MultiOpType { MULTI_FIND = 0, MULTI_INSERT, MULTI_DELETE, MULTI_UPDATE };
+
+enum MultiTarget {
+  MULTI_LIST = 0,
+  MULTI_SKIP,
+  MULTI_MAP,
+  MULTI_QUEUE,
+  MULTI_VECTOR
+};
+
+struct MultiOperator {
+  uint8_t type;
+  uint8_t target;
+  uint32_t key;    // the index of a vector op, ignored by the queue
+  uint32_t value;  // ignored by the list, the item of a queue or vector op
+};
+
+typedef std::vector<MultiOperator> MultiOpArray;
+
+template <typename T>
+class MultiAdaptor {};
+
+// A TransEntryList, a TransSkip, a TransMap, a TransQueue and a TransVector
+// sharing one TransMulti
+template <>
+class MultiAdaptor<TransMulti> {
+ public:
+  MultiAdaptor(uint64_t cap, uint64_t threadCount, uint32_t transSize)
+      : m_descAllocator(cap * threadCount * TransMulti::SizeOf(transSize),
+                        threadCount, TransMulti::SizeOf(transSize)),
+        // Descriptors all come from TransMulti, the containers never take
+        // one of their own
+        m_listDescAllocator(threadCount * TransEntryList::Desc::SizeOf(0),
+                            threadCount, TransEntryList::Desc::SizeOf(0)),
+        m_listNodeAllocator(
+            cap * threadCount * sizeof(TransEntryList::Node) * transSize,
+            threadCount, sizeof(TransEntryList::Node)),
+        m_listNodeDescAllocator(
+            cap * threadCount * sizeof(TransEntryList::NodeDesc) * transSize,
+            threadCount, sizeof(TransEntryList::NodeDesc)),
+        m_skipNodeDescAllocator(
+            cap * threadCount * sizeof(NodeDesc) * transSize, threadCount,
+            sizeof(NodeDesc)),
+        m_mapDescAllocator(threadCount * TransMulti::Map::Desc::SizeOf(0),
+                           threadCount, TransMulti::Map::Desc::SizeOf(0)),
+        m_mapNodeDescAllocator(
+            cap * threadCount * sizeof(TransMulti::Map::NodeDesc) * transSize,
+            threadCount, sizeof(TransMulti::Map::NodeDesc)),
+        m_queueDescAllocator(threadCount * TransQueue::Desc::SizeOf(0),
+                             threadCount, TransQueue::Desc::SizeOf(0)),
+        m_queueNodeAllocator(
+            cap * threadCount * sizeof(TransQueue::Node) * transSize,
+            threadCount, sizeof(TransQueue::Node)),
+        m_queueNodeDescAllocator(
+            cap * threadCount * sizeof(TransQueue::NodeDesc) * transSize,
+            threadCount, sizeof(TransQueue::NodeDesc)),
+        m_vectorDescAllocator(threadCount * TransVector::Desc::SizeOf(0),
+                              threadCount, TransVector::Desc::SizeOf(0)),
+        m_vectorNodeDescAllocator(
+            cap * threadCount * sizeof(TransVector::NodeDesc) * transSize,
+            threadCount, sizeof(TransVector::NodeDesc)),
+        m_vectorSizeDescAllocator(
+            cap * threadCount * sizeof(TransVector::SizeDesc) * transSize,
+            threadCount, sizeof(TransVector::SizeDesc)),
+        m_list(&m_listNodeAllocator, &m_listDescAllocator,
+               &m_listNodeDescAllocator),
+        m_map(&m_mapDescAllocator, &m_mapNodeDescAllocator, cap, threadCount),
+        m_queue(&m_queueNodeAllocator, &m_queueDescAllocator,
+                &m_queueNodeDescAllocator),
+        m_vector(&m_vectorDescAllocator, &m_vectorNodeDescAllocator,
+                 &m_vectorSizeDescAllocator),
+        m_multi(&m_descAllocator) {
+    m_skiplist = transskip_alloc(&m_descAllocator, &m_skipNodeDescAllocator);
+    init_transskip_subsystem();
+
+    m_targets[MULTI_LIST] = m_multi.Attach(&m_list);
+    m_targets[MULTI_SKIP] = m_multi.Attach(m_skiplist);
+    m_targets[MULTI_MAP] = m_multi.Attach(&m_map);
+    m_targets[MULTI_QUEUE] = m_multi.Attach(&m_queue);
+    m_targets[MULTI_VECTOR] = m_multi.Attach(&m_vector);
+  }
+
+  ~MultiAdaptor() { transskip_free(m_skiplist); }
+
+  void Init() {
+    m_descAllocator.Init();
+    m_listNodeAllocator.Init();
+    m_listNodeDescAllocator.Init();
+    m_skipNodeDescAllocator.Init();
+    m_mapNodeDescAllocator.Init();
+    m_queueNodeAllocator.Init();
+    m_queueNodeDescAllocator.Init();
+    m_vectorNodeDescAllocator.Init();
+    m_vectorSizeDescAllocator.Init();
+  }
+
+  void Uninit() { destroy_transskip_subsystem(); }
+
+  // Hands back the value of each FIND on the skip, the map or the vector, and
+  // the item of each dequeue or pop, in its op
+  bool ExecuteOps(MultiOpArray& ops, int threadId) {
+    TransMulti::Desc* desc = m_multi.AllocateDesc(ops.size());
+    uint32_t* targets = TransMulti::Targets(desc);
+
+    for (uint32_t i = 0; i < ops.size(); ++i) {
+      desc->ops[i].type = ops[i].type;
+      desc->ops[i].key = ops[i].key;
+      desc->ops[i].value = ops[i].value;
+      targets[i] = m_targets[ops[i].target];
+    }
+
+    bool ret = m_multi.ExecuteOps(desc, threadId);
+
+    if (ret) {
+      for (uint32_t i = 0; i < ops.size(); ++i) {
+        if (ops[i].type == MULTI_FIND ||
+            (ops[i].type == MULTI_DELETE && ops[i].target >= MULTI_QUEUE)) {
+          ops[i].value = desc->ops[i].value;
+        }
+      }
+    }
+
+    return ret;
+  }
+
+  Metrics GetMetrics() { return m_multi.GetMetrics(); }
+
+ private:
+  Allocator<TransMulti::Desc> m_descAllocator;
+  Allocator<TransEntryList::Desc> m_listDescAllocator;
+  Allocator<TransEntryList::Node> m_listNodeAllocator;
+  Allocator<TransEntryList::NodeDesc> m_listNodeDescAllocator;
+  Allocator<NodeDesc> m_skipNodeDescAllocator;
+  Allocator<TransMulti::Map::Desc> m_mapDescAllocator;
+  Allocator<TransMulti::Map::NodeDesc> m_mapNodeDescAllocator;
+  Allocator<TransQueue::Desc> m_queueDescAllocator;
+  Allocator<TransQueue::Node> m_queueNodeAllocator;
+  Allocator<TransQueue::NodeDesc> m_queueNodeDescAllocator;
+  Allocator<TransVector::Desc> m_vectorDescAllocator;
+  Allocator<TransVector::NodeDesc> m_vectorNodeDescAllocator;
+  Allocator<TransVector::SizeDesc> m_vectorSizeDescAllocator;
+  TransEntryList m_list;
+  trans_skip* m_skiplist;
+  TransMulti::Map m_map;
+  TransQueue m_queue;
+  TransVector m_vector;
+  TransMulti m_multi;
+  uint32_t m_targets[5];
+};
+
+#endif /* end of include guard: MULTIADAPTOR_H */
@@ -0,0 +1,76 @@
+#ifndef PQADAPTOR_H
+#define PQADAPTOR_H
+
+#include <vector>
+
+#include "common/allocator.h"
+#include "common/metrics.h"
+#include "translink/skiplist/transskip.h"
+
+enum PQOpType { PQ_INSERT = 1, PQ_DELETEMIN = OP_DELETEMIN };
+
+struct PQOperator {
+  uint8_t type;
+  uint32_t key;  // for PQ_DELETEMIN, the removed key once committed
+};
+
+typedef std::vector<PQOperator> PQOpArray;
+
+template <typename T>
+class PQAdaptor {};
+
+template <>
+class PQAdaptor<trans_skip> {
+ public:
+  // A non-zero sprayThreads relaxes DeleteMin for that many concurrent callers
+  PQAdaptor(uint64_t cap, uint64_t threadCount, uint32_t transSize,
+            uint32_t sprayThreads)
+      : m_descAllocator(cap * threadCount * Desc::SizeOf(transSize),
+                        threadCount, Desc::SizeOf(transSize)),
+        m_nodeDescAllocator(cap * threadCount * sizeof(NodeDesc) * transSize,
+                            threadCount, sizeof(NodeDesc)) {
+    m_skiplist = transskip_alloc(&m_descAllocator, &m_nodeDescAllocator);
+    transskip_set_spray(m_skiplist, sprayThreads);
+    init_transskip_subsystem();
+  }
+
+  ~PQAdaptor() { transskip_free(m_skiplist); }
+
+  void Init() {
+    m_descAllocator.Init();
+    m_nodeDescAllocator.Init();
+  }
+
+  void Uninit() { destroy_transskip_subsystem(); }
+
+  bool ExecuteOps(PQOpArray& ops) {
+    Desc* desc = m_descAllocator.Alloc();
+    desc->size = ops.size();
+    desc->status = 0;  // live
+
+    for (uint32_t i = 0; i < ops.size(); ++i) {
+      desc->ops[i].type = ops[i].type;
+      desc->ops[i].key =
+          ops[i].type == PQ_DELETEMIN ? DELETEMIN_KEY_UNSET : ops[i].key;
+    }
+
+    bool ret = execute_ops(m_skiplist, desc);
+
+    if (ret) {
+      for (uint32_t i = 0; i < ops.size(); ++i) {
+        ops[i].key = desc->ops[i].key;
+      }
+    }
+
+    return ret;
+  }
+
+  Metrics GetMetrics() { return ::GetMetrics(m_skiplist); }
+
+ private:
+  Allocator<Desc> m_descAllocator;
+  Allocator<NodeDesc> m_nodeDescAllocator;
+  trans_skip* m_skiplist;
+};
+
+#endif /* end of include guard: PQADAPTOR_H */
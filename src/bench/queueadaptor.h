@@ -0,0 +1,73 @@
+#ifndef QUEUEADAPTOR_H
+#define QUEUEADAPTOR_H
+
+#include <vector>
+
+#include "common/allocator.h"
+#include "common/metrics.h"
+#include "translink/queue/transqueue.h"
+
+enum QueueOpType { QUEUE_ENQUEUE = 1, QUEUE_DEQUEUE };
+
+struct QueueOperator {
+  uint8_t type;
+  uint32_t value;  // for QUEUE_DEQUEUE, the removed item once committed
+};
+
+typedef std::vector<QueueOperator> QueueOpArray;
+
+template <typename T>
+class QueueAdaptor {};
+
+template <>
+class QueueAdaptor<TransQueue> {
+ public:
+  QueueAdaptor(uint64_t cap, uint64_t threadCount, uint32_t transSize)
+      : m_descAllocator(
+            cap * threadCount * TransQueue::Desc::SizeOf(transSize),
+            threadCount, TransQueue::Desc::SizeOf(transSize)),
+        m_nodeAllocator(
+            cap * threadCount * sizeof(TransQueue::Node) * transSize,
+            threadCount, sizeof(TransQueue::Node)),
+        m_nodeDescAllocator(
+            cap * threadCount * sizeof(TransQueue::NodeDesc) * transSize,
+            threadCount, sizeof(TransQueue::NodeDesc)),
+        m_queue(&m_nodeAllocator, &m_descAllocator, &m_nodeDescAllocator) {}
+
+  void Init() {
+    m_descAllocator.Init();
+    m_nodeAllocator.Init();
+    m_nodeDescAllocator.Init();
+  }
+
+  void Uninit() {}
+
+  bool ExecuteOps(QueueOpArray& ops) {
+    TransQueue::Desc* desc = m_queue.AllocateDesc(ops.size());
+
+    for (uint32_t i = 0; i < ops.size(); ++i) {
+      desc->ops[i].type = ops[i].type;
+      desc->ops[i].value = ops[i].value;
+    }
+
+    bool ret = m_queue.ExecuteOps(desc);
+
+    if (ret) {
+      for (uint32_t i = 0; i < ops.size(); ++i) {
+        ops[i].value = desc->ops[i].value;
+      }
+    }
+
+    return ret;
+  }
+
+  Metrics GetMetrics() { return m_queue.GetMetrics(); }
+
+ private:
+  Allocator<TransQueue::Desc> m_descAllocator;
+  Allocator<TransQueue::Node> m_nodeAllocator;
+  Allocator<TransQueue::NodeDesc> m_nodeDescAllocator;
+  TransQueue m_queue;
+};
+
+#endif /* end of include guard: QUEUEADAPTOR_H */
@@ -0,0 +1,101 @@
+#ifndef RANGEADAPTOR_H
+#define RANGEADAPTOR_H
+
+#include <vector>
+
+#include "bench/setadaptor.h"
+#include "common/allocator.h"
+#include "common/metrics.h"
+#include "translink/skiplist/transskip.h"
+
+enum RangeOpType { RANGE_FIND = 0, RANGE_INSERT, RANGE_DELETE, RANGE_SCAN };
+
+struct RangeOperator {
+  uint8_t type;
+  uint32_t key;    // lower bound of a scan
+  uint32_t hi;     // upper bound of a scan, not included
+  uint32_t count;  // keys a scan found, written back by ExecuteOps
+};
+
+typedef std::vector<RangeOperator> RangeOpArray;
+
+template <typename T>
+class RangeAdaptor {};
+
+// Scans collect into buffers kept per thread. Helpers only publish into the
+// Desc, so the buffers are free again once ExecuteOps returns.
+template <>
+class RangeAdaptor<trans_skip> {
+ public:
+  RangeAdaptor(uint64_t cap, uint64_t threadCount, uint32_t transSize,
+               uint32_t scanLength)
+      : m_descAllocator(cap * threadCount * Desc::RangeSizeOf(transSize),
+                        threadCount, Desc::RangeSizeOf(transSize)),
+        m_nodeDescAllocator(cap * threadCount * sizeof(NodeDesc) * transSize,
+                            threadCount, sizeof(NodeDesc)),
+        m_ranges(threadCount, std::vector<Range>(transSize)),
+        m_keys(threadCount,
+               std::vector<setkey_t>((uint64_t)transSize * scanLength)),
+        m_scanLength(scanLength) {
+    m_skiplist = transskip_alloc(&m_descAllocator, &m_nodeDescAllocator);
+    init_transskip_subsystem();
+  }
+
+  ~RangeAdaptor() { transskip_free(m_skiplist); }
+
+  void Init() {
+    m_descAllocator.Init();
+    m_nodeDescAllocator.Init();
+  }
+
+  void Uninit() { destroy_transskip_subsystem(); }
+
+  bool ExecuteOps(RangeOpArray& ops, int threadId) {
+    Desc* desc = m_descAllocator.Alloc();
+    desc->size = ops.size();
+    desc->status = LIVE;
+
+    std::vector<Range>& ranges = m_ranges[threadId];
+
+    for (uint32_t i = 0; i < ops.size(); ++i) {
+      desc->ops[i].key = ops[i].key;
+      desc->ops[i].value = ops[i].key;
+
+      if (ops[i].type == RANGE_SCAN) {
+        ranges[i].hi = ops[i].hi;
+        ranges[i].limit = m_scanLength;
+        ranges[i].count = 0;
+        ranges[i].keys = &m_keys[threadId][(uint64_t)i * m_scanLength];
+
+        desc->ops[i].type = OP_RANGE;
+        desc->ops[i].value = (uint64_t)&ranges[i];
+      } else {
+        desc->ops[i].type = ops[i].type;
+      }
+    }
+
+    bool ret = execute_ops(m_skiplist, desc);
+
+    if (ret) {
+      for (uint32_t i = 0; i < ops.size(); ++i) {
+        if (ops[i].type == RANGE_SCAN) {
+          ops[i].count = ranges[i].count;
+        }
+      }
+    }
+
+    return ret;
+  }
+
+  Metrics GetMetrics() { return ::GetMetrics(m_skiplist); }
+
+ private:
+  Allocator<Desc> m_descAllocator;
+  Allocator<NodeDesc> m_nodeDescAllocator;
+  trans_skip* m_skiplist;
+  std::vector<std::vector<Range> > m_ranges;
+  std::vector<std::vector<setkey_t> > m_keys;
+  uint32_t m_scanLength;
+};
+
+#endif /* end of include guard: RANGEADAPTOR_H */
@@ -4,11 +4,17 @@
 #include "boosting/list/boostinglist.h"
 #include "boosting/skiplist/boostingskip.h"
 #include "common/allocator.h"
+#include "common/metrics.h"
 #include "obslink/list/obslist.h"
 #include "obslink/skiplist/obsskip.h"
 #include "ostm/skiplist/stmskip.h"
 #include "rstm/list/rstmlist.hpp"
+#include "translink/bst/transbst.h"
+#include "translink/btree/transbtree.h"
+#include "translink/hash/transhash.h"
 #include "translink/list/translist.h"
+#include "translink/list/transunrolledlist.h"
+#include "translink/mdlist/transmdlist.h"
 #include "translink/skiplist/transskip.h"
 
 enum SetOpType { FIND = 0, INSERT, DELETE };
@@ -42,7 +48,6 @@ class SetAdaptor<TransList> {
     m_descAllocator.Init();
     m_nodeAllocator.Init();
     m_nodeDescAllocator.Init();
-    m_list.ResetMetrics();
   }
 
   void Uninit() {}
@@ -61,6 +66,8 @@ class SetAdaptor<TransList> {
     return m_list.ExecuteOps(desc);
   }
 
+  Metrics GetMetrics() { return m_list.GetMetrics(); }
+
  private:
   Allocator<TransList::Desc> m_descAllocator;
   Allocator<TransList::Node> m_nodeAllocator;
@@ -68,6 +75,237 @@ class SetAdaptor<TransList> {
   TransList m_list;
 };
 
+template <>
+class SetAdaptor<TransHash> {
+ public:
+  SetAdaptor(uint64_t cap, uint64_t threadCount, uint32_t transSize)
+      : m_descAllocator(cap * threadCount * TransHash::Desc::SizeOf(transSize),
+                        threadCount, TransHash::Desc::SizeOf(transSize)),
+        // Bucket sentinels come from the node pool too, never more of them
+        // than linked keys
+        m_nodeAllocator(
+            cap * threadCount * sizeof(TransHash::Node) * (transSize + 1),
+            threadCount, sizeof(TransHash::Node)),
+        m_nodeDescAllocator(
+            cap * threadCount * sizeof(TransHash::NodeDesc) * transSize,
+            threadCount, sizeof(TransHash::NodeDesc)),
+        m_set(&m_nodeAllocator, &m_descAllocator, &m_nodeDescAllocator) {}
+
+  void Init() {
+    m_descAllocator.Init();
+    m_nodeAllocator.Init();
+    m_nodeDescAllocator.Init();
+  }
+
+  void Uninit() {}
+
+  bool ExecuteOps(const SetOpArray& ops) {
+    TransHash::Desc* desc = m_set.AllocateDesc(ops.size());
+
+    for (uint32_t i = 0; i < ops.size(); ++i) {
+      desc->ops[i].type = ops[i].type;
+      desc->ops[i].key = ops[i].key;
+    }
+
+    return m_set.ExecuteOps(desc);
+  }
+
+  Metrics GetMetrics() { return m_set.GetMetrics(); }
+
+ private:
+  Allocator<TransHash::Desc> m_descAllocator;
+  Allocator<TransHash::Node> m_nodeAllocator;
+  Allocator<TransHash::NodeDesc> m_nodeDescAllocator;
+  TransHash m_set;
+};
+
+template <>
+class SetAdaptor<TransBST> {
+ public:
+  SetAdaptor(uint64_t cap, uint64_t threadCount, uint32_t transSize)
+      : m_descAllocator(cap * threadCount * TransBST::Desc::SizeOf(transSize),
+                        threadCount, TransBST::Desc::SizeOf(transSize)),
+        // Every new key brings a leaf and an internal node
+        m_nodeAllocator(
+            cap * threadCount * sizeof(TransBST::Node) * transSize * 2,
+            threadCount, sizeof(TransBST::Node)),
+        m_nodeDescAllocator(
+            cap * threadCount * sizeof(TransBST::NodeDesc) * transSize,
+            threadCount, sizeof(TransBST::NodeDesc)),
+        m_set(&m_nodeAllocator, &m_descAllocator, &m_nodeDescAllocator) {}
+
+  void Init() {
+    m_descAllocator.Init();
+    m_nodeAllocator.Init();
+    m_nodeDescAllocator.Init();
+  }
+
+  void Uninit() {}
+
+  bool ExecuteOps(const SetOpArray& ops) {
+    TransBST::Desc* desc = m_set.AllocateDesc(ops.size());
+
+    for (uint32_t i = 0; i < ops.size(); ++i) {
+      desc->ops[i].type = ops[i].type;
+      desc->ops[i].key = ops[i].key;
+    }
+
+    return m_set.ExecuteOps(desc);
+  }
+
+  Metrics GetMetrics() { return m_set.GetMetrics(); }
+
+ private:
+  Allocator<TransBST::Desc> m_descAllocator;
+  Allocator<TransBST::Node> m_nodeAllocator;
+  Allocator<TransBST::NodeDesc> m_nodeDescAllocator;
+  TransBST m_set;
+};
+
+template <>
+class SetAdaptor<TransUnrolledList> {
+ public:
+  SetAdaptor(uint64_t cap, uint64_t threadCount, uint32_t transSize)
+      : m_descAllocator(
+            cap * threadCount * TransUnrolledList::Desc::SizeOf(transSize),
+            threadCount, TransUnrolledList::Desc::SizeOf(transSize)),
+        // Every new key copies a node, split in two when it is full
+        m_nodeAllocator(
+            cap * threadCount * sizeof(TransUnrolledList::Node) * transSize * 2,
+            threadCount, sizeof(TransUnrolledList::Node)),
+        m_nodeDescAllocator(
+            cap * threadCount * sizeof(TransUnrolledList::NodeDesc) * transSize,
+            threadCount, sizeof(TransUnrolledList::NodeDesc)),
+        m_set(&m_nodeAllocator, &m_descAllocator, &m_nodeDescAllocator) {}
+
+  void Init() {
+    m_descAllocator.Init();
+    m_nodeAllocator.Init();
+    m_nodeDescAllocator.Init();
+  }
+
+  void Uninit() {}
+
+  bool ExecuteOps(const SetOpArray& ops) {
+    TransUnrolledList::Desc* desc = m_set.AllocateDesc(ops.size());
+
+    for (uint32_t i = 0; i < ops.size(); ++i) {
+      desc->ops[i].type = ops[i].type;
+      desc->ops[i].key = ops[i].key;
+    }
+
+    return m_set.ExecuteOps(desc);
+  }
+
+  Metrics GetMetrics() { return m_set.GetMetrics(); }
+
+ private:
+  Allocator<TransUnrolledList::Desc> m_descAllocator;
+  Allocator<TransUnrolledList::Node> m_nodeAllocator;
+  Allocator<TransUnrolledList::NodeDesc> m_nodeDescAllocator;
+  TransUnrolledList m_set;
+};
+
+template <>
+class SetAdaptor<TransMDList> {
+ public:
+  SetAdaptor(uint64_t cap, uint64_t threadCount, uint32_t transSize)
+      : m_descAllocator(
+            cap * threadCount * TransMDList::Desc::SizeOf(transSize),
+            threadCount, TransMDList::Desc::SizeOf(transSize)),
+        m_nodeAllocator(
+            cap * threadCount * sizeof(TransMDList::Node) * transSize,
+            threadCount, sizeof(TransMDList::Node)),
+        m_adoptDescAllocator(
+            cap * threadCount * sizeof(TransMDList::AdoptDesc) * transSize,
+            threadCount, sizeof(TransMDList::AdoptDesc)),
+        m_nodeDescAllocator(
+            cap * threadCount * sizeof(TransMDList::NodeDesc) * transSize,
+            threadCount, sizeof(TransMDList::NodeDesc)),
+        m_set(&m_nodeAllocator, &m_adoptDescAllocator, &m_descAllocator,
+              &m_nodeDescAllocator) {}
+
+  void Init() {
+    m_descAllocator.Init();
+    m_nodeAllocator.Init();
+    m_adoptDescAllocator.Init();
+    m_nodeDescAllocator.Init();
+  }
+
+  void Uninit() {}
+
+  bool ExecuteOps(const SetOpArray& ops) {
+    TransMDList::Desc* desc = m_set.AllocateDesc(ops.size());
+
+    for (uint32_t i = 0; i < ops.size(); ++i) {
+      desc->ops[i].type = ops[i].type;
+      desc->ops[i].key = ops[i].key;
+    }
+
+    return m_set.ExecuteOps(desc);
+  }
+
+  Metrics GetMetrics() { return m_set.GetMetrics(); }
+
+ private:
+  Allocator<TransMDList::Desc> m_descAllocator;
+  Allocator<TransMDList::Node> m_nodeAllocator;
+  Allocator<TransMDList::AdoptDesc> m_adoptDescAllocator;
+  Allocator<TransMDList::NodeDesc> m_nodeDescAllocator;
+  TransMDList m_set;
+};
+
+template <>
+class SetAdaptor<TransBTree> {
+ public:
+  SetAdaptor(uint64_t cap, uint64_t threadCount, uint32_t transSize)
+      : m_descAllocator(
+            cap * threadCount * TransBTree::Desc::SizeOf(transSize),
+            threadCount, TransBTree::Desc::SizeOf(transSize)),
+        // A split leaves two half full nodes, keep room for twice that
+        m_nodeAllocator((cap * transSize * 4 / TransBTree::LEAF_SLOTS + 16) *
+                            threadCount * sizeof(TransBTree::Leaf),
+                        threadCount, sizeof(TransBTree::Leaf)),
+        m_entryAllocator(
+            cap * threadCount * sizeof(TransBTree::Entry) * transSize,
+            threadCount, sizeof(TransBTree::Entry)),
+        m_nodeDescAllocator(
+            cap * threadCount * sizeof(TransBTree::NodeDesc) * transSize,
+            threadCount, sizeof(TransBTree::NodeDesc)),
+        m_set(&m_nodeAllocator, &m_entryAllocator, &m_descAllocator,
+              &m_nodeDescAllocator) {}
+
+  void Init() {
+    m_descAllocator.Init();
+    m_nodeAllocator.Init();
+    m_entryAllocator.Init();
+    m_nodeDescAllocator.Init();
+  }
+
+  void Uninit() {}
+
+  bool ExecuteOps(const SetOpArray& ops) {
+    TransBTree::Desc* desc = m_set.AllocateDesc(ops.size());
+
+    for (uint32_t i = 0; i < ops.size(); ++i) {
+      desc->ops[i].type = ops[i].type;
+      desc->ops[i].key = ops[i].key;
+      desc->ops[i].value = 0;
+    }
+
+    return m_set.ExecuteOps(desc);
+  }
+
+  Metrics GetMetrics() { return m_set.GetMetrics(); }
+
+ private:
+  Allocator<TransBTree::Desc> m_descAllocator;
+  Allocator<TransBTree::Leaf> m_nodeAllocator;
+  Allocator<TransBTree::Entry> m_entryAllocator;
+  Allocator<TransBTree::NodeDesc> m_nodeDescAllocator;
+  TransBTree m_set;
+};
+
 template <>
 class SetAdaptor<trans_skip> {
  public:
@@ -85,7 +323,6 @@ class SetAdaptor<trans_skip> {
   void Init() {
     m_descAllocator.Init();
     m_nodeDescAllocator.Init();
-    ResetMetrics(m_skiplist);
   }
 
   void Uninit() { destroy_transskip_subsystem(); }
@@ -104,6 +341,8 @@ class SetAdaptor<trans_skip> {
     return execute_ops(m_skiplist, desc);
   }
 
+  Metrics GetMetrics() { return ::GetMetrics(m_skiplist); }
+
  private:
   Allocator<Desc> m_descAllocator;
   Allocator<NodeDesc> m_nodeDescAllocator;
@@ -127,7 +366,6 @@ class SetAdaptor<ObsList> {
     m_descAllocator.Init();
     m_nodeAllocator.Init();
     m_nodeDescAllocator.Init();
-    m_list.ResetMetrics();
   }
 
   void Uninit() {}
@@ -146,6 +384,8 @@ class SetAdaptor<ObsList> {
     return m_list.ExecuteOps(desc);
   }
 
+  Metrics GetMetrics() { return m_list.GetMetrics(); }
+
  private:
   Allocator<ObsList::Desc> m_descAllocator;
   Allocator<ObsList::Node> m_nodeAllocator;
@@ -170,7 +410,6 @@ class SetAdaptor<obs_skip> {
   void Init() {
     m_descAllocator.Init();
     m_nodeDescAllocator.Init();
-    ResetMetrics(m_skiplist);
   }
 
   void Uninit() { destroy_obsskip_subsystem(); }
@@ -189,6 +428,8 @@ class SetAdaptor<obs_skip> {
     return execute_ops(m_skiplist, desc);
   }
 
+  Metrics GetMetrics() { return ::GetMetrics(m_skiplist); }
+
  private:
   Allocator<Desc_o> m_descAllocator;
   Allocator<NodeDesc_o> m_nodeDescAllocator;
@@ -200,28 +441,20 @@ class SetAdaptor<RSTMList> {
  public:
   SetAdaptor() { TM_SYS_INIT(); }
 
-  ~SetAdaptor() {
-    TM_SYS_SHUTDOWN();
-
-    printf("Total commit %u, abort (total/fake) %u/%u\n", g_count_commit,
-           g_count_abort, g_count_stm_abort - g_count_abort);
-  }
-
-  void Init() {
-    TM_THREAD_INIT();
-    ResetMetrics();
-  }
+  ~SetAdaptor() { TM_SYS_SHUTDOWN(); }
 
-  void Uninit() {
-    TM_THREAD_SHUTDOWN();
-    TM_GET_THREAD();
+  void Init() { TM_THREAD_INIT(); }
 
-    __sync_fetch_and_add(&g_count_stm_abort, tx->num_aborts);
-  }
+  void Uninit() { TM_THREAD_SHUTDOWN(); }
 
   bool ExecuteOps(const SetOpArray& ops) __attribute__((optimize(0))) {
     bool ret = true;
 
+    // Aborts are folded in per transaction so that GetMetrics() is current
+    // while threads are still running
+    TM_GET_THREAD();
+    uint32_t stmAborts = tx->num_aborts;
+
     TM_BEGIN(atomic) {
       if (ret == true) {
         for (uint32_t i = 0; i < ops.size(); ++i) {
@@ -250,21 +483,25 @@ class SetAdaptor<RSTMList> {
       __sync_fetch_and_add(&g_count_abort, 1);
     }
 
+    if (tx->num_aborts != stmAborts) {
+      __sync_fetch_and_add(&g_count_stm_abort, tx->num_aborts - stmAborts);
+    }
+
     return ret;
   }
 
+  Metrics GetMetrics() {
+    Metrics metrics = {g_count_commit, g_count_abort,
+                       g_count_stm_abort - g_count_abort};
+    return metrics;
+  }
+
  private:
   RSTMList m_list;
 
   uint32_t g_count_commit = 0;
   uint32_t g_count_abort = 0;
   uint32_t g_count_stm_abort = 0;
-
-  void ResetMetrics() {
-    g_count_commit = 0;
-    g_count_abort = 0;
-    g_count_stm_abort = 0;
-  };
 };
 
 template <>
@@ -277,7 +514,7 @@ class SetAdaptor<stm_skip> {
 
   ~SetAdaptor() { destory_stmskip_subsystem(); }
 
-  void Init() { ResetMetrics(); }
+  void Init() {}
 
   void Uninit() {}
 
@@ -287,6 +524,8 @@ class SetAdaptor<stm_skip> {
     return ret;
   }
 
+  Metrics GetMetrics() { return ::GetMetrics(); }
+
  private:
   stm_skip* m_list;
 };
@@ -298,10 +537,7 @@ class SetAdaptor<BoostingList> {
 
   ~SetAdaptor() {}
 
-  void Init() {
-    m_list.Init();
-    m_list.ResetMetrics();
-  }
+  void Init() { m_list.Init(); }
 
   void Uninit() { m_list.Uninit(); }
 
@@ -332,6 +568,8 @@ class SetAdaptor<BoostingList> {
     return ret;
   }
 
+  Metrics GetMetrics() { return m_list.GetMetrics(); }
+
  private:
   BoostingList m_list;
 };
@@ -343,10 +581,7 @@ class SetAdaptor<BoostingSkip> {
 
   ~SetAdaptor() {}
 
-  void Init() {
-    m_list.Init();
-    m_list.ResetMetrics();
-  }
+  void Init() { m_list.Init(); }
 
   void Uninit() { m_list.Uninit(); }
 
@@ -377,6 +612,8 @@ class SetAdaptor<BoostingSkip> {
     return ret;
   }
 
+  Metrics GetMetrics() { return m_list.GetMetrics(); }
+
  private:
   BoostingSkip m_list;
 };
@@ -0,0 +1,76 @@
+#ifndef VECTORADAPTOR_H
+#define VECTORADAPTOR_H
+
+#include <vector>
+
+#include "common/allocator.h"
+#include "common/metrics.h"
+#include "translink/vector/transvector.h"
+
+enum VectorOpType { VECTOR_READ = 0, VECTOR_PUSH, VECTOR_POP, VECTOR_WRITE };
+
+struct VectorOperator {
+  uint8_t type;
+  uint32_t index;  // for VECTOR_READ and VECTOR_WRITE
+  uint32_t value;  // for VECTOR_READ and VECTOR_POP, the value once committed
+};
+
+typedef std::vector<VectorOperator> VectorOpArray;
+
+template <typename T>
+class VectorAdaptor {};
+
+template <>
+class VectorAdaptor<TransVector> {
+ public:
+  VectorAdaptor(uint64_t cap, uint64_t threadCount, uint32_t transSize)
+      : m_descAllocator(
+            cap * threadCount * TransVector::Desc::SizeOf(transSize),
+            threadCount, TransVector::Desc::SizeOf(transSize)),
+        m_nodeDescAllocator(
+            cap * threadCount * sizeof(TransVector::NodeDesc) * transSize,
+            threadCount, sizeof(TransVector::NodeDesc)),
+        m_sizeDescAllocator(
+            cap * threadCount * sizeof(TransVector::SizeDesc) * transSize,
+            threadCount, sizeof(TransVector::SizeDesc)),
+        m_vector(&m_descAllocator, &m_nodeDescAllocator,
+                 &m_sizeDescAllocator) {}
+
+  void Init() {
+    m_descAllocator.Init();
+    m_nodeDescAllocator.Init();
+    m_sizeDescAllocator.Init();
+  }
+
+  void Uninit() {}
+
+  bool ExecuteOps(VectorOpArray& ops) {
+    TransVector::Desc* desc = m_vector.AllocateDesc(ops.size());
+
+    for (uint32_t i = 0; i < ops.size(); ++i) {
+      desc->ops[i].type = ops[i].type;
+      desc->ops[i].index = ops[i].index;
+      desc->ops[i].value = ops[i].value;
+    }
+
+    bool ret = m_vector.ExecuteOps(desc);
+
+    if (ret) {
+      for (uint32_t i = 0; i < ops.size(); ++i) {
+        ops[i].value = desc->ops[i].value;
+      }
+    }
+
+    return ret;
+  }
+
+  Metrics GetMetrics() { return m_vector.GetMetrics(); }
+
+ private:
+  Allocator<TransVector::Desc> m_descAllocator;
+  Allocator<TransVector::NodeDesc> m_nodeDescAllocator;
+  Allocator<TransVector::SizeDesc> m_sizeDescAllocator;
+  TransVector m_vector;
+};
+
+#endif /* end of include guard: VECTORADAPTOR_H */
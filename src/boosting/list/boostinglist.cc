@@ -3,9 +3,6 @@
 __thread BoostingList::LogType* BoostingList::m_log;
 
 BoostingList::~BoostingList() {
-  printf("Total commit %u, abort (total/fake) %u/%u\n", g_count_commit,
-         g_count_abort, g_count_fake_abort);
-
   ASSERT_CODE(
       printf("Total node count %u, Inserts %u, Deletions %u, Finds %u\n",
              g_count, g_count_ins, g_count_del, g_count_fnd);
@@ -99,8 +96,7 @@ void BoostingList::OnCommit() {
 
 void BoostingList::Print() { m_list.Print(); }
 
-void BoostingList::ResetMetrics() {
-  g_count_commit = 0;
-  g_count_abort = 0;
-  g_count_fake_abort = 0;
+Metrics BoostingList::GetMetrics() const {
+  Metrics metrics = {g_count_commit, g_count_abort, g_count_fake_abort};
+  return metrics;
 }
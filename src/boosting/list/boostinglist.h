@@ -6,6 +6,7 @@
 #include "boosting/list/lockfreelist.h"
 #include "boosting/lockkey.h"
 #include "common/assert.h"
+#include "common/metrics.h"
 
 class BoostingList {
   enum OpType { FIND = 0, INSERT, DELETE };
@@ -42,7 +43,7 @@ class BoostingList {
 
   void Print();
 
-  void ResetMetrics();
+  Metrics GetMetrics() const;
 
  private:
   LockfreeList m_list;
@@ -6,9 +6,6 @@ BoostingMap::BoostingMap(int initalPowerOfTwo, int numThreads)
     : m_list(initalPowerOfTwo, numThreads) {}
 
 BoostingMap::~BoostingMap() {
-  printf("Total commit %u, abort (total/fake) %u/%u\n", g_count_commit,
-         g_count_abort, g_count_fake_abort);
-
   ASSERT_CODE(
       printf("Total node count %u, Inserts %u, Deletions %u, Finds %u\n",
              g_count, g_count_ins, g_count_del, g_count_fnd);
@@ -134,3 +131,8 @@ void BoostingMap::OnCommit() {
 // {
 //     m_list.Print();
 // }
+
+Metrics BoostingMap::GetMetrics() const {
+  Metrics metrics = {g_count_commit, g_count_abort, g_count_fake_abort};
+  return metrics;
+}
@@ -6,6 +6,7 @@
 #include "boosting/lockkey.h"
 #include "boosting/map/nbmap.h"
 #include "common/assert.h"
+#include "common/metrics.h"
 
 class BoostingMap {
   enum OpType { FIND = 0, INSERT, DELETE, UPDATE };
@@ -62,6 +63,8 @@ class BoostingMap {
 
   void Print();
 
+  Metrics GetMetrics() const;
+
  private:
   LockKey m_lock;
   static __thread LogType* m_log;
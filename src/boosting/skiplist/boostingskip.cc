@@ -8,9 +8,6 @@ BoostingSkip::BoostingSkip() {
 }
 
 BoostingSkip::~BoostingSkip() {
-  printf("Total commit %u, abort (total/fake) %u/%u\n", g_count_commit,
-         g_count_abort, g_count_fake_abort);
-
   ASSERT_CODE(
       printf("Total node count %u, Inserts %u, Deletions %u, Finds %u\n",
              g_count, g_count_ins, g_count_del, g_count_fnd);
@@ -113,8 +110,7 @@ void BoostingSkip::OnCommit() {
 
 void BoostingSkip::Print() { boostskip_print(m_list); }
 
-void BoostingSkip::ResetMetrics() {
-  g_count_commit = 0;
-  g_count_abort = 0;
-  g_count_fake_abort = 0;
+Metrics BoostingSkip::GetMetrics() const {
+  Metrics metrics = {g_count_commit, g_count_abort, g_count_fake_abort};
+  return metrics;
 }
@@ -8,6 +8,7 @@ extern "C" {
 #include "boosting/skiplist/lockfreeskip.h"
 }
 #include "common/assert.h"
+#include "common/metrics.h"
 
 class BoostingSkip {
   enum OpType { FIND = 0, INSERT, DELETE };
@@ -45,7 +46,7 @@ class BoostingSkip {
 
   void Print();
 
-  void ResetMetrics();
+  Metrics GetMetrics() const;
 
  private:
   boost_skip* m_list;
@@ -2,12 +2,17 @@
 #define ALLOCATOR_H
 
 #include <cstdint>
+#include <cstring>
 #include <malloc.h>
 #include <atomic>
 #include <common/assert.h>
 
 #include <iostream>
 
+#ifndef CACHE_LINE_SIZE
+#define CACHE_LINE_SIZE 64
+#endif
+
 template<typename DataType>
 class Allocator 
 {
@@ -22,10 +27,18 @@ public:
         m_pool = (char*)memalign(m_typeSize, totalBytes);
 
         ASSERT(m_pool, "Memory pool initialization failed.");
+
+        // One cache line per thread so that usage can be read from any thread
+        // without the allocating threads sharing a line
+        m_usage = (char*)memalign(CACHE_LINE_SIZE,
+                                  threadCount * CACHE_LINE_SIZE);
+        ASSERT(m_usage, "Memory pool usage initialization failed.");
+        memset(m_usage, 0, threadCount * CACHE_LINE_SIZE);
     }
 
     ~Allocator()
     {
+        free(m_usage);
         free(m_pool);
     }
 
@@ -36,7 +49,8 @@ public:
         ASSERT(threadId < m_threadCount, "ThreadId specified should be smaller than thread count.");
 
         m_base = m_pool + threadId * m_totalBytes / m_threadCount;
-        m_freeIndex = 0;
+        m_freeIndex = (uint64_t*)(m_usage + threadId * CACHE_LINE_SIZE);
+        *m_freeIndex = 0;
     }
 
     void Uninit()
@@ -44,28 +58,55 @@ public:
 
     DataType* Alloc()
     {
-        ASSERT(m_freeIndex < m_totalBytes / m_threadCount, "out of capacity.");
-        char* ret = m_base + m_freeIndex;
-        m_freeIndex += m_typeSize;
+        uint64_t& freeIndex = *m_freeIndex;
+        ASSERT(freeIndex < m_totalBytes / m_threadCount, "out of capacity.");
+        char* ret = m_base + freeIndex;
+        freeIndex += m_typeSize;
 
         return (DataType*)ret;
     }
 
+    // Bytes set aside for the pool, whether handed out or not
+    uint64_t BytesReserved() const
+    {
+        return m_totalBytes;
+    }
+
+    // Bytes handed out so far by all threads; the pool never frees, so this
+    // only grows until the allocator is destroyed
+    uint64_t BytesUsed() const
+    {
+        uint64_t used = 0;
+        for(uint64_t i = 0; i < m_threadCount; ++i)
+        {
+            used += *(volatile uint64_t*)(m_usage + i * CACHE_LINE_SIZE);
+        }
+
+        return used;
+    }
+
+    // Number of objects handed out so far by all threads
+    uint64_t Allocated() const
+    {
+        return BytesUsed() / m_typeSize;
+    }
+
 private:
     char* m_pool;
     uint64_t m_totalBytes;      //number of elements T in the pool
     uint64_t m_threadCount;
     uint64_t m_ticket;
     uint64_t m_typeSize;
+    char* m_usage;              //per-thread free index, one cache line each
 
     static __thread char* m_base;
-    static __thread uint64_t m_freeIndex;
+    static __thread uint64_t* m_freeIndex;
 };
 
 template<typename T>
 __thread char* Allocator<T>::m_base;
 
 template<typename T>
-__thread uint64_t Allocator<T>::m_freeIndex;
+__thread uint64_t* Allocator<T>::m_freeIndex;
 
 #endif /* end of include guard: ALLOCATOR_H */
@@ -27,20 +27,21 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/mman.h>
+#include <time.h>
 #include <unistd.h>
 #include "portable_defns.h"
 #include "gc.h"
+#include "gcstats.h"
 
 /*#define MINIMAL_GC*/
 /*#define YIELD_TO_HELP_PROGRESS*/
-/*#define PROFILE_GC*/
 
 /* Recycled nodes are filled with this value if WEAK_MEM_ORDER. */
 #define INVALID_BYTE 0
 #define INITIALISE_NODES(_p,_c) memset((_p), INVALID_BYTE, (_c));
 
 /* Number of unique block sizes we can deal with. */
-#define MAX_SIZES 20
+#define MAX_SIZES GC_MAX_SIZES
 
 #define MAX_HOOKS 4
 
@@ -122,10 +123,20 @@ static struct gc_global_st
     /* Main allocation lists. */
     chunk_t * VOLATILE alloc[MAX_SIZES];
     VOLATILE unsigned int alloc_size[MAX_SIZES];
-#ifdef PROFILE_GC
-    VOLATILE unsigned int total_size;
-    VOLATILE unsigned int allocations;
-#endif
+
+    /* Bytes of blocks obtained from the heap, per block size. */
+    VOLATILE unsigned long reserved_bytes[MAX_SIZES];
+    CACHE_PAD(4);
+
+    /*
+     * STATISTICS: written with CAS on the (rare) heap paths, or by the
+     * single thread inside gc_reclaim().
+     */
+    VOLATILE unsigned int heap_allocations;
+    VOLATILE unsigned int chunk_allocations;
+    unsigned long epoch_advances;
+    unsigned long reclaim_lagging;
+    struct timespec start;
 } gc_global;
 
 
@@ -156,6 +167,20 @@ struct gc_st
     chunk_t *alloc[MAX_SIZES];
     unsigned int alloc_chunks[MAX_SIZES];
 
+    /* Blocks handed out and given back by this thread, per block size. */
+    unsigned long allocs[MAX_SIZES];
+    unsigned long frees[MAX_SIZES];
+
+    /*
+     * Blocks put on, and taken off (by gc_reclaim), each garbage list.
+     * Their difference is the backlog waiting for the epoch to advance.
+     */
+    unsigned long garbage_in[NR_EPOCHS][MAX_SIZES];
+    unsigned long garbage_out[NR_EPOCHS][MAX_SIZES];
+
+    /* Number of gc_reclaim() calls made by this thread. */
+    unsigned long reclaim_attempts;
+
     /* Hook pointer lists. */
     chunk_t *hook[NR_EPOCHS][MAX_HOOKS];
 };
@@ -177,6 +202,7 @@ static chunk_t *alloc_more_chunks(void)
 
     h = p = ALIGNED_ALLOC(CHUNKS_PER_ALLOC * sizeof(*h));
     if ( h == NULL ) MEM_FAIL(CHUNKS_PER_ALLOC * sizeof(*h));
+    ADD_TO(gc_global.chunk_allocations, 1);
 
     for ( i = 1; i < CHUNKS_PER_ALLOC; i++ )
     {
@@ -231,20 +257,22 @@ static chunk_t *get_empty_chunks(int n)
 }
 
 
-/* Get @n filled chunks, pointing at blocks of @sz bytes each. */
-static chunk_t *get_filled_chunks(int n, int sz)
+/* Get @n filled chunks, pointing at blocks of allocator @id. */
+static chunk_t *get_filled_chunks(int n, int id)
 {
     chunk_t *h, *p;
     char *node;
-    int i;
-
-#ifdef PROFILE_GC
-    ADD_TO(gc_global.total_size, n * BLKS_PER_CHUNK * sz);
-    ADD_TO(gc_global.allocations, 1);
-#endif
+    int i, sz = gc_global.blk_sizes[id];
+    unsigned long r, nr;
 
     node = ALIGNED_ALLOC(n * BLKS_PER_CHUNK * sz);
     if ( node == NULL ) MEM_FAIL(n * BLKS_PER_CHUNK * sz);
+    ADD_TO(gc_global.heap_allocations, 1);
+
+    r = gc_global.reserved_bytes[id];
+    while ( (nr = CASIO(&gc_global.reserved_bytes[id], r,
+                        r + (unsigned long)n * BLKS_PER_CHUNK * sz)) != r )
+        r = nr;
 #ifdef WEAK_MEM_ORDER
     INITIALISE_NODES(node, n * BLKS_PER_CHUNK * sz);
 #endif
@@ -297,7 +325,7 @@ static chunk_t *get_alloc_chunk(gc_t *gc, int i)
         while ( p == alloc )
         {
             sz = gc_global.alloc_size[i];
-            nh = get_filled_chunks(sz, gc_global.blk_sizes[i]);
+            nh = get_filled_chunks(sz, i);
             ADD_TO(gc_global.alloc_size[i], sz >> 3);
             gc_async_barrier(gc);
             add_chunks_to_list(nh, alloc);
@@ -325,7 +353,7 @@ static void gc_reclaim(void)
     ptst_t       *ptst, *first_ptst, *our_ptst = NULL;
     gc_t         *gc = NULL;
     unsigned long curr_epoch;
-    chunk_t      *ch, *t;
+    chunk_t      *ch, *t, *p;
     int           two_ago, three_ago, i, j;
     
     /* Barrier to entering the reclaim critical section. */
@@ -342,7 +370,11 @@ static void gc_reclaim(void)
     /* Have all threads seen the current epoch, or not in mutator code? */
     for ( ptst = first_ptst; ptst != NULL; ptst = ptst_next(ptst) )
     {
-        if ( (ptst->count > 1) && (ptst->gc->epoch != curr_epoch) ) goto out;
+        if ( (ptst->count > 1) && (ptst->gc->epoch != curr_epoch) )
+        {
+            gc_global.reclaim_lagging++;
+            goto out;
+        }
     }
 
     /*
@@ -377,6 +409,8 @@ static void gc_reclaim(void)
             /* NB. Leave one chunk behind, as it is probably not yet full. */
             t = gc->garbage[three_ago][i];
             if ( (t == NULL) || ((ch = t->next) == t) ) continue;
+            for ( p = ch; p != t; p = p->next )
+                gc->garbage_out[three_ago][i] += p->i;
             gc->garbage_tail[three_ago][i]->next = ch;
             gc->garbage_tail[three_ago][i] = t;
             t->next = t;
@@ -401,6 +435,7 @@ static void gc_reclaim(void)
     /* Update current epoch. */
     WMB();
     gc_global.current = (curr_epoch+1) % NR_EPOCHS;
+    gc_global.epoch_advances++;
 
  out:
     gc_global.inreclaim = 0;
@@ -432,6 +467,7 @@ void *fr_gc_alloc(ptst_t *ptst, int alloc_id)
         }
     }
 
+    gc->allocs[alloc_id]++;
     return ch->blk[--ch->i];
 }
 
@@ -461,6 +497,9 @@ void fr_gc_free(ptst_t *ptst, void *p, int alloc_id)
     gc_t *gc = ptst->gc;
     chunk_t *prev, *new, *ch = gc->garbage[gc->epoch][alloc_id];
 
+    gc->frees[alloc_id]++;
+    gc->garbage_in[gc->epoch][alloc_id]++;
+
     if ( ch == NULL )
     {
         gc->garbage[gc->epoch][alloc_id] = ch = chunk_from_cache(gc);
@@ -514,6 +553,7 @@ void fr_gc_unsafe_free(ptst_t *ptst, void *p, int alloc_id)
     ch = gc->alloc[alloc_id];
     if ( ch->i < BLKS_PER_CHUNK )
     {
+        gc->frees[alloc_id]++;
         ch->blk[ch->i++] = p;
     }
     else
@@ -557,6 +597,7 @@ void fr_gc_enter(ptst_t *ptst)
             }
 #endif
             gc->entries_since_reclaim = 0;
+            gc->reclaim_attempts++;
             gc_reclaim();
             goto retry;    
         }
@@ -611,7 +652,7 @@ int fr_gc_add_allocator(int alloc_size)
     while ( (ni = CASIO(&gc_global.nr_sizes, i, i+1)) != i ) i = ni;
     gc_global.blk_sizes[i]  = alloc_size;
     gc_global.alloc_size[i] = ALLOC_CHUNKS_PER_LIST;
-    gc_global.alloc[i] = get_filled_chunks(ALLOC_CHUNKS_PER_LIST, alloc_size);
+    gc_global.alloc[i] = get_filled_chunks(ALLOC_CHUNKS_PER_LIST, i);
     return i;
 }
 
@@ -637,13 +678,111 @@ void fr_gc_remove_hook(int hook_id)
 }
 
 
+void fr_gc_get_usage(int alloc_id, unsigned long *reserved,
+                     unsigned long *used)
+{
+    ptst_t *ptst;
+    long    live = 0;
+
+    for ( ptst = ptst_first(); ptst != NULL; ptst = ptst_next(ptst) )
+    {
+        live += (long)(ptst->gc->allocs[alloc_id] - ptst->gc->frees[alloc_id]);
+    }
+
+    /* Blocks may be freed by a thread other than the allocating one. */
+    if ( live < 0 ) live = 0;
+
+    *reserved = gc_global.reserved_bytes[alloc_id];
+    *used     = (unsigned long)live * gc_global.blk_sizes[alloc_id];
+}
+
+
+void fr_gc_get_stats(gc_stats_t *stats)
+{
+    ptst_t         *ptst;
+    gc_t           *gc;
+    struct timespec now;
+    unsigned int    curr_epoch;
+    int             i, e, age;
+
+    memset(stats, 0, sizeof(*stats));
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    stats->elapsed = (now.tv_sec - gc_global.start.tv_sec) +
+        (now.tv_nsec - gc_global.start.tv_nsec) / 1e9;
+
+    stats->epoch_advances    = gc_global.epoch_advances;
+    stats->reclaim_lagging   = gc_global.reclaim_lagging;
+    stats->chunk_allocations = gc_global.chunk_allocations;
+    stats->chunks            = (unsigned long)gc_global.chunk_allocations *
+        CHUNKS_PER_ALLOC;
+    stats->heap_allocations  = gc_global.heap_allocations;
+
+    stats->nr_epochs = NR_EPOCHS;
+    stats->nr_sizes  = gc_global.nr_sizes;
+    for ( i = 0; i < gc_global.nr_sizes; i++ )
+    {
+        stats->blk_sizes[i] = gc_global.blk_sizes[i];
+        stats->heap_bytes  += gc_global.reserved_bytes[i];
+    }
+
+    curr_epoch = gc_global.current;
+    for ( ptst = ptst_first(); ptst != NULL; ptst = ptst_next(ptst) )
+    {
+        gc = ptst->gc;
+        stats->reclaim_attempts += gc->reclaim_attempts;
+
+        for ( age = 0; age < NR_EPOCHS; age++ )
+        {
+            e = (curr_epoch + NR_EPOCHS - age) % NR_EPOCHS;
+            for ( i = 0; i < gc_global.nr_sizes; i++ )
+            {
+                /* Racy reads: never let a backlog go negative. */
+                if ( gc->garbage_in[e][i] > gc->garbage_out[e][i] )
+                    stats->garbage[age][i] +=
+                        gc->garbage_in[e][i] - gc->garbage_out[e][i];
+            }
+        }
+    }
+}
+
+
+void fr_gc_print_stats(const gc_stats_t *stats)
+{
+    unsigned long backlog = 0;
+    int           i, age;
+
+    for ( age = 0; age < stats->nr_epochs; age++ )
+        for ( i = 0; i < stats->nr_sizes; i++ )
+            backlog += stats->garbage[age][i];
+
+    printf("GC epochs advanced %lu (%.1f/s), reclaims (total/lagging) "
+           "%lu/%lu, garbage backlog %lu blocks\n",
+           stats->epoch_advances,
+           stats->elapsed > 0 ? stats->epoch_advances / stats->elapsed : 0.0,
+           stats->reclaim_attempts, stats->reclaim_lagging, backlog);
+    printf("GC heap %lu bytes in %lu allocations, chunks %lu in %lu "
+           "allocations\n",
+           stats->heap_bytes, stats->heap_allocations,
+           stats->chunks, stats->chunk_allocations);
+
+    for ( i = 0; i < stats->nr_sizes; i++ )
+    {
+        unsigned long sum = 0;
+        for ( age = 0; age < stats->nr_epochs; age++ )
+            sum += stats->garbage[age][i];
+        if ( sum == 0 ) continue;
+
+        printf("GC garbage %d-byte blocks by epoch age:", stats->blk_sizes[i]);
+        for ( age = 0; age < stats->nr_epochs; age++ )
+            printf(" %lu", stats->garbage[age][i]);
+        printf("\n");
+    }
+}
+
+
 void fr_destroy_gc_subsystem(void)
 {
-#ifdef PROFILE_GC
-    printf("Total heap: %u bytes (%.2fMB) in %u allocations\n",
-           gc_global.total_size, (double)gc_global.total_size / 1000000,
-           gc_global.allocations);
-#endif
 }
 
 
@@ -651,6 +790,8 @@ void fr_init_gc_subsystem(void)
 {
     memset(&gc_global, 0, sizeof(gc_global));
 
+    clock_gettime(CLOCK_MONOTONIC, &gc_global.start);
+
     gc_global.page_size   = (unsigned int)sysconf(_SC_PAGESIZE);
     gc_global.free_chunks = alloc_more_chunks();
 
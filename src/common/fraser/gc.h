@@ -5,6 +5,7 @@ typedef struct gc_st gc_t;
 
 /* Most of these functions peek into a per-thread state struct. */
 #include "ptst.h"
+#include "gcstats.h"
 
 /* Initialise GC section of given per-thread state structure. */
 gc_t *fr_gc_init(void);
@@ -20,6 +21,14 @@ void *fr_gc_alloc(ptst_t *ptst, int alloc_id);
 void fr_gc_free(ptst_t *ptst, void *p, int alloc_id);
 void fr_gc_unsafe_free(ptst_t *ptst, void *p, int alloc_id);
 
+/*
+ * Memory accounting for an allocator: bytes of blocks obtained from the
+ * heap, and bytes in blocks handed out and not yet freed. Blocks waiting
+ * in the garbage lists count as free.
+ */
+void fr_gc_get_usage(int alloc_id, unsigned long *reserved,
+                     unsigned long *used);
+
 /*
  * Hook registry. Allows users to hook in their own per-epoch delay
  * lists.
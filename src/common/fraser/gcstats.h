@@ -0,0 +1,65 @@
+/******************************************************************************
+ * gcstats.h
+ *
+ * Run-time statistics of the epoch-based garbage collector. Kept apart from
+ * gc.h so that C++ users can read them without the per-thread state headers.
+ */
+
+#ifndef __GCSTATS_H__
+#define __GCSTATS_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Upper bounds of the per-epoch and per-block-size tables in gc.c. */
+#define GC_MAX_EPOCHS 4
+#define GC_MAX_SIZES  20
+
+typedef struct gc_stats_st
+{
+    /* Seconds since the collector was initialised. */
+    double        elapsed;
+
+    /* Epoch changes, i.e. successful gc_reclaim() runs. */
+    unsigned long epoch_advances;
+
+    /*
+     * gc_reclaim() attempts, and those that gave up because some thread in
+     * a critical region had not yet seen the current epoch.
+     */
+    unsigned long reclaim_attempts;
+    unsigned long reclaim_lagging;
+
+    /* Calls to alloc_more_chunks(), and the chunk headers they obtained. */
+    unsigned long chunk_allocations;
+    unsigned long chunks;
+
+    /* Block arrays obtained from the heap, and their total size. */
+    unsigned long heap_allocations;
+    unsigned long heap_bytes;
+
+    /*
+     * Blocks freed but not yet back on an allocation list. Row 0 is the
+     * current epoch, row 1 the one before it, and so on.
+     */
+    int           nr_epochs;
+    int           nr_sizes;
+    int           blk_sizes[GC_MAX_SIZES];
+    unsigned long garbage[GC_MAX_EPOCHS][GC_MAX_SIZES];
+} gc_stats_t;
+
+/* Snapshot of the collector's statistics; safe to call at any time. */
+void fr_gc_get_stats(gc_stats_t *stats);
+
+/*
+ * Print a snapshot, or the difference of two, in the benchmark's report
+ * format.
+ */
+void fr_gc_print_stats(const gc_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __GCSTATS_H__ */
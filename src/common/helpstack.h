@@ -0,0 +1,54 @@
+#ifndef HELPSTACK_H
+#define HELPSTACK_H
+
+#include <cstdint>
+#include <cstdlib>
+
+#include "common/assert.h"
+
+// Descs being helped by a thread, checked for help cycles. Grows on the heap
+// as help chains get deeper, so it is never full. Kept thread_local, so the
+// buffer goes away with the thread.
+template <typename Desc>
+struct HelpStack {
+  HelpStack() : helps(NULL), index(0), capacity(0) {}
+
+  ~HelpStack() { free(helps); }
+
+  void Init() { index = 0; }
+
+  void Push(Desc* desc) {
+    if (index == capacity) {
+      capacity = capacity == 0 ? 64 : capacity * 2;
+      helps = static_cast<Desc**>(realloc(helps, capacity * sizeof(helps[0])));
+
+      ASSERT(helps, "help stack allocation failed");
+    }
+
+    helps[index++] = desc;
+  }
+
+  void Pop() {
+    ASSERT(index > 0, "nothing to pop");
+
+    index--;
+  }
+
+  bool Contain(Desc* desc) {
+    for (uint32_t i = 0; i < index; i++) {
+      if (helps[i] == desc) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  Desc* Top() { return helps[index - 1]; }
+
+  Desc** helps;
+  uint32_t index;
+  uint32_t capacity;
+};
+
+#endif /* end of include guard: HELPSTACK_H */
@@ -0,0 +1,40 @@
+#ifndef MEMSTATS_H
+#define MEMSTATS_H
+
+#include <cstdint>
+
+// Memory footprint of a structure. Node counts come from walking the
+// structure, so when taken during a run they are a weakly consistent view.
+struct MemoryStats {
+  uint64_t liveNodes;      // linked nodes whose key is logically present
+  uint64_t deletedNodes;   // linked nodes whose key is logically deleted
+  uint64_t descriptors;    // transaction descriptors handed out
+  uint64_t bytesReserved;  // bytes obtained from pools and the heap
+  uint64_t bytesUsed;      // reserved bytes currently backing live objects
+
+  MemoryStats& operator+=(const MemoryStats& rhs) {
+    liveNodes += rhs.liveNodes;
+    deletedNodes += rhs.deletedNodes;
+    descriptors += rhs.descriptors;
+    bytesReserved += rhs.bytesReserved;
+    bytesUsed += rhs.bytesUsed;
+
+    return *this;
+  }
+
+  // Adds a pool the structure allocates from, an Allocator or anything else
+  // that tells its reserved and used bytes
+  template <typename Pool>
+  void AddPool(const Pool* pool) {
+    bytesReserved += pool->BytesReserved();
+    bytesUsed += pool->BytesUsed();
+  }
+
+  // Adds memory taken from the heap, which is in use while it is reserved
+  void AddHeap(uint64_t bytes) {
+    bytesReserved += bytes;
+    bytesUsed += bytes;
+  }
+};
+
+#endif /* end of include guard: MEMSTATS_H */
@@ -0,0 +1,58 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <cstdint>
+
+#include "common/fraser/gcstats.h"
+#include "common/memstats.h"
+#include "common/tablestats.h"
+#include "common/threadstats.h"
+
+// Parts of Metrics a structure keeps beyond the transaction outcomes
+enum MetricsPart {
+  METRICS_TRAVERSAL = 1,
+  METRICS_MEMORY = 2,
+  METRICS_TABLE = 4,
+  METRICS_GC = 8,
+};
+
+// Transaction outcome counters every set/map adaptor can snapshot at any time.
+// Counters only grow, so the harness reports the difference between two
+// snapshots instead of resetting them. A structure that keeps traversal,
+// memory, table or GC statistics adds them and marks them in parts.
+struct Metrics {
+  uint64_t commits;
+  uint64_t aborts;      // all aborted transactions
+  uint64_t fakeAborts;  // aborts not caused by a failed operation: broken
+                        // helping cycles, or conflicts for the STM baselines
+
+  uint32_t parts;  // MetricsPart bits of the statistics below that are set
+  TraversalStats traversal;
+  MemoryStats memory;
+  TableStats table;
+  gc_stats_t gc;
+
+  // Counters are diffed. The memory footprint, the shape of the table and
+  // the GC backlog are states, so they are those of the later snapshot.
+  Metrics operator-(const Metrics& rhs) const {
+    Metrics ret = *this;
+    ret.commits -= rhs.commits;
+    ret.aborts -= rhs.aborts;
+    ret.fakeAborts -= rhs.fakeAborts;
+    ret.traversal = traversal - rhs.traversal;
+    ret.table = table - rhs.table;
+
+    ret.gc.elapsed -= rhs.gc.elapsed;
+    ret.gc.epoch_advances -= rhs.gc.epoch_advances;
+    ret.gc.reclaim_attempts -= rhs.gc.reclaim_attempts;
+    ret.gc.reclaim_lagging -= rhs.gc.reclaim_lagging;
+    ret.gc.chunk_allocations -= rhs.gc.chunk_allocations;
+    ret.gc.chunks -= rhs.gc.chunks;
+    ret.gc.heap_allocations -= rhs.gc.heap_allocations;
+    ret.gc.heap_bytes -= rhs.gc.heap_bytes;
+
+    return ret;
+  }
+};
+
+#endif /* end of include guard: METRICS_H */
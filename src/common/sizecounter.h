@@ -0,0 +1,183 @@
+#ifndef SIZECOUNTER_H
+#define SIZECOUNTER_H
+
+#include <malloc.h>
+
+#include <cstdint>
+#include <cstring>
+
+#include "common/assert.h"
+#include "common/threadstats.h"
+
+#ifndef CACHE_LINE_SIZE
+#define CACHE_LINE_SIZE 64
+#endif
+
+// Number of keys in a transactional set or map, without a shared counter.
+// Each thread has a cache-line aligned slot with the net change its finished
+// transactions made, and the transaction it is running. That one counts as
+// soon as its status says committed, whoever committed it, so the size moves
+// at the instant a transaction commits.
+//
+// Read() sums the slots twice, and again until both sums see every slot in
+// the same state. The state of a slot only moves forward, so each slot held
+// it all along in between, and the size is that of a single instant. A read
+// walks the slots of the threads that ran transactions, and only goes again
+// when one of them finished a transaction meanwhile.
+//
+// Delta gives the net change of a committed transaction, and 0 for one that
+// is still running or aborted. As in ThreadStats, slots are kept per counter
+// and found by ThreadId, so there is at most one per live thread id.
+//
+// A container whose Desc is shared through an owner only takes in the ops the
+// owner sends to it. Owners keep the target of each op in an array right
+// behind the ops, and run Begin with the target of the container.
+template <typename Desc>
+class SizeCounter {
+ public:
+  // The ops of a transaction the counter takes in
+  struct Share {
+    bool owned;
+    uint32_t target;
+
+    bool Counts(Desc* desc, uint32_t opid) const {
+      return !owned || reinterpret_cast<const uint32_t*>(
+                           &desc->ops[desc->size])[opid] == target;
+    }
+  };
+
+  typedef int64_t (*DeltaFn)(Desc* desc, const Share& share);
+
+  explicit SizeCounter(DeltaFn delta) : m_top(0), m_delta(delta) {
+    memset((void*)m_slots, 0, sizeof(m_slots));
+  }
+
+  ~SizeCounter() {
+    for (uint32_t i = 0; i < m_top; i++) {
+      free(m_slots[i]);
+    }
+  }
+
+  // Called by the thread running desc, before any other thread can see it
+  void Begin(Desc* desc) {
+    Share share = {false, 0};
+    Begin(desc, share);
+  }
+
+  // For the owner running desc, which sends ops to the container as target
+  void Begin(Desc* desc, uint32_t target) {
+    Share share = {true, target};
+    Begin(desc, share);
+  }
+
+  // Called by the same thread once desc is done
+  void End() {
+    Slot* s = m_slots[ThreadId::Get()];
+
+    // Odd while the slot is being written, see ReadSlot
+    __sync_fetch_and_add(&s->seq, 1);
+    s->total += m_delta(s->running, s->share);
+    s->running = NULL;
+    __sync_fetch_and_add(&s->seq, 1);
+  }
+
+  int64_t Read() const {
+    uint64_t before, after;
+    Collect(before);
+
+    while (true) {
+      int64_t again = Collect(after);
+
+      if (after == before) {
+        return again;
+      }
+
+      before = after;
+    }
+  }
+
+ private:
+  struct Slot {
+    volatile uint64_t seq;
+    volatile int64_t total;
+    Desc* volatile running;
+    Share share;  // of running, set before it
+  };
+
+  void Begin(Desc* desc, const Share& share) {
+    uint32_t id = ThreadId::Get();
+    Slot* s = m_slots[id];
+
+    if (s == NULL) {
+      s = Register(id);
+    }
+
+    s->share = share;
+    __sync_synchronize();
+    s->running = desc;
+  }
+
+  // Sums the slots. stamp adds up where each slot is: its seq counts the
+  // writes of its thread, and the running transaction adds one once it has
+  // committed a change. Neither goes back, so equal stamps mean no slot
+  // moved.
+  int64_t Collect(uint64_t& stamp) const {
+    int64_t size = 0;
+    stamp = 0;
+
+    for (uint32_t i = 0; i < m_top; i++) {
+      Slot* s = m_slots[i];
+      uint64_t seq;
+      bool changed;
+
+      if (s == NULL) {
+        continue;
+      }
+
+      size += ReadSlot(s, seq, changed);
+      stamp += 2 * seq + changed;
+    }
+
+    return size;
+  }
+
+  int64_t ReadSlot(Slot* s, uint64_t& seq, bool& changed) const {
+    while (true) {
+      seq = s->seq;
+      __sync_synchronize();
+
+      int64_t total = s->total;
+      Desc* running = s->running;
+      int64_t delta = running != NULL ? m_delta(running, s->share) : 0;
+      changed = delta != 0;
+
+      __sync_synchronize();
+      if (seq % 2 == 0 && seq == s->seq) {
+        return total + delta;
+      }
+    }
+  }
+
+  Slot* Register(uint32_t id) {
+    size_t bytes =
+        (sizeof(Slot) + CACHE_LINE_SIZE - 1) & ~(CACHE_LINE_SIZE - 1);
+    Slot* s = (Slot*)memalign(CACHE_LINE_SIZE, bytes);
+    ASSERT(s, "Size slot allocation failed.");
+    memset(s, 0, bytes);
+
+    m_slots[id] = s;
+
+    uint32_t top;
+    while ((top = m_top) <= id) {
+      __sync_bool_compare_and_swap(&m_top, top, id + 1);
+    }
+
+    return s;
+  }
+
+  Slot* volatile m_slots[THREAD_ID_MAX];
+  volatile uint32_t m_top;  // above every id that has a slot
+  DeltaFn m_delta;
+};
+
+#endif /* end of include guard: SIZECOUNTER_H */
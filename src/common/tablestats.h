@@ -0,0 +1,61 @@
+#ifndef TABLESTATS_H
+#define TABLESTATS_H
+
+#include <cstdint>
+
+// Deepest level of a table with spines below the main array, enough for the
+// 64 bit hashes of TransMap
+#define TABLE_MAX_DEPTH 12
+
+// Occupancy of one level of the table, level 0 being the main array
+struct LevelStats {
+  uint64_t spines;     // spines at this level
+  uint64_t slots;      // slots in those spines
+  uint64_t dataNodes;  // slots holding a data node
+  uint64_t subSpines;  // slots pointing to a spine one level down
+};
+
+// Shape of a hash table. A flat table such as TransHash only has buckets,
+// TransMap fills in the spine counters and the levels too. The levels come
+// from walking the table, so like MemoryStats they are weakly consistent.
+struct TableStats {
+  uint64_t buckets;                       // slots of the top level
+  uint64_t spineAllocations;              // spines obtained from the heap
+  uint64_t spineReuses;                   // spines taken from Thread_spines
+  uint64_t spinesLinked;                  // spines that made it into the table
+  uint64_t casFailureExpansions;          // forced in by forceExpandTable
+  uint64_t collisionExpansions;           // Allocate_Spine after a collision
+  uint64_t lookupDepth[TABLE_MAX_DEPTH];  // level at which each Find ended
+  uint32_t depth;                         // levels in use below
+  LevelStats levels[TABLE_MAX_DEPTH];
+
+  TableStats& operator+=(const TableStats& rhs) {
+    spineAllocations += rhs.spineAllocations;
+    spineReuses += rhs.spineReuses;
+    spinesLinked += rhs.spinesLinked;
+    casFailureExpansions += rhs.casFailureExpansions;
+    collisionExpansions += rhs.collisionExpansions;
+    for (int i = 0; i < TABLE_MAX_DEPTH; i++) {
+      lookupDepth[i] += rhs.lookupDepth[i];
+    }
+
+    return *this;
+  }
+
+  // The counters are diffed, the buckets and levels are those of this table
+  TableStats operator-(const TableStats& rhs) const {
+    TableStats ret = *this;
+    ret.spineAllocations -= rhs.spineAllocations;
+    ret.spineReuses -= rhs.spineReuses;
+    ret.spinesLinked -= rhs.spinesLinked;
+    ret.casFailureExpansions -= rhs.casFailureExpansions;
+    ret.collisionExpansions -= rhs.collisionExpansions;
+    for (int i = 0; i < TABLE_MAX_DEPTH; i++) {
+      ret.lookupDepth[i] -= rhs.lookupDepth[i];
+    }
+
+    return ret;
+  }
+};
+
+#endif /* end of include guard: TABLESTATS_H */
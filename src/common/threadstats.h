@@ -0,0 +1,161 @@
+#ifndef THREADSTATS_H
+#define THREADSTATS_H
+
+#include <malloc.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "common/assert.h"
+
+#ifndef CACHE_LINE_SIZE
+#define CACHE_LINE_SIZE 64
+#endif
+
+// Small dense number for the calling thread, taken the first time it asks
+// and given back when it exits, so ids stay below the number of threads
+// alive at once and per-thread arrays can be indexed by them. Covers the
+// largest bench run, 254 workers plus the main and a search thread.
+#define THREAD_ID_MAX 256
+
+class ThreadId {
+ public:
+  static uint32_t Get() {
+    static thread_local ThreadId self;
+    return self.m_id;
+  }
+
+ private:
+  ThreadId() {
+    volatile uint8_t* used = Used();
+
+    for (m_id = 0; m_id < THREAD_ID_MAX; m_id++) {
+      if (used[m_id] == 0 &&
+          __sync_bool_compare_and_swap(&used[m_id], 0, 1)) {
+        return;
+      }
+    }
+
+    // Checked in release builds too: every per-thread array would be
+    // indexed out of bounds with this id
+    fprintf(stderr, "More than %d threads alive, raise THREAD_ID_MAX.\n",
+            THREAD_ID_MAX);
+    abort();
+  }
+
+  ~ThreadId() { Used()[m_id] = 0; }
+
+  static volatile uint8_t* Used() {
+    static volatile uint8_t used[THREAD_ID_MAX];
+    return used;
+  }
+
+  uint32_t m_id;
+};
+
+// Per-thread counter blocks. Each thread bumps its own cache-line aligned
+// block without atomics, and Sum() walks every registered block so totals can
+// be read at any time, also while worker threads are still running.
+//
+// Blocks are kept per instance and found by ThreadId, so a thread can move
+// between any number of instances. A thread that takes over the id of one
+// that exited carries on with its block.
+template <typename T>
+class ThreadStats {
+ public:
+  ThreadStats() : m_top(0) { memset((void*)m_blocks, 0, sizeof(m_blocks)); }
+
+  ~ThreadStats() {
+    for (uint32_t i = 0; i < m_top; i++) {
+      free(m_blocks[i]);
+    }
+  }
+
+  T& Local() {
+    uint32_t id = ThreadId::Get();
+    Block* b = m_blocks[id];
+
+    if (b == NULL) {
+      b = Register(id);
+    }
+
+    return b->stats;
+  }
+
+  T Sum() const {
+    T total;
+    memset(&total, 0, sizeof(T));
+
+    for (uint32_t i = 0; i < m_top; i++) {
+      if (m_blocks[i] != NULL) {
+        total += m_blocks[i]->stats;
+      }
+    }
+
+    return total;
+  }
+
+  void Reset() {
+    for (uint32_t i = 0; i < m_top; i++) {
+      if (m_blocks[i] != NULL) {
+        memset(&m_blocks[i]->stats, 0, sizeof(T));
+      }
+    }
+  }
+
+ private:
+  struct Block {
+    T stats;
+  };
+
+  Block* Register(uint32_t id) {
+    size_t bytes =
+        (sizeof(Block) + CACHE_LINE_SIZE - 1) & ~(CACHE_LINE_SIZE - 1);
+    Block* b = (Block*)memalign(CACHE_LINE_SIZE, bytes);
+    ASSERT(b, "Stats block allocation failed.");
+    memset(b, 0, bytes);
+
+    m_blocks[id] = b;
+
+    uint32_t top;
+    while ((top = m_top) <= id) {
+      __sync_bool_compare_and_swap(&m_top, top, id + 1);
+    }
+
+    return b;
+  }
+
+  Block* volatile m_blocks[THREAD_ID_MAX];
+  volatile uint32_t m_top;  // above every id that has a block
+};
+
+// Cost of the searches a structure performs to locate a key.
+struct TraversalStats {
+  uint64_t searches;           // calls into the locate routine
+  uint64_t visited;            // nodes stepped over, marked ones included
+  uint64_t markedSkipped;      // marked (deleted) nodes stepped over
+  uint64_t restarts;           // searches started over from the head
+  uint64_t unlinkCasFailures;  // failed CAS while unlinking marked nodes
+
+  TraversalStats& operator+=(const TraversalStats& rhs) {
+    searches += rhs.searches;
+    visited += rhs.visited;
+    markedSkipped += rhs.markedSkipped;
+    restarts += rhs.restarts;
+    unlinkCasFailures += rhs.unlinkCasFailures;
+
+    return *this;
+  }
+
+  TraversalStats operator-(const TraversalStats& rhs) const {
+    TraversalStats ret = {searches - rhs.searches, visited - rhs.visited,
+                          markedSkipped - rhs.markedSkipped,
+                          restarts - rhs.restarts,
+                          unlinkCasFailures - rhs.unlinkCasFailures};
+    return ret;
+  }
+};
+
+#endif /* end of include guard: THREADSTATS_H */
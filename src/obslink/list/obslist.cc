@@ -26,8 +26,6 @@ ObsList::ObsList(Allocator<Node>* nodeAllocator, Allocator<Desc>* descAllocator,
       m_nodeDescAllocator(nodeDescAllocator) {}
 
 ObsList::~ObsList() {
-  printf("Total commit %u, abort (total/fake) %u/%u\n", g_count_commit,
-         g_count_abort, g_count_fake_abort);
   // Print();
 
   ASSERT_CODE(printf("Total node count %u, Inserts (total/new) %u/%u, Deletes "
@@ -443,8 +441,7 @@ inline void ObsList::Print() {
   }
 }
 
-void ObsList::ResetMetrics() {
-  g_count_commit = 0;
-  g_count_abort = 0;
-  g_count_fake_abort = 0;
+Metrics ObsList::GetMetrics() const {
+  Metrics metrics = {g_count_commit, g_count_abort, g_count_fake_abort};
+  return metrics;
 }
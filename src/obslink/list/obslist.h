@@ -6,6 +6,7 @@
 
 #include "common/allocator.h"
 #include "common/assert.h"
+#include "common/metrics.h"
 
 class ObsList {
  public:
@@ -91,7 +92,7 @@ class ObsList {
 
   Desc* AllocateDesc(uint8_t size);
 
-  void ResetMetrics();
+  Metrics GetMetrics() const;
 
  private:
   ReturnCode Insert(uint32_t key, Desc* desc, uint8_t opid, Node*& inserted,
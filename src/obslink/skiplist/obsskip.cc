@@ -844,14 +844,14 @@ void transskip_print(obs_skip* l) {
 }
 
 void obsskip_free(obs_skip* l) {
-  printf("Total commit %u, abort (total/fake) %u/%u\n", g_count_commit,
-         g_count_abort, g_count_fake_abort);
-
   // transskip_print(l);
 }
 
-void ResetMetrics(obs_skip* l) {
-  g_count_commit = 0;
-  g_count_abort = 0;
-  g_count_fake_abort = 0;
+Metrics GetMetrics(obs_skip* l) {
+  Metrics metrics = {g_count_commit, g_count_abort, g_count_fake_abort};
+
+  metrics.parts = METRICS_GC;
+  fr_gc_get_stats(&metrics.gc);
+
+  return metrics;
 }
@@ -5,6 +5,7 @@
 
 #include "common/allocator.h"
 #include "common/assert.h"
+#include "common/metrics.h"
 
 typedef unsigned long setkey_t;
 typedef void* setval_t;
@@ -128,6 +129,6 @@ obs_skip* obsskip_alloc(Allocator<Desc_o>* _descAllocator,
 
 void obsskip_free(obs_skip* l);
 
-void ResetMetrics(obs_skip* l);
+Metrics GetMetrics(obs_skip* l);
 
 #endif /* __SET_H__ */
@@ -265,13 +265,14 @@ void destory_stmskip_subsystem(void) {
   free_stm(ptst, MEMORY);
 
   fr_critical_exit(ptst);
-
-  printf("Total commit %u, abort (total/fake) %u/%u\n", g_count_commit,
-         g_count_abort, g_count_abort - g_count_real_abort);
 }
 
-void ResetMetrics() {
-  g_count_commit = 0;
-  g_count_abort = 0;
-  g_count_real_abort = 0;
+Metrics GetMetrics() {
+  Metrics metrics = {g_count_commit, g_count_abort,
+                     g_count_abort - g_count_real_abort};
+
+  metrics.parts = METRICS_GC;
+  fr_gc_get_stats(&metrics.gc);
+
+  return metrics;
 }
\ No newline at end of file
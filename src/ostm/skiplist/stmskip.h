@@ -3,6 +3,8 @@
 
 #include <stdint.h>
 
+#include "common/metrics.h"
+
 typedef unsigned long setkey_t;
 typedef void *setval_t;
 
@@ -82,7 +84,7 @@ stm_skip *stmskip_alloc(void);
 
 bool stmskip_execute_ops(stm_skip *l, set_op ops[], int op_size);
 
-void ResetMetrics();
+Metrics GetMetrics();
 
 #endif /* __SET_IMPLEMENTATION__ */
 
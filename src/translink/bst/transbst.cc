@@ -0,0 +1,244 @@
+//------------------------------------------------------------------------------
+//
+//
+//
+//------------------------------------------------------------------------------
+
+#include "translink/bst/transbst.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+TransBST::TransBST(Allocator<Node>* nodeAllocator,
+                   Allocator<Desc>* descAllocator,
+                   Allocator<NodeDesc>* nodeDescAllocator)
+    : m_sentinel(new Node(0xffffffff, NULL)),
+      m_root(new Node(0xffffffff, m_sentinel, NULL)),
+      m_nodeAllocator(nodeAllocator),
+      m_descAllocator(descAllocator),
+      m_nodeDescAllocator(nodeDescAllocator) {}
+
+TransBST::~TransBST() {}
+
+TransBST::Desc* TransBST::AllocateDesc(uint32_t size) {
+  Desc* desc = m_descAllocator->Alloc();
+  desc->size = size;
+  desc->status = ACTIVE;
+
+  return desc;
+}
+
+bool TransBST::ExecuteOps(Desc* desc) { return ExecuteDesc(desc); }
+
+inline TransBST::ReturnCode TransBST::RunOp(Desc* desc, uint32_t opid) {
+  const Operator& op = desc->ops[opid];
+
+  if (op.type == INSERT) {
+    return Insert(op.key, desc, opid);
+  } else if (op.type == DELETE) {
+    return Delete(op.key, desc, opid);
+  } else {
+    return Find(op.key, desc, opid);
+  }
+}
+
+inline TransBST::ReturnCode TransBST::Insert(uint32_t key, Desc* desc,
+                                             uint32_t opid) {
+  NodeDesc* nodeDesc = new (m_nodeDescAllocator->Alloc()) NodeDesc(desc, opid);
+  Node* new_leaf = NULL;
+  Node* new_internal = NULL;
+  Node* parent = m_root;
+  Node* leaf;
+
+  while (true) {
+    LocateLeaf(parent, leaf, key);
+
+    if (leaf->key != key) {
+      if (desc->status != ACTIVE) {
+        return FAIL;
+      }
+
+      if (new_leaf == NULL) {
+        new_leaf = new (m_nodeAllocator->Alloc()) Node(key, nodeDesc);
+        new_internal = m_nodeAllocator->Alloc();
+      }
+
+      // The larger key routes, the smaller one goes left
+      if (key < leaf->key) {
+        new (new_internal) Node(leaf->key, new_leaf, leaf);
+      } else {
+        new (new_internal) Node(key, leaf, new_leaf);
+      }
+
+      Node** child = key < parent->key ? &parent->left : &parent->right;
+
+      if (__sync_bool_compare_and_swap(child, leaf, new_internal)) {
+        return OK;
+      }
+
+      // Someone grew the tree under parent first, nothing is ever unlinked
+      // so the search can go on from there
+      m_traversal.Local().restarts++;
+    } else {
+      NodeDesc* oldCurrDesc = leaf->nodeDesc;
+
+      FinishPendingTxn(oldCurrDesc, desc);
+
+      if (IsSameOperation(oldCurrDesc, nodeDesc)) {
+        return SKIP;
+      }
+
+      if (!IsKeyExist(oldCurrDesc)) {
+        if (desc->status != ACTIVE) {
+          return FAIL;
+        }
+
+        if (__sync_bool_compare_and_swap(&leaf->nodeDesc, oldCurrDesc,
+                                         nodeDesc)) {
+          return OK;
+        }
+      } else {
+        return FAIL;
+      }
+    }
+  }
+}
+
+inline TransBST::ReturnCode TransBST::Delete(uint32_t key, Desc* desc,
+                                             uint32_t opid) {
+  NodeDesc* nodeDesc = new (m_nodeDescAllocator->Alloc()) NodeDesc(desc, opid);
+  Node* parent = m_root;
+  Node* leaf;
+
+  LocateLeaf(parent, leaf, key);
+
+  if (leaf->key != key) {
+    return FAIL;
+  }
+
+  while (true) {
+    NodeDesc* oldCurrDesc = leaf->nodeDesc;
+
+    FinishPendingTxn(oldCurrDesc, desc);
+
+    if (IsSameOperation(oldCurrDesc, nodeDesc)) {
+      return SKIP;
+    }
+
+    if (IsKeyExist(oldCurrDesc)) {
+      if (desc->status != ACTIVE) {
+        return FAIL;
+      }
+
+      if (__sync_bool_compare_and_swap(&leaf->nodeDesc, oldCurrDesc,
+                                       nodeDesc)) {
+        return OK;
+      }
+    } else {
+      return FAIL;
+    }
+  }
+}
+
+inline TransBST::ReturnCode TransBST::Find(uint32_t key, Desc* desc,
+                                           uint32_t opid) {
+  NodeDesc* nodeDesc = NULL;
+  Node* parent = m_root;
+  Node* leaf;
+
+  LocateLeaf(parent, leaf, key);
+
+  if (leaf->key != key) {
+    return FAIL;
+  }
+
+  while (true) {
+    NodeDesc* oldCurrDesc = leaf->nodeDesc;
+
+    FinishPendingTxn(oldCurrDesc, desc);
+
+    if (nodeDesc == NULL)
+      nodeDesc = new (m_nodeDescAllocator->Alloc()) NodeDesc(desc, opid);
+
+    if (IsSameOperation(oldCurrDesc, nodeDesc)) {
+      return SKIP;
+    }
+
+    if (IsKeyExist(oldCurrDesc)) {
+      if (desc->status != ACTIVE) {
+        return FAIL;
+      }
+
+      if (__sync_bool_compare_and_swap(&leaf->nodeDesc, oldCurrDesc,
+                                       nodeDesc)) {
+        return OK;
+      }
+    } else {
+      return FAIL;
+    }
+  }
+}
+
+// Walks down from parent, which must be an internal node on the search path
+// of key, and leaves parent pointing at the leaf's parent
+inline void TransBST::LocateLeaf(Node*& parent, Node*& leaf, uint32_t key) {
+  Node* curr = parent;
+  uint64_t visited = 0;
+
+  do {
+    parent = curr;
+    curr = key < curr->key ? curr->left : curr->right;
+    visited++;
+  } while (!curr->IsLeaf());
+
+  leaf = curr;
+
+  TraversalStats& stats = m_traversal.Local();
+  stats.searches++;
+  stats.visited += visited;
+}
+
+MemoryStats TransBST::GetMemoryStats() {
+  MemoryStats stats = {};
+  std::vector<Node*> pending(1, m_root);
+
+  while (!pending.empty()) {
+    Node* curr = pending.back();
+    pending.pop_back();
+
+    if (!curr->IsLeaf()) {
+      pending.push_back(curr->left);
+      if (curr->right != NULL) {
+        pending.push_back(curr->right);
+      }
+    } else if (curr != m_sentinel) {
+      if (IsKeyExist(curr->nodeDesc)) {
+        stats.liveNodes++;
+      } else {
+        stats.deletedNodes++;
+      }
+    }
+  }
+
+  stats.descriptors = m_descAllocator->Allocated();
+
+  // The root and sentinel come from the heap, everything else from the pools
+  stats.AddHeap(2 * sizeof(Node));
+  stats.AddPool(m_nodeAllocator);
+  stats.AddPool(m_descAllocator);
+  stats.AddPool(m_nodeDescAllocator);
+
+  return stats;
+}
+
+Metrics TransBST::GetMetrics() {
+  Metrics metrics = {g_count_commit, g_count_abort, g_count_fake_abort};
+
+  metrics.parts = METRICS_TRAVERSAL | METRICS_MEMORY;
+  metrics.traversal = m_traversal.Sum();
+  metrics.memory = GetMemoryStats();
+
+  return metrics;
+}
@@ -0,0 +1,87 @@
+#ifndef TRANSBST_H
+#define TRANSBST_H
+
+#include <cstdint>
+
+#include "common/allocator.h"
+#include "common/assert.h"
+#include "common/memstats.h"
+#include "common/metrics.h"
+#include "common/threadstats.h"
+#include "translink/transbase.h"
+
+// Transactional external binary search tree. Keys live in the leaves and
+// internal nodes only route: keys smaller than an internal node's key are on
+// its left, the others on its right. Like the other translink structures,
+// nodes are never removed, a delete only changes the logical status of a
+// leaf through its NodeDesc, so the tree grows by a single CAS that swaps a
+// leaf for an internal node holding the old leaf and the new one. That is
+// the insert of Ellen et al. with the flagging and marking for removal left
+// out, as nothing is ever unlinked.
+class TransBST : public TransBase<TransBST> {
+ public:
+  struct Operator {
+    uint8_t type;
+    uint32_t key;
+  };
+
+  typedef TransDesc<Operator> Desc;
+  typedef TransNodeDesc<Desc> NodeDesc;
+
+  struct Node {
+    Node() : key(0), nodeDesc(NULL), left(NULL), right(NULL) {}
+    // Leaf
+    Node(uint32_t _key, NodeDesc* _nodeDesc)
+        : key(_key), nodeDesc(_nodeDesc), left(NULL), right(NULL) {}
+    // Internal node
+    Node(uint32_t _key, Node* _left, Node* _right)
+        : key(_key), nodeDesc(NULL), left(_left), right(_right) {}
+
+    bool IsLeaf() const { return left == NULL; }
+
+    uint32_t key;
+    NodeDesc* nodeDesc;  // leaves only
+
+    Node* left;
+    Node* right;
+  };
+
+  TransBST(Allocator<Node>* nodeAllocator, Allocator<Desc>* descAllocator,
+           Allocator<NodeDesc>* nodeDescAllocator);
+  ~TransBST();
+
+  bool ExecuteOps(Desc* desc);
+
+  Desc* AllocateDesc(uint32_t size);
+
+  Metrics GetMetrics();
+
+  TraversalStats GetTraversalStats() const { return m_traversal.Sum(); }
+
+  MemoryStats GetMemoryStats();
+
+ private:
+  friend class TransBase<TransBST>;
+
+  ReturnCode RunOp(Desc* desc, uint32_t opid);
+  ReturnCode Insert(uint32_t key, Desc* desc, uint32_t opid);
+  ReturnCode Delete(uint32_t key, Desc* desc, uint32_t opid);
+  ReturnCode Find(uint32_t key, Desc* desc, uint32_t opid);
+
+  void LocateLeaf(Node*& parent, Node*& leaf, uint32_t key);
+
+ private:
+  // The root routes every key left, to a sentinel leaf at first. Like the
+  // TransList tail, the sentinel's key 0xffffffff is larger than any user key
+  // and it carries no NodeDesc
+  Node* m_sentinel;
+  Node* m_root;
+
+  Allocator<Node>* m_nodeAllocator;
+  Allocator<Desc>* m_descAllocator;
+  Allocator<NodeDesc>* m_nodeDescAllocator;
+
+  ThreadStats<TraversalStats> m_traversal;
+};
+
+#endif /* end of include guard: TRANSBST_H */
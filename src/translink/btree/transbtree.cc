@@ -0,0 +1,547 @@
+//------------------------------------------------------------------------------
+//
+//
+//
+//------------------------------------------------------------------------------
+
+#include "translink/btree/transbtree.h"
+
+#include <malloc.h>
+#include <sched.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+static_assert(sizeof(TransBTree::Leaf) == TransBTree::NODE_SIZE,
+              "leaf must fill its cache lines exactly");
+static_assert(sizeof(TransBTree::Inner) == TransBTree::NODE_SIZE,
+              "inner node must fill its cache lines exactly");
+
+// Optimistic lock coupling on the node version. An odd version means a
+// writer holds the node, every unlock moves it to the next even value.
+static inline uint64_t ReadLock(TransBTree::Node* node, bool& restart) {
+  uint64_t version = __atomic_load_n(&node->version, __ATOMIC_ACQUIRE);
+
+  if (version & 1) {
+    restart = true;
+  }
+
+  return version;
+}
+
+static inline bool Validate(TransBTree::Node* node, uint64_t version) {
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+  return node->version == version;
+}
+
+static inline bool UpgradeToWriteLock(TransBTree::Node* node,
+                                      uint64_t version) {
+  return __sync_bool_compare_and_swap(&node->version, version, version + 1);
+}
+
+static inline void WriteUnlock(TransBTree::Node* node) {
+  __sync_fetch_and_add(&node->version, 1);
+}
+
+// A restart usually means a writer holds a node for a few stores, but a
+// preempted writer holds it for a whole time slice
+static inline void Backoff(uint32_t attempt) {
+  if (attempt < 16) {
+    __builtin_ia32_pause();
+  } else {
+    sched_yield();
+  }
+}
+
+// Readers may see a count a writer is changing, keep them inside the node
+static inline uint32_t Count(TransBTree::Node* node, uint32_t slots) {
+  uint32_t count = __atomic_load_n(&node->count, __ATOMIC_ACQUIRE);
+
+  return count < slots ? count : slots;
+}
+
+static inline void SetCount(TransBTree::Node* node, uint32_t count) {
+  __atomic_store_n(&node->count, count, __ATOMIC_RELEASE);
+}
+
+// Index of the child whose keys include key: the number of separators not
+// above it
+static inline uint32_t ChildIndex(TransBTree::Inner* inner, uint32_t count,
+                                  uint32_t key) {
+  uint32_t i = 0;
+
+  while (i < count && inner->keys[i] <= key) {
+    i++;
+  }
+
+  return i;
+}
+
+// Index of the first key in the leaf not below key
+static inline uint32_t KeyIndex(TransBTree::Leaf* leaf, uint32_t count,
+                                uint32_t key) {
+  uint32_t i = 0;
+
+  while (i < count && leaf->keys[i] < key) {
+    i++;
+  }
+
+  return i;
+}
+
+TransBTree::TransBTree(Allocator<Leaf>* nodeAllocator,
+                       Allocator<Entry>* entryAllocator,
+                       Allocator<Desc>* descAllocator,
+                       Allocator<NodeDesc>* nodeDescAllocator)
+    : m_nodeAllocator(nodeAllocator),
+      m_entryAllocator(entryAllocator),
+      m_descAllocator(descAllocator),
+      m_nodeDescAllocator(nodeDescAllocator) {
+  // The pools are only usable once a thread called Init on them
+  Leaf* root = static_cast<Leaf*>(memalign(NODE_SIZE, sizeof(Leaf)));
+  root->version = 0;
+  root->count = 0;
+  root->isLeaf = true;
+
+  m_root = root;
+}
+
+TransBTree::~TransBTree() {}
+
+TransBTree::Desc* TransBTree::AllocateDesc(uint32_t size) {
+  Desc* desc = m_descAllocator->Alloc();
+  desc->size = size;
+  desc->status = ACTIVE;
+
+  return desc;
+}
+
+bool TransBTree::ExecuteOps(Desc* desc) { return ExecuteDesc(desc); }
+
+inline TransBTree::ReturnCode TransBTree::RunOp(Desc* desc, uint32_t opid) {
+  const Operator& op = desc->ops[opid];
+
+  if (op.type == INSERT) {
+    return Insert(op.key, desc, opid);
+  } else {
+    return Claim(op.key, desc, opid);
+  }
+}
+
+inline TransBTree::ReturnCode TransBTree::Insert(uint32_t key, Desc* desc,
+                                                 uint32_t opid) {
+  NodeDesc* nodeDesc =
+      new (m_nodeDescAllocator->Alloc()) NodeDesc(desc, opid, 0);
+  bool created;
+
+  if (desc->status != ACTIVE) {
+    return FAIL;
+  }
+
+  Entry* entry = InsertEntry(key, nodeDesc, created);
+
+  if (created) {
+    return OK;
+  }
+
+  while (true) {
+    NodeDesc* oldCurrDesc = entry->nodeDesc;
+
+    FinishPendingTxn(oldCurrDesc, desc);
+
+    if (IsSameOperation(oldCurrDesc, nodeDesc)) {
+      return SKIP;
+    }
+
+    if (!IsKeyExist(oldCurrDesc)) {
+      if (desc->status != ACTIVE) {
+        return FAIL;
+      }
+
+      if (__sync_bool_compare_and_swap(&entry->nodeDesc, oldCurrDesc,
+                                       nodeDesc)) {
+        return OK;
+      }
+    } else {
+      return FAIL;
+    }
+  }
+}
+
+// DELETE, FIND and UPDATE all need the key present and take its entry over.
+// They only differ in what IsKeyExist and CurrentValue make of them later,
+// and in FIND copying the value it saw into its operation.
+inline TransBTree::ReturnCode TransBTree::Claim(uint32_t key, Desc* desc,
+                                                uint32_t opid) {
+  Entry* entry = LookupEntry(key);
+
+  if (entry == NULL) {
+    return FAIL;
+  }
+
+  NodeDesc* nodeDesc =
+      new (m_nodeDescAllocator->Alloc()) NodeDesc(desc, opid, 0);
+
+  while (true) {
+    NodeDesc* oldCurrDesc = entry->nodeDesc;
+
+    FinishPendingTxn(oldCurrDesc, desc);
+
+    if (IsSameOperation(oldCurrDesc, nodeDesc)) {
+      if (desc->ops[opid].type == FIND) {
+        desc->ops[opid].value = oldCurrDesc->value;
+      }
+
+      return SKIP;
+    }
+
+    if (IsKeyExist(oldCurrDesc)) {
+      if (desc->status != ACTIVE) {
+        return FAIL;
+      }
+
+      nodeDesc->value = CurrentValue(oldCurrDesc);
+
+      if (__sync_bool_compare_and_swap(&entry->nodeDesc, oldCurrDesc,
+                                       nodeDesc)) {
+        if (desc->ops[opid].type == FIND) {
+          desc->ops[opid].value = nodeDesc->value;
+        }
+
+        return OK;
+      }
+    } else {
+      return FAIL;
+    }
+  }
+}
+
+inline TransBTree::Entry* TransBTree::LookupEntry(uint32_t key) {
+  Entry* entry;
+  uint32_t attempt = 0;
+
+  m_traversal.Local().searches++;
+
+  while (!TryLookup(key, entry)) {
+    m_traversal.Local().restarts++;
+    Backoff(attempt++);
+  }
+
+  return entry;
+}
+
+inline TransBTree::Entry* TransBTree::InsertEntry(uint32_t key,
+                                                  NodeDesc* nodeDesc,
+                                                  bool& created) {
+  Entry* entry;
+  uint32_t attempt = 0;
+
+  m_traversal.Local().searches++;
+
+  while (!TryInsert(key, nodeDesc, entry, created)) {
+    m_traversal.Local().restarts++;
+    Backoff(attempt++);
+  }
+
+  return entry;
+}
+
+// One optimistic descent, false if a writer got in the way. Each child's
+// version is read before its parent is validated, so a split that moved the
+// key out of the child is caught on one of the two.
+inline bool TransBTree::TryLookup(uint32_t key, Entry*& entry) {
+  bool restart = false;
+  Node* node = m_root;
+  uint64_t version = ReadLock(node, restart);
+  uint64_t visited = 1;
+
+  if (restart || node != m_root) {
+    return false;
+  }
+
+  while (!node->isLeaf) {
+    Inner* inner = static_cast<Inner*>(node);
+    Node* child =
+        inner->children[ChildIndex(inner, Count(inner, INNER_SLOTS), key)];
+
+    if (!Validate(node, version)) {
+      return false;
+    }
+
+    uint64_t childVersion = ReadLock(child, restart);
+
+    if (restart || !Validate(node, version)) {
+      return false;
+    }
+
+    node = child;
+    version = childVersion;
+    visited++;
+  }
+
+  Leaf* leaf = static_cast<Leaf*>(node);
+  uint32_t count = Count(leaf, LEAF_SLOTS);
+  uint32_t i = KeyIndex(leaf, count, key);
+  Entry* found = i < count && leaf->keys[i] == key ? leaf->entries[i] : NULL;
+
+  m_traversal.Local().visited += visited;
+
+  if (!Validate(leaf, version)) {
+    return false;
+  }
+
+  entry = found;
+  return true;
+}
+
+// Like TryLookup, but a full node on the way is split before going on, so
+// the parent of a split always has room for the new separator
+inline bool TransBTree::TryInsert(uint32_t key, NodeDesc* nodeDesc,
+                                  Entry*& entry, bool& created) {
+  bool restart = false;
+  Node* node = m_root;
+  uint64_t version = ReadLock(node, restart);
+  Inner* parent = NULL;
+  uint64_t parentVersion = 0;
+  uint64_t visited = 1;
+
+  if (restart || node != m_root) {
+    return false;
+  }
+
+  while (true) {
+    uint32_t slots = node->isLeaf ? LEAF_SLOTS : INNER_SLOTS;
+
+    if (Count(node, slots) == slots) {
+      Split(parent, parentVersion, node, version);
+      return false;
+    }
+
+    if (parent != NULL && !Validate(parent, parentVersion)) {
+      return false;
+    }
+
+    if (node->isLeaf) {
+      break;
+    }
+
+    Inner* inner = static_cast<Inner*>(node);
+    Node* child =
+        inner->children[ChildIndex(inner, Count(inner, INNER_SLOTS), key)];
+
+    if (!Validate(node, version)) {
+      return false;
+    }
+
+    uint64_t childVersion = ReadLock(child, restart);
+
+    if (restart) {
+      return false;
+    }
+
+    parent = inner;
+    parentVersion = version;
+    node = child;
+    version = childVersion;
+    visited++;
+  }
+
+  m_traversal.Local().visited += visited;
+
+  Leaf* leaf = static_cast<Leaf*>(node);
+  uint32_t count = Count(leaf, LEAF_SLOTS);
+  uint32_t i = KeyIndex(leaf, count, key);
+
+  if (i < count && leaf->keys[i] == key) {
+    Entry* found = leaf->entries[i];
+
+    if (!Validate(leaf, version)) {
+      return false;
+    }
+
+    entry = found;
+    created = false;
+    return true;
+  }
+
+  if (!UpgradeToWriteLock(leaf, version)) {
+    return false;
+  }
+
+  Entry* newEntry = m_entryAllocator->Alloc();
+  newEntry->nodeDesc = nodeDesc;
+
+  memmove(&leaf->keys[i + 1], &leaf->keys[i], (count - i) * sizeof(uint32_t));
+  memmove(&leaf->entries[i + 1], &leaf->entries[i],
+          (count - i) * sizeof(Entry*));
+  leaf->keys[i] = key;
+  leaf->entries[i] = newEntry;
+  SetCount(leaf, count + 1);
+
+  WriteUnlock(leaf);
+
+  entry = newEntry;
+  created = true;
+  return true;
+}
+
+// Moves the upper half of a full node to a new right sibling and hands the
+// separator to the parent, or to a new root. Gives up quietly when either
+// node changed since it was read, the caller restarts anyway.
+inline void TransBTree::Split(Inner* parent, uint64_t parentVersion,
+                              Node* node, uint64_t version) {
+  if (parent != NULL && !UpgradeToWriteLock(parent, parentVersion)) {
+    return;
+  }
+
+  if (!UpgradeToWriteLock(node, version)) {
+    if (parent != NULL) {
+      WriteUnlock(parent);
+    }
+
+    return;
+  }
+
+  if (parent == NULL && node != m_root) {
+    WriteUnlock(node);
+    return;
+  }
+
+  uint32_t count = node->count;
+  uint32_t half = count / 2;
+  uint32_t separator;
+  Node* sibling;
+
+  if (node->isLeaf) {
+    Leaf* leaf = static_cast<Leaf*>(node);
+    Leaf* right = AllocateLeaf();
+
+    memcpy(right->keys, &leaf->keys[half], (count - half) * sizeof(uint32_t));
+    memcpy(right->entries, &leaf->entries[half],
+           (count - half) * sizeof(Entry*));
+    right->count = count - half;
+
+    separator = right->keys[0];
+    sibling = right;
+  } else {
+    Inner* inner = static_cast<Inner*>(node);
+    Inner* right = AllocateInner();
+
+    // The middle key moves up, the children on both of its sides stay
+    memcpy(right->keys, &inner->keys[half + 1],
+           (count - half - 1) * sizeof(uint32_t));
+    memcpy(right->children, &inner->children[half + 1],
+           (count - half) * sizeof(Node*));
+    right->count = count - half - 1;
+
+    separator = inner->keys[half];
+    sibling = right;
+  }
+
+  SetCount(node, half);
+
+  if (parent == NULL) {
+    Inner* root = AllocateInner();
+    root->keys[0] = separator;
+    root->children[0] = node;
+    root->children[1] = sibling;
+    root->count = 1;
+
+    __atomic_store_n(&m_root, root, __ATOMIC_RELEASE);
+  } else {
+    uint32_t parentCount = parent->count;
+    uint32_t i = ChildIndex(parent, parentCount, separator);
+
+    memmove(&parent->keys[i + 1], &parent->keys[i],
+            (parentCount - i) * sizeof(uint32_t));
+    memmove(&parent->children[i + 2], &parent->children[i + 1],
+            (parentCount - i) * sizeof(Node*));
+    parent->keys[i] = separator;
+    parent->children[i + 1] = sibling;
+    SetCount(parent, parentCount + 1);
+  }
+
+  WriteUnlock(node);
+
+  if (parent != NULL) {
+    WriteUnlock(parent);
+  }
+}
+
+inline TransBTree::Leaf* TransBTree::AllocateLeaf() {
+  Leaf* leaf = m_nodeAllocator->Alloc();
+  leaf->version = 0;
+  leaf->count = 0;
+  leaf->isLeaf = true;
+
+  return leaf;
+}
+
+inline TransBTree::Inner* TransBTree::AllocateInner() {
+  Inner* inner = reinterpret_cast<Inner*>(m_nodeAllocator->Alloc());
+  inner->version = 0;
+  inner->count = 0;
+  inner->isLeaf = false;
+
+  return inner;
+}
+
+inline uint32_t TransBTree::CurrentValue(NodeDesc* nodeDesc) {
+  const Operator& op = nodeDesc->desc->ops[nodeDesc->opid];
+
+  if ((op.type == INSERT || op.type == UPDATE) && IsNodeActive(nodeDesc)) {
+    return op.value;
+  }
+
+  return nodeDesc->value;
+}
+
+void TransBTree::CollectStats(Node* node, MemoryStats& stats) {
+  if (node->isLeaf) {
+    Leaf* leaf = static_cast<Leaf*>(node);
+
+    for (uint32_t i = 0; i < leaf->count; i++) {
+      if (IsKeyExist(leaf->entries[i]->nodeDesc)) {
+        stats.liveNodes++;
+      } else {
+        stats.deletedNodes++;
+      }
+    }
+  } else {
+    Inner* inner = static_cast<Inner*>(node);
+
+    for (uint32_t i = 0; i <= inner->count; i++) {
+      CollectStats(inner->children[i], stats);
+    }
+  }
+}
+
+MemoryStats TransBTree::GetMemoryStats() {
+  MemoryStats stats = {};
+
+  CollectStats(m_root, stats);
+
+  stats.descriptors = m_descAllocator->Allocated();
+
+  // The first leaf comes from the heap, everything else from the pools
+  stats.AddHeap(sizeof(Leaf));
+  stats.AddPool(m_nodeAllocator);
+  stats.AddPool(m_entryAllocator);
+  stats.AddPool(m_descAllocator);
+  stats.AddPool(m_nodeDescAllocator);
+
+  return stats;
+}
+
+Metrics TransBTree::GetMetrics() {
+  Metrics metrics = {g_count_commit, g_count_abort, g_count_fake_abort};
+
+  metrics.parts = METRICS_TRAVERSAL | METRICS_MEMORY;
+  metrics.traversal = m_traversal.Sum();
+  metrics.memory = GetMemoryStats();
+
+  return metrics;
+}
@@ -0,0 +1,125 @@
+#ifndef TRANSBTREE_H
+#define TRANSBTREE_H
+
+#include <cstdint>
+
+#include "common/allocator.h"
+#include "common/assert.h"
+#include "common/memstats.h"
+#include "common/metrics.h"
+#include "common/threadstats.h"
+#include "translink/transbase.h"
+
+// Transactional B+-tree with wide, cache line aligned nodes. Keys sit sorted
+// and contiguous in the nodes, so a lookup reads a couple of lines per level
+// instead of chasing a pointer per key. The logical state of a key lives in
+// an Entry its leaf points to, and transactions change it with the usual
+// NodeDesc CAS. Entries never move, so that CAS stays valid while the leaf
+// around it is split.
+//
+// The shape of the tree is kept with optimistic lock coupling (Leis et al.):
+// every structural change bumps the version of the nodes it touches, readers
+// validate versions instead of locking, and only the insert of a new key
+// locks its leaf, plus the parent on a split, for a few stores. No lock is
+// held while helping another transaction. Like the other translink
+// structures, keys are never removed, a delete only changes the logical
+// status of the entry.
+//
+// Used as a set or as a map. The value of a key is the one its last
+// committed INSERT or UPDATE wrote, each NodeDesc keeps the value from before
+// its operation so that an aborted UPDATE leaves the old one in place.
+class TransBTree : public TransBase<TransBTree> {
+ public:
+  struct Operator {
+    uint8_t type;
+    uint32_t key;
+    uint32_t value;
+  };
+
+  typedef TransDesc<Operator> Desc;
+
+  struct NodeDesc : TransNodeDesc<Desc> {
+    NodeDesc(Desc* _desc, uint32_t _opid, uint32_t _value)
+        : TransNodeDesc<Desc>(_desc, _opid), value(_value) {}
+
+    uint32_t value;  // value of the key before this operation
+  };
+
+  struct Entry {
+    NodeDesc* nodeDesc;
+  };
+
+  // Node layout: a version word whose low bit is the write lock, the number
+  // of keys, then the sorted keys followed by the entries or children
+  static const uint32_t NODE_SIZE = 4 * CACHE_LINE_SIZE;
+  static const uint32_t HEADER_SIZE = 16;
+  static const uint32_t LEAF_SLOTS =
+      (NODE_SIZE - HEADER_SIZE) / (sizeof(uint32_t) + sizeof(Entry*));
+  static const uint32_t INNER_SLOTS =
+      (NODE_SIZE - HEADER_SIZE - sizeof(void*)) /
+      (sizeof(uint32_t) + sizeof(void*));
+
+  struct Node {
+    volatile uint64_t version;
+    uint16_t count;
+    bool isLeaf;
+  };
+
+  struct Leaf : Node {
+    uint32_t keys[LEAF_SLOTS];
+    Entry* entries[LEAF_SLOTS];
+  } __attribute__((aligned(CACHE_LINE_SIZE)));
+
+  // children[i] holds the keys below keys[i], the last child the rest
+  struct Inner : Node {
+    uint32_t keys[INNER_SLOTS];
+    Node* children[INNER_SLOTS + 1];
+  } __attribute__((aligned(CACHE_LINE_SIZE)));
+
+  TransBTree(Allocator<Leaf>* nodeAllocator, Allocator<Entry>* entryAllocator,
+             Allocator<Desc>* descAllocator,
+             Allocator<NodeDesc>* nodeDescAllocator);
+  ~TransBTree();
+
+  bool ExecuteOps(Desc* desc);
+
+  Desc* AllocateDesc(uint32_t size);
+
+  Metrics GetMetrics();
+
+  TraversalStats GetTraversalStats() const { return m_traversal.Sum(); }
+
+  MemoryStats GetMemoryStats();
+
+ private:
+  friend class TransBase<TransBTree>;
+
+  ReturnCode RunOp(Desc* desc, uint32_t opid);
+  ReturnCode Insert(uint32_t key, Desc* desc, uint32_t opid);
+  ReturnCode Claim(uint32_t key, Desc* desc, uint32_t opid);
+
+  uint32_t CurrentValue(NodeDesc* nodeDesc);
+
+  Entry* LookupEntry(uint32_t key);
+  Entry* InsertEntry(uint32_t key, NodeDesc* nodeDesc, bool& created);
+  bool TryLookup(uint32_t key, Entry*& entry);
+  bool TryInsert(uint32_t key, NodeDesc* nodeDesc, Entry*& entry,
+                 bool& created);
+  void Split(Inner* parent, uint64_t parentVersion, Node* node,
+             uint64_t version);
+  Leaf* AllocateLeaf();
+  Inner* AllocateInner();
+  void CollectStats(Node* node, MemoryStats& stats);
+
+ private:
+  Node* volatile m_root;
+
+  Allocator<Leaf>* m_nodeAllocator;
+  Allocator<Entry>* m_entryAllocator;
+  Allocator<Desc>* m_descAllocator;
+  Allocator<NodeDesc>* m_nodeDescAllocator;
+
+  ThreadStats<TraversalStats> m_traversal;
+};
+
+#endif /* end of include guard: TRANSBTREE_H */
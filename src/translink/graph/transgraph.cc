@@ -0,0 +1,220 @@
+//------------------------------------------------------------------------------
+//
+//
+//
+//------------------------------------------------------------------------------
+
+#include "translink/graph/transgraph.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+thread_local HelpStack<TransMap::Desc> graphHelpStack;
+
+TransGraph::TransGraph(Allocator<Desc>* descAllocator,
+                       Allocator<NodeDesc>* nodeDescAllocator,
+                       uint32_t vertexCount, uint64_t numThreads)
+    : m_descAllocator(descAllocator),
+      m_nodeDescAllocator(nodeDescAllocator),
+      m_vertices(descAllocator, nodeDescAllocator, vertexCount, numThreads),
+      m_edges(vertexCount) {
+  m_vertices.SetOwner(this, Help);
+
+  for (uint32_t i = 0; i < vertexCount; i++) {
+    m_edges[i] = new TransMap(descAllocator, nodeDescAllocator,
+                              EDGE_TABLE_SIZE, numThreads);
+    m_edges[i]->SetOwner(this, Help);
+  }
+}
+
+TransGraph::~TransGraph() {
+  for (uint32_t i = 0; i < m_edges.size(); i++) {
+    delete m_edges[i];
+  }
+}
+
+TransGraph::Desc* TransGraph::AllocateDesc(uint32_t size) {
+  Desc* desc = m_descAllocator->Alloc();
+  desc->size = size;
+  desc->status = TransMap::MAP_ACTIVE;
+
+  return desc;
+}
+
+bool TransGraph::ExecuteOps(Desc* desc, int threadId) {
+  graphHelpStack.Init();
+
+  CountSizes(desc, true);
+
+  HelpOps(desc, 0, threadId);
+
+  CountSizes(desc, false);
+
+  return desc->status != TransMap::MAP_ABORTED;
+}
+
+// Begins or ends the share of desc on the size counter of each map it has ops
+// on, once per map
+void TransGraph::CountSizes(Desc* desc, bool begin) {
+  const uint32_t* targets = Targets(desc);
+
+  for (uint32_t i = 0; i < desc->size; i++) {
+    uint32_t target = targets[i];
+    uint32_t first = 0;
+    TransMap* map = MapOf(target);
+
+    while (targets[first] != target) {
+      first++;
+    }
+
+    if (first < i || map == NULL) {
+      continue;
+    }
+
+    if (begin) {
+      map->GetSizeCounter().Begin(desc, target);
+    } else {
+      map->GetSizeCounter().End();
+    }
+  }
+}
+
+void TransGraph::Help(void* graph, Desc* desc, uint32_t opid, int threadId) {
+  static_cast<TransGraph*>(graph)->HelpOps(desc, opid, threadId);
+}
+
+inline void TransGraph::HelpOps(Desc* desc, uint32_t opid, int threadId) {
+  if (desc->status != TransMap::MAP_ACTIVE) {
+    return;
+  }
+
+  // Cyclic dependcy check
+  if (graphHelpStack.Contain(desc)) {
+    if (__sync_bool_compare_and_swap(&desc->status, TransMap::MAP_ACTIVE,
+                                     TransMap::MAP_ABORTED)) {
+      __sync_fetch_and_add(&g_count_abort, 1);
+      __sync_fetch_and_add(&g_count_fake_abort, 1);
+    }
+
+    return;
+  }
+
+  bool ret = true;
+  const uint32_t* targets = Targets(desc);
+
+  graphHelpStack.Push(desc);
+
+  while (desc->status == TransMap::MAP_ACTIVE && ret && opid < desc->size) {
+    const TransMap::Operator& op = desc->ops[opid];
+    TransMap* map = MapOf(targets[opid]);
+
+    if (map == NULL) {
+      ret = false;
+    } else if (op.type == TransMap::MAP_INSERT) {
+      ret = map->Insert(desc, opid, op.key, op.value, threadId);
+    } else if (op.type == TransMap::MAP_DELETE) {
+      ret = map->Delete(desc, opid, op.key, threadId);
+    } else if (op.type == TransMap::MAP_UPDATE) {
+      ret = map->Update(desc, opid, op.key, op.value, threadId);
+    } else {
+      ret = map->Find(desc, opid, op.key, threadId) != 0;
+    }
+
+    opid++;
+  }
+
+  graphHelpStack.Pop();
+
+  if (ret) {
+    if (__sync_bool_compare_and_swap(&desc->status, TransMap::MAP_ACTIVE,
+                                     TransMap::MAP_COMMITTED)) {
+      __sync_fetch_and_add(&g_count_commit, 1);
+    }
+  } else {
+    if (__sync_bool_compare_and_swap(&desc->status, TransMap::MAP_ACTIVE,
+                                     TransMap::MAP_ABORTED)) {
+      __sync_fetch_and_add(&g_count_abort, 1);
+    }
+  }
+}
+
+inline TransMap* TransGraph::MapOf(uint32_t target) {
+  if (target == VERTEX_TABLE) {
+    return &m_vertices;
+  }
+
+  return target < m_edges.size() ? m_edges[target] : NULL;
+}
+
+uint64_t TransGraph::BreadthFirst(uint32_t root) {
+  std::vector<uint32_t> keys;
+  std::vector<bool> present(m_edges.size(), false);
+  std::vector<bool> visited(m_edges.size(), false);
+
+  m_vertices.GetKeys(keys);
+
+  for (uint32_t i = 0; i < keys.size(); i++) {
+    if (keys[i] < m_edges.size()) {
+      present[keys[i]] = true;
+    }
+  }
+
+  if (root >= m_edges.size() || !present[root]) {
+    return 0;
+  }
+
+  std::vector<uint32_t> queue(1, root);
+  visited[root] = true;
+
+  for (uint32_t head = 0; head < queue.size(); head++) {
+    keys.clear();
+    m_edges[queue[head]]->GetKeys(keys);
+
+    for (uint32_t i = 0; i < keys.size(); i++) {
+      uint32_t v = keys[i];
+
+      if (v < m_edges.size() && present[v] && !visited[v]) {
+        visited[v] = true;
+        queue.push_back(v);
+      }
+    }
+  }
+
+  return queue.size();
+}
+
+void TransGraph::GetEdges(uint32_t src, std::vector<uint32_t>& dsts) {
+  dsts.clear();
+
+  if (src < m_edges.size()) {
+    m_edges[src]->GetKeys(dsts);
+  }
+}
+
+// The maps share the allocators, so those are only counted once
+MemoryStats TransGraph::GetMemoryStats() {
+  uint64_t poolReserved =
+      m_descAllocator->BytesReserved() + m_nodeDescAllocator->BytesReserved();
+  uint64_t poolUsed =
+      m_descAllocator->BytesUsed() + m_nodeDescAllocator->BytesUsed();
+  MemoryStats stats = m_vertices.GetMemoryStats();
+
+  for (uint32_t i = 0; i < m_edges.size(); i++) {
+    MemoryStats m = m_edges[i]->GetMemoryStats();
+    m.descriptors = 0;
+    m.bytesReserved -= poolReserved;
+    m.bytesUsed -= poolUsed;
+    stats += m;
+  }
+
+  return stats;
+}
+
+Metrics TransGraph::GetMetrics() {
+  Metrics metrics = {g_count_commit, g_count_abort, g_count_fake_abort};
+
+  metrics.parts = METRICS_MEMORY;
+  metrics.memory = GetMemoryStats();
+
+  return metrics;
+}
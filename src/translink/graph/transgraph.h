@@ -0,0 +1,87 @@
+#ifndef TRANSGRAPH_H
+#define TRANSGRAPH_H
+
+#include <cstdint>
+#include <vector>
+
+#include "common/allocator.h"
+#include "common/memstats.h"
+#include "common/metrics.h"
+#include "translink/map/transmap.h"
+
+#if toHash != 5
+#error "TransGraph reads vertices back from the TransMap hashes"
+#endif
+
+// Transactional directed graph kept as adjacency lists of TransMaps: one map
+// is the vertex table and every vertex has a map of its outgoing edges. A
+// transaction is a single TransMap::Desc whose ops may go to any of these
+// maps, so adding a vertex together with its edges, or moving an edge, is
+// atomic. The map of each op is kept in a target array right behind the ops,
+// and the maps hand helping over to the graph, as only the graph can tell
+// which map an op of another transaction goes to.
+//
+// Edge ops do not look at their endpoints. Transactions that want them to
+// exist add a FIND on the vertex table.
+class TransGraph {
+ public:
+  typedef TransMap::Desc Desc;
+  typedef TransMap::NodeDesc NodeDesc;
+
+  // Target of the ops on the vertex table. Any other target is the vertex
+  // whose edges the op goes to, keyed by the other end.
+  static const uint32_t VERTEX_TABLE = 0xffffffff;
+
+  // Slots in the main array of each edge map
+  static const uint32_t EDGE_TABLE_SIZE = 16;
+
+  TransGraph(Allocator<Desc>* descAllocator,
+             Allocator<NodeDesc>* nodeDescAllocator, uint32_t vertexCount,
+             uint64_t numThreads);
+  ~TransGraph();
+
+  static size_t SizeOf(uint32_t size) {
+    return Desc::SizeOf(size) + sizeof(uint32_t) * size;
+  }
+
+  static uint32_t* Targets(Desc* desc) {
+    return reinterpret_cast<uint32_t*>(&desc->ops[desc->size]);
+  }
+
+  Desc* AllocateDesc(uint32_t size);
+
+  bool ExecuteOps(Desc* desc, int threadId);
+
+  // Number of vertices reached from root over edges between present
+  // vertices. It reads the maps outside of any transaction, so under
+  // concurrent updates every edge map is seen as it was at some point during
+  // the search, but not all of them at the same point.
+  uint64_t BreadthFirst(uint32_t root);
+
+  // Heads of the edges leaving src, read outside of any transaction like
+  // BreadthFirst reads them
+  void GetEdges(uint32_t src, std::vector<uint32_t>& dsts);
+
+  Metrics GetMetrics();
+
+  MemoryStats GetMemoryStats();
+
+ private:
+  static void Help(void* graph, Desc* desc, uint32_t opid, int threadId);
+  void HelpOps(Desc* desc, uint32_t opid, int threadId);
+  TransMap* MapOf(uint32_t target);
+  void CountSizes(Desc* desc, bool begin);
+
+ private:
+  Allocator<Desc>* m_descAllocator;
+  Allocator<NodeDesc>* m_nodeDescAllocator;
+
+  TransMap m_vertices;
+  std::vector<TransMap*> m_edges;
+
+  uint32_t g_count_commit = 0;
+  uint32_t g_count_abort = 0;
+  uint32_t g_count_fake_abort = 0;
+};
+
+#endif /* end of include guard: TRANSGRAPH_H */
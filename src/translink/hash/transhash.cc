@@ -0,0 +1,408 @@
+//------------------------------------------------------------------------------
+//
+//
+//
+//------------------------------------------------------------------------------
+
+#include "translink/hash/transhash.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#define SET_MARK(_p) ((Node*)(((uintptr_t)(_p)) | 1))
+#define CLR_MARK(_p) ((Node*)(((uintptr_t)(_p)) & ~1))
+#define CLR_MARKD(_p) ((NodeDesc*)(((uintptr_t)(_p)) & ~1))
+#define IS_MARKED(_p) (((uintptr_t)(_p)) & 1)
+
+TransHash::TransHash(Allocator<Node>* nodeAllocator,
+                     Allocator<Desc>* descAllocator,
+                     Allocator<NodeDesc>* nodeDescAllocator)
+    : m_tail(new Node(0, 0xffffffffffffffff, NULL, NULL)),
+      m_head(new Node(0, SentinelKey(0), m_tail, NULL)),
+      m_segments(),
+      m_size(1),
+      m_count(0),
+      m_nodeAllocator(nodeAllocator),
+      m_descAllocator(descAllocator),
+      m_nodeDescAllocator(nodeDescAllocator) {
+  // Bucket 0 is the head of the whole list and never needs initializing
+  m_segments[0] = (Node**)calloc(1, sizeof(Node*));
+  m_segments[0][0] = m_head;
+}
+
+TransHash::~TransHash() {
+  for (uint32_t s = 0; s < MAX_SEGMENTS; ++s) {
+    free(m_segments[s]);
+  }
+}
+
+TransHash::Desc* TransHash::AllocateDesc(uint32_t size) {
+  Desc* desc = m_descAllocator->Alloc();
+  desc->size = size;
+  desc->status = ACTIVE;
+
+  return desc;
+}
+
+bool TransHash::ExecuteOps(Desc* desc) { return ExecuteDesc(desc); }
+
+inline TransHash::ReturnCode TransHash::RunOp(Desc* desc, uint32_t opid) {
+  const Operator& op = desc->ops[opid];
+
+  if (op.type == INSERT) {
+    return Insert(op.key, desc, opid);
+  } else if (op.type == DELETE) {
+    return Delete(op.key, desc, opid);
+  } else {
+    return Find(op.key, desc, opid);
+  }
+}
+
+inline TransHash::ReturnCode TransHash::Insert(uint32_t key, Desc* desc,
+                                               uint32_t opid) {
+  NodeDesc* nodeDesc = new (m_nodeDescAllocator->Alloc()) NodeDesc(desc, opid);
+  uint64_t soKey = RegularKey(key);
+  Node* bucket = GetBucket(key & (m_size - 1));
+  Node* new_node = NULL;
+  Node* pred = NULL;
+  Node* curr = bucket;
+
+  while (true) {
+    LocatePred(bucket, pred, curr, soKey);
+
+    if (!IsNodeExist(curr, soKey)) {
+      if (desc->status != ACTIVE) {
+        return FAIL;
+      }
+
+      if (new_node == NULL) {
+        new_node =
+            new (m_nodeAllocator->Alloc()) Node(key, soKey, NULL, nodeDesc);
+      }
+      new_node->next = curr;
+
+      Node* pred_next =
+          __sync_val_compare_and_swap(&pred->next, curr, new_node);
+
+      if (pred_next == curr) {
+        OnNodeLinked();
+        return OK;
+      }
+
+      // Restart
+      if (IS_MARKED(pred_next)) {
+        m_traversal.Local().restarts++;
+        curr = bucket;
+      } else {
+        curr = pred;
+      }
+    } else {
+      NodeDesc* oldCurrDesc = curr->nodeDesc;
+
+      if (IS_MARKED(oldCurrDesc)) {
+        if (!IS_MARKED(curr->next)) {
+          (__sync_fetch_and_or(&curr->next, 0x1));
+        }
+        m_traversal.Local().restarts++;
+        curr = bucket;
+        continue;
+      }
+
+      FinishPendingTxn(oldCurrDesc, desc);
+
+      if (IsSameOperation(oldCurrDesc, nodeDesc)) {
+        return SKIP;
+      }
+
+      if (!IsKeyExist(oldCurrDesc)) {
+        if (desc->status != ACTIVE) {
+          return FAIL;
+        }
+
+        if (__sync_bool_compare_and_swap(&curr->nodeDesc, oldCurrDesc,
+                                         nodeDesc)) {
+          return OK;
+        }
+      } else {
+        return FAIL;
+      }
+    }
+  }
+}
+
+inline TransHash::ReturnCode TransHash::Delete(uint32_t key, Desc* desc,
+                                               uint32_t opid) {
+  NodeDesc* nodeDesc = new (m_nodeDescAllocator->Alloc()) NodeDesc(desc, opid);
+  uint64_t soKey = RegularKey(key);
+  Node* bucket = GetBucket(key & (m_size - 1));
+  Node* pred = NULL;
+  Node* curr = bucket;
+
+  while (true) {
+    LocatePred(bucket, pred, curr, soKey);
+
+    if (IsNodeExist(curr, soKey)) {
+      NodeDesc* oldCurrDesc = curr->nodeDesc;
+
+      if (IS_MARKED(oldCurrDesc)) {
+        return FAIL;
+      }
+
+      FinishPendingTxn(oldCurrDesc, desc);
+
+      if (IsSameOperation(oldCurrDesc, nodeDesc)) {
+        return SKIP;
+      }
+
+      if (IsKeyExist(oldCurrDesc)) {
+        if (desc->status != ACTIVE) {
+          return FAIL;
+        }
+
+        if (__sync_bool_compare_and_swap(&curr->nodeDesc, oldCurrDesc,
+                                         nodeDesc)) {
+          return OK;
+        }
+      } else {
+        return FAIL;
+      }
+    } else {
+      return FAIL;
+    }
+  }
+}
+
+inline TransHash::ReturnCode TransHash::Find(uint32_t key, Desc* desc,
+                                             uint32_t opid) {
+  NodeDesc* nodeDesc = NULL;
+  uint64_t soKey = RegularKey(key);
+  Node* bucket = GetBucket(key & (m_size - 1));
+  Node* pred = NULL;
+  Node* curr = bucket;
+
+  while (true) {
+    LocatePred(bucket, pred, curr, soKey);
+
+    if (IsNodeExist(curr, soKey)) {
+      NodeDesc* oldCurrDesc = curr->nodeDesc;
+
+      if (IS_MARKED(oldCurrDesc)) {
+        if (!IS_MARKED(curr->next)) {
+          (__sync_fetch_and_or(&curr->next, 0x1));
+        }
+        m_traversal.Local().restarts++;
+        curr = bucket;
+        continue;
+      }
+
+      FinishPendingTxn(oldCurrDesc, desc);
+
+      if (nodeDesc == NULL)
+        nodeDesc = new (m_nodeDescAllocator->Alloc()) NodeDesc(desc, opid);
+
+      if (IsSameOperation(oldCurrDesc, nodeDesc)) {
+        return SKIP;
+      }
+
+      if (IsKeyExist(oldCurrDesc)) {
+        if (desc->status != ACTIVE) {
+          return FAIL;
+        }
+
+        if (__sync_bool_compare_and_swap(&curr->nodeDesc, oldCurrDesc,
+                                         nodeDesc)) {
+          return OK;
+        }
+      } else {
+        return FAIL;
+      }
+    } else {
+      return FAIL;
+    }
+  }
+}
+
+inline bool TransHash::IsNodeExist(Node* node, uint64_t soKey) {
+  return node != NULL && node->soKey == soKey;
+}
+
+inline void TransHash::LocatePred(Node* start, Node*& pred, Node*& curr,
+                                  uint64_t soKey) {
+  Node* pred_next;
+  // Count into locals and publish once, the loop below is the hot path
+  uint64_t visited = 0;
+  uint64_t markedSkipped = 0;
+  uint64_t restarts = 0;
+
+  while (curr->soKey < soKey) {
+    pred = curr;
+    pred_next = CLR_MARK(pred->next);
+    curr = pred_next;
+    visited++;
+
+    while (IS_MARKED(curr->next)) {
+      curr = CLR_MARK(curr->next);
+      markedSkipped++;
+    }
+
+    if (curr != pred_next) {
+      // Failed to remove deleted nodes, start over from the bucket
+      if (!__sync_bool_compare_and_swap(&pred->next, pred_next, curr)) {
+        curr = start;
+        restarts++;
+      }
+    }
+  }
+
+  TraversalStats& stats = m_traversal.Local();
+  stats.searches++;
+  stats.visited += visited + markedSkipped;
+  stats.markedSkipped += markedSkipped;
+  stats.restarts += restarts;
+  stats.unlinkCasFailures += restarts;
+
+  ASSERT(pred, "pred must be valid");
+}
+
+inline TransHash::Node** TransHash::BucketSlot(uint32_t bucket) {
+  uint32_t segment = bucket == 0 ? 0 : 32 - __builtin_clz(bucket);
+  uint32_t first = segment == 0 ? 0 : 1u << (segment - 1);
+  Node** buckets = m_segments[segment];
+
+  if (buckets == NULL) {
+    // Segments are only ever added, a thread losing the race frees its copy
+    Node** fresh = (Node**)calloc(segment == 0 ? 1 : first, sizeof(Node*));
+    ASSERT(fresh, "Bucket segment allocation failed.");
+
+    buckets = __sync_val_compare_and_swap(&m_segments[segment], NULL, fresh);
+    if (buckets == NULL) {
+      buckets = fresh;
+    } else {
+      free(fresh);
+    }
+  }
+
+  return &buckets[bucket - first];
+}
+
+inline TransHash::Node* TransHash::GetBucket(uint32_t bucket) {
+  Node* sentinel = *BucketSlot(bucket);
+
+  if (sentinel == NULL) {
+    sentinel = InitializeBucket(bucket);
+  }
+
+  return sentinel;
+}
+
+TransHash::Node* TransHash::InitializeBucket(uint32_t bucket) {
+  // The parent is the bucket this one split from, its sentinel precedes ours
+  uint32_t parent = bucket & ~(0x80000000u >> __builtin_clz(bucket));
+  Node* start = GetBucket(parent);
+  uint64_t soKey = SentinelKey(bucket);
+  Node* sentinel = NULL;
+  Node* pred = NULL;
+  Node* curr = start;
+
+  while (true) {
+    LocatePred(start, pred, curr, soKey);
+
+    if (IsNodeExist(curr, soKey)) {
+      // Another thread spliced it in first
+      sentinel = curr;
+      break;
+    }
+
+    if (sentinel == NULL) {
+      sentinel = new (m_nodeAllocator->Alloc()) Node(bucket, soKey, NULL, NULL);
+    }
+    sentinel->next = curr;
+
+    Node* pred_next = __sync_val_compare_and_swap(&pred->next, curr, sentinel);
+
+    if (pred_next == curr) {
+      break;
+    }
+
+    curr = IS_MARKED(pred_next) ? start : pred;
+  }
+
+  __sync_bool_compare_and_swap(BucketSlot(bucket), NULL, sentinel);
+
+  return sentinel;
+}
+
+inline void TransHash::OnNodeLinked() {
+  uint32_t size = m_size;
+  uint64_t count = __sync_add_and_fetch(&m_count, 1);
+
+  // Only the table size changes here, the new buckets fill in on first use
+  if (count > (uint64_t)size * LOAD_FACTOR && size < MAX_BUCKETS) {
+    __sync_bool_compare_and_swap(&m_size, size, size * 2);
+  }
+}
+
+inline uint64_t TransHash::Reverse(uint64_t v) {
+  v = ((v >> 1) & 0x5555555555555555) | ((v & 0x5555555555555555) << 1);
+  v = ((v >> 2) & 0x3333333333333333) | ((v & 0x3333333333333333) << 2);
+  v = ((v >> 4) & 0x0f0f0f0f0f0f0f0f) | ((v & 0x0f0f0f0f0f0f0f0f) << 4);
+
+  return __builtin_bswap64(v);
+}
+
+// The key bits land in the upper half, the lowest bit tells regular nodes
+// apart from the sentinel of the bucket they hash to
+inline uint64_t TransHash::RegularKey(uint32_t key) {
+  return Reverse(key) | 1;
+}
+
+inline uint64_t TransHash::SentinelKey(uint32_t bucket) {
+  return Reverse(bucket);
+}
+
+MemoryStats TransHash::GetMemoryStats() {
+  MemoryStats stats = {};
+
+  for (Node* curr = CLR_MARK(m_head->next); curr != m_tail;
+       curr = CLR_MARK(curr->next)) {
+    if (curr->nodeDesc == NULL) {
+      continue;
+    }
+
+    if (IsKeyExist(CLR_MARKD(curr->nodeDesc))) {
+      stats.liveNodes++;
+    } else {
+      stats.deletedNodes++;
+    }
+  }
+
+  stats.descriptors = m_descAllocator->Allocated();
+
+  // The head and tail come from the heap along with the bucket segments,
+  // everything else from the pools
+  uint64_t tableBytes = 0;
+  for (uint32_t s = 0; s < MAX_SEGMENTS; ++s) {
+    if (m_segments[s] != NULL) {
+      tableBytes += (s == 0 ? 1 : 1u << (s - 1)) * sizeof(Node*);
+    }
+  }
+
+  stats.AddHeap(2 * sizeof(Node) + tableBytes);
+  stats.AddPool(m_nodeAllocator);
+  stats.AddPool(m_descAllocator);
+  stats.AddPool(m_nodeDescAllocator);
+
+  return stats;
+}
+
+Metrics TransHash::GetMetrics() {
+  Metrics metrics = {g_count_commit, g_count_abort, g_count_fake_abort};
+
+  metrics.parts = METRICS_TRAVERSAL | METRICS_MEMORY | METRICS_TABLE;
+  metrics.traversal = m_traversal.Sum();
+  metrics.memory = GetMemoryStats();
+  metrics.table.buckets = m_size;
+
+  return metrics;
+}
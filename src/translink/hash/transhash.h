@@ -0,0 +1,99 @@
+#ifndef TRANSHASH_H
+#define TRANSHASH_H
+
+#include <cstdint>
+
+#include "common/allocator.h"
+#include "common/assert.h"
+#include "common/memstats.h"
+#include "common/metrics.h"
+#include "common/threadstats.h"
+#include "translink/transbase.h"
+
+// Transactional hash set over a split-ordered list (Shalev and Shavit). All
+// keys live in one lock-free list sorted by bit-reversed key, and the bucket
+// table only holds shortcuts into it, so doubling the table never moves a
+// node: new buckets are initialized lazily on first use by splicing a sentinel
+// after their parent bucket's sentinel. Transactions run the TransList
+// protocol on the regular nodes.
+class TransHash : public TransBase<TransHash> {
+ public:
+  struct Operator {
+    uint8_t type;
+    uint32_t key;
+  };
+
+  typedef TransDesc<Operator> Desc;
+  typedef TransNodeDesc<Desc> NodeDesc;
+
+  struct Node {
+    Node() : key(0), soKey(0), next(NULL), nodeDesc(NULL) {}
+    Node(uint32_t _key, uint64_t _soKey, Node* _next, NodeDesc* _nodeDesc)
+        : key(_key), soKey(_soKey), next(_next), nodeDesc(_nodeDesc) {}
+
+    uint32_t key;
+    uint64_t soKey;  // split-order key, the list is sorted on it
+    Node* next;
+
+    NodeDesc* nodeDesc;  // NULL for bucket sentinels
+  };
+
+  TransHash(Allocator<Node>* nodeAllocator, Allocator<Desc>* descAllocator,
+            Allocator<NodeDesc>* nodeDescAllocator);
+  ~TransHash();
+
+  bool ExecuteOps(Desc* desc);
+
+  Desc* AllocateDesc(uint32_t size);
+
+  Metrics GetMetrics();
+
+  TraversalStats GetTraversalStats() const { return m_traversal.Sum(); }
+
+  MemoryStats GetMemoryStats();
+
+  uint32_t BucketCount() const { return m_size; }
+
+ private:
+  friend class TransBase<TransHash>;
+
+  ReturnCode RunOp(Desc* desc, uint32_t opid);
+  ReturnCode Insert(uint32_t key, Desc* desc, uint32_t opid);
+  ReturnCode Delete(uint32_t key, Desc* desc, uint32_t opid);
+  ReturnCode Find(uint32_t key, Desc* desc, uint32_t opid);
+
+  bool IsNodeExist(Node* node, uint64_t soKey);
+  void LocatePred(Node* start, Node*& pred, Node*& curr, uint64_t soKey);
+
+  Node* GetBucket(uint32_t bucket);
+  Node* InitializeBucket(uint32_t bucket);
+  Node** BucketSlot(uint32_t bucket);
+  void OnNodeLinked();
+
+  static uint64_t Reverse(uint64_t v);
+  static uint64_t RegularKey(uint32_t key);
+  static uint64_t SentinelKey(uint32_t bucket);
+
+ private:
+  // Average number of linked nodes per bucket before the table doubles;
+  // logically deleted nodes stay linked and still cost a step in the walk
+  static const uint32_t LOAD_FACTOR = 2;
+  // Segment s holds buckets [2^(s-1), 2^s), segment 0 holds bucket 0 only
+  static const uint32_t MAX_SEGMENTS = 32;
+  static const uint32_t MAX_BUCKETS = 1u << (MAX_SEGMENTS - 1);
+
+  Node* m_tail;
+  Node* m_head;
+
+  Node** m_segments[MAX_SEGMENTS];
+  volatile uint32_t m_size;
+  uint64_t m_count;
+
+  Allocator<Node>* m_nodeAllocator;
+  Allocator<Desc>* m_descAllocator;
+  Allocator<NodeDesc>* m_nodeDescAllocator;
+
+  ThreadStats<TraversalStats> m_traversal;
+};
+
+#endif /* end of include guard: TRANSHASH_H */
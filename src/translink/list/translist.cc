@@ -8,6 +8,7 @@
 
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <new>
 
 #define SET_MARK(_p) ((Node*)(((uintptr_t)(_p)) | 1))
@@ -15,20 +16,24 @@
 #define CLR_MARKD(_p) ((NodeDesc*)(((uintptr_t)(_p)) & ~1))
 #define IS_MARKED(_p) (((uintptr_t)(_p)) & 1)
 
-__thread TransList::HelpStack helpStack;
+template <typename Key, typename Compare>
+thread_local HelpStack<typename BasicTransList<Key, Compare>::Desc>
+    BasicTransList<Key, Compare>::m_helpStack;
 
-TransList::TransList(Allocator<Node>* nodeAllocator,
-                     Allocator<Desc>* descAllocator,
-                     Allocator<NodeDesc>* nodeDescAllocator)
-    : m_tail(new Node(0xffffffff, NULL, NULL)),
-      m_head(new Node(0, m_tail, NULL)),
+template <typename Key, typename Compare>
+BasicTransList<Key, Compare>::BasicTransList(
+    Allocator<Node>* nodeAllocator, Allocator<Desc>* descAllocator,
+    Allocator<NodeDesc>* nodeDescAllocator, const Compare& compare)
+    : m_tail(new Node(Key(), NULL, NULL)),
+      m_head(new Node(Key(), m_tail, NULL)),
       m_nodeAllocator(nodeAllocator),
       m_descAllocator(descAllocator),
-      m_nodeDescAllocator(nodeDescAllocator) {}
+      m_nodeDescAllocator(nodeDescAllocator),
+      m_compare(compare),
+      m_size(SizeDelta) {}
 
-TransList::~TransList() {
-  printf("Total commit %u, abort (total/fake) %u/%u\n", g_count_commit,
-         g_count_abort, g_count_fake_abort);
+template <typename Key, typename Compare>
+BasicTransList<Key, Compare>::~BasicTransList() {
   // Print();
 
   ASSERT_CODE(printf("Total node count %u, Inserts (total/new) %u/%u, Deletes "
@@ -44,7 +49,9 @@ TransList::~TransList() {
   //}
 }
 
-TransList::Desc* TransList::AllocateDesc(uint8_t size) {
+template <typename Key, typename Compare>
+typename BasicTransList<Key, Compare>::Desc*
+BasicTransList<Key, Compare>::AllocateDesc(uint32_t size) {
   Desc* desc = m_descAllocator->Alloc();
   desc->size = size;
   desc->status = ACTIVE;
@@ -52,11 +59,15 @@ TransList::Desc* TransList::AllocateDesc(uint8_t size) {
   return desc;
 }
 
-bool TransList::ExecuteOps(Desc* desc) {
-  helpStack.Init();
+template <typename Key, typename Compare>
+bool BasicTransList<Key, Compare>::ExecuteOps(Desc* desc) {
+  m_helpStack.Init();
+  m_size.Begin(desc);
 
   HelpOps(desc, 0);
 
+  m_size.End();
+
   bool ret = desc->status != ABORTED;
 
   ASSERT_CODE(if (ret) {
@@ -74,9 +85,291 @@ bool TransList::ExecuteOps(Desc* desc) {
   return ret;
 }
 
-inline void TransList::MarkForDeletion(const std::vector<Node*>& nodes,
-                                       const std::vector<Node*>& preds,
-                                       Desc* desc) {
+template <typename Key, typename Compare>
+bool BasicTransList<Key, Compare>::ExecuteOp(Desc* desc, uint32_t opid) {
+  const Operator& op = desc->ops[opid];
+  Node* node;
+  Node* pred;
+  ReturnCode ret;
+
+  if (op.type == INSERT) {
+    ret = Insert(op.key, desc, opid, node, pred);
+  } else if (op.type == DELETE) {
+    ret = Delete(op.key, desc, opid, node, pred);
+  } else {
+    ret = Find(op.key, desc, opid);
+  }
+
+  return ret != FAIL;
+}
+
+template <typename Key, typename Compare>
+bool BasicTransList<Key, Compare>::ExecuteDynamic(Desc*& desc, bool waitFree) {
+  ASSERT(m_owner == NULL, "dynamic transactions do not go through an owner");
+
+  Program* program = GetProgram(desc);
+  program->stamp = 0;
+
+  while (waitFree && program->stamp == 0) {
+    program->stamp = __sync_add_and_fetch(&m_stamp, 1);
+  }
+
+  for (uint32_t i = 0; i < desc->size; ++i) {
+    ASSERT(program->steps[i].guard == ALWAYS || program->steps[i].dep < i,
+           "guards read earlier ops");
+
+    desc->ops[i].type |= DYNAMIC;
+    program->steps[i].result = PENDING;
+  }
+
+  while (true) {
+    m_helpStack.Init();
+    m_size.Begin(desc);
+
+    HelpDynamic(desc, 0);
+
+    m_size.End();
+
+    if (desc->status == COMMITTED || !waitFree) {
+      break;
+    }
+
+    // Older transactions took precedence, go again with the same age
+    Desc* retry = m_descAllocator->Alloc();
+    memcpy(retry, desc, DynamicSizeOf(desc->size));
+    retry->status = ACTIVE;
+
+    program = GetProgram(retry);
+    for (uint32_t i = 0; i < retry->size; ++i) {
+      program->steps[i].result = PENDING;
+    }
+
+    desc = retry;
+  }
+
+  return desc->status == COMMITTED;
+}
+
+// Net number of keys the share of desc added once committed. The ops of a
+// dynamic transaction see each other, so only those that got through count.
+template <typename Key, typename Compare>
+int64_t BasicTransList<Key, Compare>::SizeDelta(
+    Desc* desc, const typename SizeCounter<Desc>::Share& share) {
+  if (desc->status != COMMITTED) {
+    return 0;
+  }
+
+  bool dynamic = desc->size > 0 && (desc->ops[0].type & DYNAMIC);
+  Program* program = dynamic ? GetProgram(desc) : NULL;
+  int64_t delta = 0;
+
+  for (uint32_t i = 0; i < desc->size; ++i) {
+    if ((dynamic && program->steps[i].result != SUCCEEDED) ||
+        !share.Counts(desc, i)) {
+      continue;
+    }
+
+    uint8_t type = desc->ops[i].type & ~DYNAMIC;
+
+    if (type == INSERT) {
+      delta++;
+    } else if (type == DELETE) {
+      delta--;
+    }
+  }
+
+  return delta;
+}
+
+template <typename Key, typename Compare>
+inline void BasicTransList<Key, Compare>::HelpDynamic(Desc* desc,
+                                                      uint32_t opid) {
+  if (desc->status != ACTIVE) {
+    return;
+  }
+
+  if (m_helpStack.Contain(desc)) {
+    AbortCycle(desc);
+    return;
+  }
+
+  Program* program = GetProgram(desc);
+
+  m_helpStack.Push(desc);
+
+  for (; desc->status == ACTIVE && opid < desc->size; opid++) {
+    Step& step = program->steps[opid];
+
+    if (step.result != PENDING) {
+      continue;
+    }
+
+    if (IsGuardOpen(program, step)) {
+      RunStep(desc, opid);
+    } else {
+      __sync_bool_compare_and_swap(&step.result, PENDING, SKIPPED);
+    }
+  }
+
+  m_helpStack.Pop();
+
+  // Failed ops are results, only a help cycle aborts
+  if (__sync_bool_compare_and_swap(&desc->status, ACTIVE, COMMITTED)) {
+    __sync_fetch_and_add(&g_count_commit, 1);
+  }
+}
+
+// Takes the node of the key over whether or not the op succeeds, so that what
+// it found holds until the transaction is done. A missing key gets a node
+// that keeps it absent. Leaves the result in the step before returning, unless
+// the transaction is over.
+template <typename Key, typename Compare>
+inline void BasicTransList<Key, Compare>::RunStep(Desc* desc, uint32_t opid) {
+  const Key& key = desc->ops[opid].key;
+  uint8_t opType = desc->ops[opid].type & ~DYNAMIC;
+  NodeDesc* nodeDesc = new (m_nodeDescAllocator->Alloc()) NodeDesc(desc, opid);
+  Node* new_node = NULL;
+  Node* pred = NULL;
+  Node* curr = m_head;
+
+  while (desc->status == ACTIVE) {
+    LocatePred(pred, curr, key);
+
+    if (!IsNodeExist(curr, key)) {
+      if (new_node == NULL) {
+        new_node = new (m_nodeAllocator->Alloc()) Node(key, NULL, nodeDesc);
+      }
+      new_node->next = curr;
+      nodeDesc->present = false;
+      nodeDesc->original = false;
+
+      Node* pred_next =
+          __sync_val_compare_and_swap(&pred->next, curr, new_node);
+
+      if (pred_next == curr) {
+        SaveResult(nodeDesc);
+        return;
+      }
+
+      // Restart
+      if (IS_MARKED(pred_next)) {
+        m_traversal.Local().restarts++;
+        curr = m_head;
+      } else {
+        curr = pred;
+      }
+
+      continue;
+    }
+
+    NodeDesc* oldCurrDesc = curr->nodeDesc;
+
+    if (IS_MARKED(oldCurrDesc)) {
+      if (!IS_MARKED(curr->next)) {
+        (__sync_fetch_and_or(&curr->next, 0x1));
+      }
+      m_traversal.Local().restarts++;
+      curr = m_head;
+      continue;
+    }
+
+    if (oldCurrDesc->desc == desc) {
+      // This op or a later one of ours got here first
+      if (oldCurrDesc->opid >= opid) {
+        if (oldCurrDesc->opid == opid) {
+          SaveResult(oldCurrDesc);
+        }
+
+        return;
+      }
+
+      nodeDesc->present = IsPresentAfter(oldCurrDesc);
+      nodeDesc->original = oldCurrDesc->original;
+
+      // An earlier op holds the key already, only a change needs a new hold
+      if (opType == FIND || (opType == INSERT) == nodeDesc->present) {
+        SaveResult(nodeDesc);
+        return;
+      }
+    } else {
+      FinishPendingTxn(oldCurrDesc, desc);
+
+      if (desc->status != ACTIVE) {
+        return;
+      }
+
+      nodeDesc->present = IsKeyExist(oldCurrDesc);
+      nodeDesc->original = nodeDesc->present;
+    }
+
+    if (__sync_bool_compare_and_swap(&curr->nodeDesc, oldCurrDesc, nodeDesc)) {
+      SaveResult(nodeDesc);
+      return;
+    }
+  }
+}
+
+template <typename Key, typename Compare>
+inline void BasicTransList<Key, Compare>::SaveResult(NodeDesc* nodeDesc) {
+  uint8_t opType = nodeDesc->desc->ops[nodeDesc->opid].type & ~DYNAMIC;
+  Step& step = GetProgram(nodeDesc->desc)->steps[nodeDesc->opid];
+  bool succeeded = opType == INSERT ? !nodeDesc->present : nodeDesc->present;
+
+  __sync_bool_compare_and_swap(&step.result, PENDING,
+                               succeeded ? SUCCEEDED : FAILED);
+}
+
+template <typename Key, typename Compare>
+inline bool BasicTransList<Key, Compare>::IsGuardOpen(Program* program,
+                                                      const Step& step) {
+  if (step.guard == ALWAYS) {
+    return true;
+  }
+
+  uint8_t result = program->steps[step.dep].result;
+
+  return (step.guard == IF_SUCCEEDED && result == SUCCEEDED) ||
+         (step.guard == IF_FAILED && result == FAILED);
+}
+
+// Whether the key is there once the op of a dynamic transaction is done
+template <typename Key, typename Compare>
+inline bool BasicTransList<Key, Compare>::IsPresentAfter(NodeDesc* nodeDesc) {
+  uint8_t opType = nodeDesc->desc->ops[nodeDesc->opid].type & ~DYNAMIC;
+
+  return opType == INSERT || (opType != DELETE && nodeDesc->present);
+}
+
+template <typename Key, typename Compare>
+inline bool BasicTransList<Key, Compare>::IsOlder(Desc* desc1, Desc* desc2) {
+  if (desc1->size == 0 || desc2->size == 0 ||
+      !(desc1->ops[0].type & desc2->ops[0].type & DYNAMIC)) {
+    return false;
+  }
+
+  uint32_t stamp1 = GetProgram(desc1)->stamp;
+  uint32_t stamp2 = GetProgram(desc2)->stamp;
+
+  return stamp1 != 0 && stamp2 != 0 && (int32_t)(stamp1 - stamp2) < 0;
+}
+
+// desc is on the help stack, so helping it waits on itself. Break the cycle by
+// aborting desc, or the transaction on top of the stack if desc is an older
+// wait-free one.
+template <typename Key, typename Compare>
+inline void BasicTransList<Key, Compare>::AbortCycle(Desc* desc) {
+  Desc* victim = IsOlder(desc, m_helpStack.Top()) ? m_helpStack.Top() : desc;
+
+  if (__sync_bool_compare_and_swap(&victim->status, ACTIVE, ABORTED)) {
+    __sync_fetch_and_add(&g_count_abort, 1);
+    __sync_fetch_and_add(&g_count_fake_abort, 1);
+  }
+}
+
+template <typename Key, typename Compare>
+inline void BasicTransList<Key, Compare>::MarkForDeletion(
+    const std::vector<Node*>& nodes, const std::vector<Node*>& preds,
+    Desc* desc) {
   // Mark nodes for logical deletion
   for (uint32_t i = 0; i < nodes.size(); ++i) {
     Node* n = nodes[i];
@@ -95,18 +388,15 @@ inline void TransList::MarkForDeletion(const std::vector<Node*>& nodes,
   }
 }
 
-inline void TransList::HelpOps(Desc* desc, uint8_t opid) {
+template <typename Key, typename Compare>
+inline void BasicTransList<Key, Compare>::HelpOps(Desc* desc, uint32_t opid) {
   if (desc->status != ACTIVE) {
     return;
   }
 
   // Cyclic dependcy check
-  if (helpStack.Contain(desc)) {
-    if (__sync_bool_compare_and_swap(&desc->status, ACTIVE, ABORTED)) {
-      __sync_fetch_and_add(&g_count_abort, 1);
-      __sync_fetch_and_add(&g_count_fake_abort, 1);
-    }
-
+  if (m_helpStack.Contain(desc)) {
+    AbortCycle(desc);
     return;
   }
 
@@ -116,7 +406,7 @@ inline void TransList::HelpOps(Desc* desc, uint8_t opid) {
   std::vector<Node*> insNodes;
   std::vector<Node*> insPredNodes;
 
-  helpStack.Push(desc);
+  m_helpStack.Push(desc);
 
   while (desc->status == ACTIVE && ret != FAIL && opid < desc->size) {
     const Operator& op = desc->ops[opid];
@@ -142,7 +432,7 @@ inline void TransList::HelpOps(Desc* desc, uint8_t opid) {
     opid++;
   }
 
-  helpStack.Pop();
+  m_helpStack.Pop();
 
   if (ret != FAIL) {
     if (__sync_bool_compare_and_swap(&desc->status, ACTIVE, COMMITTED)) {
@@ -157,9 +447,10 @@ inline void TransList::HelpOps(Desc* desc, uint8_t opid) {
   }
 }
 
-inline TransList::ReturnCode TransList::Insert(uint32_t key, Desc* desc,
-                                               uint8_t opid, Node*& inserted,
-                                               Node*& pred) {
+template <typename Key, typename Compare>
+inline typename BasicTransList<Key, Compare>::ReturnCode
+BasicTransList<Key, Compare>::Insert(const Key& key, Desc* desc, uint32_t opid,
+                                     Node*& inserted, Node*& pred) {
   inserted = NULL;
   NodeDesc* nodeDesc = new (m_nodeDescAllocator->Alloc()) NodeDesc(desc, opid);
   Node* new_node = NULL;
@@ -200,7 +491,12 @@ inline TransList::ReturnCode TransList::Insert(uint32_t key, Desc* desc,
       //}
 
       // Restart
-      curr = IS_MARKED(pred_next) ? m_head : pred;
+      if (IS_MARKED(pred_next)) {
+        m_traversal.Local().restarts++;
+        curr = m_head;
+      } else {
+        curr = pred;
+      }
     } else {
       NodeDesc* oldCurrDesc = curr->nodeDesc;
 
@@ -208,6 +504,7 @@ inline TransList::ReturnCode TransList::Insert(uint32_t key, Desc* desc,
         if (!IS_MARKED(curr->next)) {
           (__sync_fetch_and_or(&curr->next, 0x1));
         }
+        m_traversal.Local().restarts++;
         curr = m_head;
         continue;
       }
@@ -247,9 +544,10 @@ inline TransList::ReturnCode TransList::Insert(uint32_t key, Desc* desc,
   }
 }
 
-inline TransList::ReturnCode TransList::Delete(uint32_t key, Desc* desc,
-                                               uint8_t opid, Node*& deleted,
-                                               Node*& pred) {
+template <typename Key, typename Compare>
+inline typename BasicTransList<Key, Compare>::ReturnCode
+BasicTransList<Key, Compare>::Delete(const Key& key, Desc* desc, uint32_t opid,
+                                     Node*& deleted, Node*& pred) {
   deleted = NULL;
   NodeDesc* nodeDesc = new (m_nodeDescAllocator->Alloc()) NodeDesc(desc, opid);
   Node* curr = m_head;
@@ -306,14 +604,16 @@ inline TransList::ReturnCode TransList::Delete(uint32_t key, Desc* desc,
   }
 }
 
-inline bool TransList::IsSameOperation(NodeDesc* nodeDesc1,
-                                       NodeDesc* nodeDesc2) {
+template <typename Key, typename Compare>
+inline bool BasicTransList<Key, Compare>::IsSameOperation(
+    NodeDesc* nodeDesc1, NodeDesc* nodeDesc2) {
   return nodeDesc1->desc == nodeDesc2->desc &&
          nodeDesc1->opid == nodeDesc2->opid;
 }
 
-inline TransList::ReturnCode TransList::Find(uint32_t key, Desc* desc,
-                                             uint8_t opid) {
+template <typename Key, typename Compare>
+inline typename BasicTransList<Key, Compare>::ReturnCode
+BasicTransList<Key, Compare>::Find(const Key& key, Desc* desc, uint32_t opid) {
   NodeDesc* nodeDesc = NULL;
   Node* pred;
   Node* curr = m_head;
@@ -328,6 +628,7 @@ inline TransList::ReturnCode TransList::Find(uint32_t key, Desc* desc,
         if (!IS_MARKED(curr->next)) {
           (__sync_fetch_and_or(&curr->next, 0x1));
         }
+        m_traversal.Local().restarts++;
         curr = m_head;
         continue;
       }
@@ -367,68 +668,147 @@ inline TransList::ReturnCode TransList::Find(uint32_t key, Desc* desc,
   }
 }
 
-inline bool TransList::IsNodeExist(Node* node, uint32_t key) {
-  return node != NULL && node->key == key;
+// Only called on the node LocatePred stopped at, which is not smaller than key
+template <typename Key, typename Compare>
+inline bool BasicTransList<Key, Compare>::IsNodeExist(Node* node,
+                                                      const Key& key) {
+  return node != NULL && node != m_tail && !m_compare(key, node->key);
 }
 
-inline void TransList::FinishPendingTxn(NodeDesc* nodeDesc, Desc* desc) {
+template <typename Key, typename Compare>
+inline void BasicTransList<Key, Compare>::FinishPendingTxn(NodeDesc* nodeDesc,
+                                                           Desc* desc) {
   // The node accessed by the operations in same transaction is always active
   if (nodeDesc->desc == desc) {
     return;
   }
 
-  HelpOps(nodeDesc->desc, nodeDesc->opid + 1);
+  if (m_owner != NULL) {
+    m_help(m_owner, nodeDesc->desc, nodeDesc->opid + 1);
+  } else if (nodeDesc->desc->ops[nodeDesc->opid].type & DYNAMIC) {
+    // The op that got here may not have told the others what it found yet
+    SaveResult(nodeDesc);
+    HelpDynamic(nodeDesc->desc, nodeDesc->opid + 1);
+  } else {
+    HelpOps(nodeDesc->desc, nodeDesc->opid + 1);
+  }
 }
 
-inline bool TransList::IsNodeActive(NodeDesc* nodeDesc) {
+template <typename Key, typename Compare>
+inline bool BasicTransList<Key, Compare>::IsNodeActive(NodeDesc* nodeDesc) {
   return nodeDesc->desc->status == COMMITTED;
 }
 
-inline bool TransList::IsKeyExist(NodeDesc* nodeDesc) {
+template <typename Key, typename Compare>
+inline bool BasicTransList<Key, Compare>::IsKeyExist(NodeDesc* nodeDesc) {
   bool isNodeActive = IsNodeActive(nodeDesc);
   uint8_t opType = nodeDesc->desc->ops[nodeDesc->opid].type;
 
+  if (opType & DYNAMIC) {
+    return isNodeActive ? IsPresentAfter(nodeDesc) : nodeDesc->original;
+  }
+
   return (opType == FIND) || (isNodeActive && opType == INSERT) ||
          (!isNodeActive && opType == DELETE);
 }
 
-inline void TransList::LocatePred(Node*& pred, Node*& curr, uint32_t key) {
+// Whether the search for key goes on past node. The head is before and the
+// tail after every key.
+template <typename Key, typename Compare>
+inline bool BasicTransList<Key, Compare>::IsBefore(Node* node,
+                                                   const Key& key) {
+  return node == m_head || (node != m_tail && m_compare(node->key, key));
+}
+
+template <typename Key, typename Compare>
+inline void BasicTransList<Key, Compare>::LocatePred(Node*& pred, Node*& curr,
+                                                     const Key& key) {
   Node* pred_next;
+  // Count into locals and publish once, the loop below is the hot path
+  uint64_t visited = 0;
+  uint64_t markedSkipped = 0;
+  uint64_t restarts = 0;
 
-  while (curr->key < key) {
+  while (IsBefore(curr, key)) {
     pred = curr;
     pred_next = CLR_MARK(pred->next);
     curr = pred_next;
+    visited++;
 
     while (IS_MARKED(curr->next)) {
       curr = CLR_MARK(curr->next);
+      markedSkipped++;
     }
 
     if (curr != pred_next) {
       // Failed to remove deleted nodes, start over from pred
       if (!__sync_bool_compare_and_swap(&pred->next, pred_next, curr)) {
         curr = m_head;
+        restarts++;
       }
 
       //__sync_bool_compare_and_swap(&pred->next, pred_next, curr);
     }
   }
 
+  TraversalStats& stats = m_traversal.Local();
+  stats.searches++;
+  stats.visited += visited + markedSkipped;
+  stats.markedSkipped += markedSkipped;
+  stats.restarts += restarts;
+  stats.unlinkCasFailures += restarts;
+
   ASSERT(pred, "pred must be valid");
 }
 
-inline void TransList::Print() {
+template <typename Key, typename Compare>
+inline void BasicTransList<Key, Compare>::Print() {
   Node* curr = m_head->next;
 
   while (curr != m_tail) {
-    printf("Node [%p] Key [%u] Status [%s]\n", curr, curr->key,
+    printf("Node [%p] Status [%s]\n", curr,
            IsKeyExist(CLR_MARKD(curr->nodeDesc)) ? "Exist" : "Inexist");
     curr = CLR_MARK(curr->next);
   }
 }
 
-void TransList::ResetMetrics() {
-  g_count_commit = 0;
-  g_count_abort = 0;
-  g_count_fake_abort = 0;
+template <typename Key, typename Compare>
+MemoryStats BasicTransList<Key, Compare>::GetMemoryStats() {
+  MemoryStats stats = {};
+
+  for (Node* curr = CLR_MARK(m_head->next); curr != m_tail;
+       curr = CLR_MARK(curr->next)) {
+    if (IsKeyExist(CLR_MARKD(curr->nodeDesc))) {
+      stats.liveNodes++;
+    } else {
+      stats.deletedNodes++;
+    }
+  }
+
+  stats.descriptors = m_descAllocator->Allocated();
+
+  // The sentinels come from the heap, everything else from the pools
+  stats.bytesReserved = 2 * sizeof(Node) + m_nodeAllocator->BytesReserved() +
+                        m_descAllocator->BytesReserved() +
+                        m_nodeDescAllocator->BytesReserved();
+  stats.bytesUsed = 2 * sizeof(Node) + m_nodeAllocator->BytesUsed() +
+                    m_descAllocator->BytesUsed() +
+                    m_nodeDescAllocator->BytesUsed();
+
+  return stats;
 }
+
+template <typename Key, typename Compare>
+Metrics BasicTransList<Key, Compare>::GetMetrics() {
+  Metrics metrics = {g_count_commit, g_count_abort, g_count_fake_abort};
+
+  metrics.parts = METRICS_TRAVERSAL | METRICS_MEMORY;
+  metrics.traversal = m_traversal.Sum();
+  metrics.memory = GetMemoryStats();
+
+  return metrics;
+}
+
+template class BasicTransList<uint32_t>;
+template class BasicTransList<uint64_t>;
+template class BasicTransList<TransListEntry, TransListEntryLess>;
@@ -2,12 +2,24 @@
 #define TRANSLIST_H
 
 #include <cstdint>
+#include <cstdlib>
+#include <functional>
 #include <vector>
 
 #include "common/allocator.h"
 #include "common/assert.h"
-
-class TransList {
+#include "common/helpstack.h"
+#include "common/memstats.h"
+#include "common/metrics.h"
+#include "common/sizecounter.h"
+#include "common/threadstats.h"
+
+// Keys are ordered by Compare, which must be a strict weak ordering. The
+// sentinels are told apart by address, so every key value is usable. The
+// definitions live in translist.cc, which instantiates 32 and 64 bit integer
+// keys; other key types need an instantiation there too.
+template <typename Key, typename Compare = std::less<Key>>
+class BasicTransList {
  public:
   enum OpStatus {
     ACTIVE = 0,
@@ -19,99 +31,160 @@ class TransList {
 
   enum OpType { FIND = 0, INSERT, DELETE };
 
+  // Set on the ops of dynamic transactions, see ExecuteDynamic
+  enum { DYNAMIC = 0x80 };
+
+  // Whether an op of a dynamic transaction runs, going by the result of an
+  // earlier op, and what became of it
+  enum StepGuard { ALWAYS = 0, IF_SUCCEEDED, IF_FAILED };
+
+  enum StepResult { PENDING = 0, SUCCEEDED, FAILED, SKIPPED };
+
   struct Operator {
     uint8_t type;
-    uint32_t key;
+    Key key;
   };
 
   struct Desc {
-    static size_t SizeOf(uint8_t size) {
-      return sizeof(uint8_t) + sizeof(uint8_t) + sizeof(Operator) * size;
+    static size_t SizeOf(uint32_t size) {
+      return sizeof(Desc) + sizeof(Operator) * size;
     }
 
     // Status of the transaction: values in [0, size] means live txn, values -1
     // means aborted, value -2 means committed.
     volatile uint8_t status;
-    uint8_t size;
+    // Up to 16M ops. Packed in next to status, the header is no larger than
+    // with an 8 bit size.
+    uint32_t size : 24;
     Operator ops[];
   };
 
+  struct Step {
+    uint32_t dep;  // op the guard reads, before this one
+    uint8_t guard;
+    volatile uint8_t result;
+  };
+
+  // Laid out behind the ops of a dynamic Desc
+  struct Program {
+    uint32_t stamp;  // age in wait-free mode, 0 otherwise
+    Step steps[];
+  };
+
   struct NodeDesc {
-    NodeDesc(Desc* _desc, uint8_t _opid) : desc(_desc), opid(_opid) {}
+    NodeDesc(Desc* _desc, uint32_t _opid)
+        : desc(_desc), opid(_opid), present(false), original(false) {}
 
     Desc* desc;
-    uint8_t opid;
+    uint32_t opid;
+    // Only kept for dynamic transactions: whether the op found the key, and
+    // whether it was there before the transaction, which holds if it aborts
+    bool present;
+    bool original;
   };
 
   struct Node {
-    Node() : key(0), next(NULL), nodeDesc(NULL) {}
-    Node(uint32_t _key, Node* _next, NodeDesc* _nodeDesc)
+    Node() : key(), next(NULL), nodeDesc(NULL) {}
+    Node(const Key& _key, Node* _next, NodeDesc* _nodeDesc)
         : key(_key), next(_next), nodeDesc(_nodeDesc) {}
 
-    uint32_t key;
+    Key key;
     Node* next;
 
     NodeDesc* nodeDesc;
   };
 
-  struct HelpStack {
-    void Init() { index = 0; }
+  // Structures built out of several containers share one Desc between them,
+  // and only the owner knows which container each op goes to. Helping then
+  // goes through it.
+  typedef void (*HelpFn)(void* owner, Desc* desc, uint32_t opid);
 
-    void Push(Desc* desc) {
-      ASSERT(index < 255, "index out of range");
+  BasicTransList(Allocator<Node>* nodeAllocator,
+                 Allocator<Desc>* descAllocator,
+                 Allocator<NodeDesc>* nodeDescAllocator,
+                 const Compare& compare = Compare());
+  ~BasicTransList();
 
-      helps[index++] = desc;
-    }
+  bool ExecuteOps(Desc* desc);
 
-    void Pop() {
-      ASSERT(index > 0, "nothing to pop");
+  Desc* AllocateDesc(uint32_t size);
 
-      index--;
-    }
+  void SetOwner(void* owner, HelpFn help) {
+    m_owner = owner;
+    m_help = help;
+  }
 
-    bool Contain(Desc* desc) {
-      for (uint8_t i = 0; i < index; i++) {
-        if (helps[i] == desc) {
-          return true;
-        }
-      }
+  // Runs op opid of desc on this list alone, for the owner of a shared Desc.
+  // Returns false if the op failed.
+  bool ExecuteOp(Desc* desc, uint32_t opid);
 
-      return false;
-    }
+  static size_t DynamicSizeOf(uint32_t size) {
+    return Desc::SizeOf(size) + sizeof(Program) + sizeof(Step) * size;
+  }
 
-    Desc* helps[256];
-    uint8_t index;
-  };
+  static Program* GetProgram(Desc* desc) {
+    return reinterpret_cast<Program*>(&desc->ops[desc->size]);
+  }
 
-  TransList(Allocator<Node>* nodeAllocator, Allocator<Desc>* descAllocator,
-            Allocator<NodeDesc>* nodeDescAllocator);
-  ~TransList();
+  // Runs a dynamic transaction: desc is laid out by DynamicSizeOf, and each
+  // op has a Step saying which earlier result it waits on. Ops whose guard
+  // does not hold are skipped, and ops that fail do not abort, so the ops
+  // that run are picked from results as the transaction goes. Helpers read
+  // the results from the Desc and take the same path. An op also sees what
+  // earlier ops of the transaction did to its key. The results are left in
+  // the steps.
+  //
+  // A dynamic transaction only aborts when it is in a help cycle. In
+  // wait-free mode such a cycle aborts the younger transaction, and an
+  // aborted one is rerun on a fresh copy of desc that keeps its age, so it
+  // commits once the transactions older than it are done. desc then points
+  // at the copy that committed. The descriptor allocator has to hand out
+  // DynamicSizeOf sized blocks, and lists with an owner are not supported.
+  bool ExecuteDynamic(Desc*& desc, bool waitFree);
 
-  bool ExecuteOps(Desc* desc);
+  Metrics GetMetrics();
+
+  TraversalStats GetTraversalStats() const { return m_traversal.Sum(); }
 
-  Desc* AllocateDesc(uint8_t size);
+  MemoryStats GetMemoryStats();
 
-  void ResetMetrics();
+  // Number of keys, as of one instant between the call and its return. Kept
+  // by ExecuteOps and ExecuteDynamic, and by the owner for lists that have
+  // one.
+  uint64_t Size() const { return m_size.Read(); }
+
+  SizeCounter<Desc>& GetSizeCounter() { return m_size; }
 
  private:
-  ReturnCode Insert(uint32_t key, Desc* desc, uint8_t opid, Node*& inserted,
+  ReturnCode Insert(const Key& key, Desc* desc, uint32_t opid, Node*& inserted,
                     Node*& pred);
-  ReturnCode Delete(uint32_t key, Desc* desc, uint8_t opid, Node*& deleted,
+  ReturnCode Delete(const Key& key, Desc* desc, uint32_t opid, Node*& deleted,
                     Node*& pred);
-  ReturnCode Find(uint32_t key, Desc* desc, uint8_t opid);
-
-  void HelpOps(Desc* desc, uint8_t opid);
+  ReturnCode Find(const Key& key, Desc* desc, uint32_t opid);
+
+  void HelpOps(Desc* desc, uint32_t opid);
+  void HelpDynamic(Desc* desc, uint32_t opid);
+  void RunStep(Desc* desc, uint32_t opid);
+  void SaveResult(NodeDesc* nodeDesc);
+  bool IsGuardOpen(Program* program, const Step& step);
+  bool IsPresentAfter(NodeDesc* nodeDesc);
+  bool IsOlder(Desc* desc1, Desc* desc2);
+  void AbortCycle(Desc* desc);
   bool IsSameOperation(NodeDesc* nodeDesc1, NodeDesc* nodeDesc2);
   void FinishPendingTxn(NodeDesc* nodeDesc, Desc* desc);
-  bool IsNodeExist(Node* node, uint32_t key);
+  bool IsNodeExist(Node* node, const Key& key);
   bool IsNodeActive(NodeDesc* nodeDesc);
   bool IsKeyExist(NodeDesc* nodeDesc);
-  void LocatePred(Node*& pred, Node*& curr, uint32_t key);
+  bool IsBefore(Node* node, const Key& key);
+  void LocatePred(Node*& pred, Node*& curr, const Key& key);
   void MarkForDeletion(const std::vector<Node*>& nodes,
                        const std::vector<Node*>& preds, Desc* desc);
 
   void Print();
 
+  static int64_t SizeDelta(Desc* desc,
+                           const typename SizeCounter<Desc>::Share& share);
+
  private:
   Node* m_tail;
   Node* m_head;
@@ -120,6 +193,8 @@ class TransList {
   Allocator<Desc>* m_descAllocator;
   Allocator<NodeDesc>* m_nodeDescAllocator;
 
+  Compare m_compare;
+
   ASSERT_CODE(uint32_t g_count = 0; uint32_t g_count_ins = 0;
               uint32_t g_count_ins_new = 0; uint32_t g_count_del = 0;
               uint32_t g_count_del_new = 0; uint32_t g_count_fnd = 0;)
@@ -127,6 +202,35 @@ class TransList {
   uint32_t g_count_commit = 0;
   uint32_t g_count_abort = 0;
   uint32_t g_count_fake_abort = 0;
+
+  ThreadStats<TraversalStats> m_traversal;
+  SizeCounter<Desc> m_size;
+
+  void* m_owner = NULL;
+  HelpFn m_help = NULL;
+
+  uint32_t m_stamp = 0;
+
+  static thread_local HelpStack<Desc> m_helpStack;
+};
+
+typedef BasicTransList<uint32_t> TransList;
+
+// A key with a value riding along, ordered by the key alone. Lists of these
+// lay out their ops like TransSkip and BasicTransMap<uint64_t, uint64_t>, so
+// the three can share descriptors (see TransMulti). The list is still a set,
+// the values of its ops are not read back.
+struct TransListEntry {
+  uint64_t key;
+  uint64_t value;
 };
 
+struct TransListEntryLess {
+  bool operator()(const TransListEntry& a, const TransListEntry& b) const {
+    return a.key < b.key;
+  }
+};
+
+typedef BasicTransList<TransListEntry, TransListEntryLess> TransEntryList;
+
 #endif /* end of include guard: TRANSLIST_H */
@@ -0,0 +1,398 @@
+//------------------------------------------------------------------------------
+//
+//
+//
+//------------------------------------------------------------------------------
+
+#include "translink/list/transunrolledlist.h"
+
+#include <malloc.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#define SET_MARK(_p) ((Node*)(((uintptr_t)(_p)) | 1))
+#define CLR_MARK(_p) ((Node*)(((uintptr_t)(_p)) & ~1))
+#define CLR_MARKD(_p) ((NodeDesc*)(((uintptr_t)(_p)) & ~1))
+#define IS_MARKED(_p) (((uintptr_t)(_p)) & 1)
+
+static_assert(sizeof(TransUnrolledList::Node) ==
+                  TransUnrolledList::NODE_SIZE,
+              "node must fill its cache lines exactly");
+
+TransUnrolledList::TransUnrolledList(Allocator<Node>* nodeAllocator,
+                                     Allocator<Desc>* descAllocator,
+                                     Allocator<NodeDesc>* nodeDescAllocator)
+    : m_tail(static_cast<Node*>(memalign(NODE_SIZE, sizeof(Node)))),
+      m_head(static_cast<Node*>(memalign(NODE_SIZE, sizeof(Node)))),
+      m_nodeAllocator(nodeAllocator),
+      m_descAllocator(descAllocator),
+      m_nodeDescAllocator(nodeDescAllocator) {
+  m_tail->next = NULL;
+  m_tail->count = 0;
+  m_head->next = m_tail;
+  m_head->count = 0;
+}
+
+TransUnrolledList::~TransUnrolledList() {
+  // Print();
+}
+
+TransUnrolledList::Desc* TransUnrolledList::AllocateDesc(uint32_t size) {
+  Desc* desc = m_descAllocator->Alloc();
+  desc->size = size;
+  desc->status = ACTIVE;
+
+  return desc;
+}
+
+bool TransUnrolledList::ExecuteOps(Desc* desc) { return ExecuteDesc(desc); }
+
+inline TransUnrolledList::ReturnCode TransUnrolledList::RunOp(Desc* desc,
+                                                              uint32_t opid) {
+  const Operator& op = desc->ops[opid];
+
+  if (op.type == INSERT) {
+    return Insert(op.key, desc, opid);
+  } else if (op.type == DELETE) {
+    return Delete(op.key, desc, opid);
+  } else {
+    return Find(op.key, desc, opid);
+  }
+}
+
+inline TransUnrolledList::ReturnCode TransUnrolledList::Insert(uint32_t key,
+                                                               Desc* desc,
+                                                               uint32_t opid) {
+  NodeDesc* nodeDesc = new (m_nodeDescAllocator->Alloc()) NodeDesc(desc, opid);
+  Node* spare[2] = {NULL, NULL};
+  Node* pred;
+  Node* curr;
+
+  while (true) {
+    LocatePred(pred, curr, key, spare);
+
+    int slot = FindSlot(curr, key);
+
+    if (slot < 0) {
+      if (desc->status != ACTIVE) {
+        return FAIL;
+      }
+
+      if (Replace(pred, curr, key, nodeDesc, spare)) {
+        return OK;
+      }
+
+      m_traversal.Local().restarts++;
+      continue;
+    }
+
+    NodeDesc* oldCurrDesc = curr->descs[slot];
+
+    // Frozen, the next search moves over to the copy
+    if (IS_MARKED(oldCurrDesc)) {
+      m_traversal.Local().restarts++;
+      continue;
+    }
+
+    FinishPendingTxn(oldCurrDesc, desc);
+
+    if (IsSameOperation(oldCurrDesc, nodeDesc)) {
+      return SKIP;
+    }
+
+    if (!IsKeyExist(oldCurrDesc)) {
+      if (desc->status != ACTIVE) {
+        return FAIL;
+      }
+
+      if (__sync_bool_compare_and_swap(&curr->descs[slot], oldCurrDesc,
+                                       nodeDesc)) {
+        return OK;
+      }
+    } else {
+      return FAIL;
+    }
+  }
+}
+
+inline TransUnrolledList::ReturnCode TransUnrolledList::Delete(uint32_t key,
+                                                               Desc* desc,
+                                                               uint32_t opid) {
+  NodeDesc* nodeDesc = new (m_nodeDescAllocator->Alloc()) NodeDesc(desc, opid);
+  Node* spare[2] = {NULL, NULL};
+  Node* pred;
+  Node* curr;
+
+  while (true) {
+    LocatePred(pred, curr, key, spare);
+
+    int slot = FindSlot(curr, key);
+
+    if (slot < 0) {
+      return FAIL;
+    }
+
+    NodeDesc* oldCurrDesc = curr->descs[slot];
+
+    if (IS_MARKED(oldCurrDesc)) {
+      m_traversal.Local().restarts++;
+      continue;
+    }
+
+    FinishPendingTxn(oldCurrDesc, desc);
+
+    if (IsSameOperation(oldCurrDesc, nodeDesc)) {
+      return SKIP;
+    }
+
+    if (IsKeyExist(oldCurrDesc)) {
+      if (desc->status != ACTIVE) {
+        return FAIL;
+      }
+
+      if (__sync_bool_compare_and_swap(&curr->descs[slot], oldCurrDesc,
+                                       nodeDesc)) {
+        return OK;
+      }
+    } else {
+      return FAIL;
+    }
+  }
+}
+
+inline TransUnrolledList::ReturnCode TransUnrolledList::Find(uint32_t key,
+                                                             Desc* desc,
+                                                             uint32_t opid) {
+  NodeDesc* nodeDesc = NULL;
+  Node* spare[2] = {NULL, NULL};
+  Node* pred;
+  Node* curr;
+
+  while (true) {
+    LocatePred(pred, curr, key, spare);
+
+    int slot = FindSlot(curr, key);
+
+    if (slot < 0) {
+      return FAIL;
+    }
+
+    NodeDesc* oldCurrDesc = curr->descs[slot];
+
+    if (IS_MARKED(oldCurrDesc)) {
+      m_traversal.Local().restarts++;
+      continue;
+    }
+
+    FinishPendingTxn(oldCurrDesc, desc);
+
+    if (nodeDesc == NULL)
+      nodeDesc = new (m_nodeDescAllocator->Alloc()) NodeDesc(desc, opid);
+
+    if (IsSameOperation(oldCurrDesc, nodeDesc)) {
+      return SKIP;
+    }
+
+    if (IsKeyExist(oldCurrDesc)) {
+      if (desc->status != ACTIVE) {
+        return FAIL;
+      }
+
+      if (__sync_bool_compare_and_swap(&curr->descs[slot], oldCurrDesc,
+                                       nodeDesc)) {
+        return OK;
+      }
+    } else {
+      return FAIL;
+    }
+  }
+}
+
+// Slot of key in node, or -1 when the node does not hold it
+inline int TransUnrolledList::FindSlot(Node* node, uint32_t key) {
+  for (uint32_t i = 0; i < node->count && node->keys[i] <= key; i++) {
+    if (node->keys[i] == key) {
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+// Leaves curr at the node that covers key: the first one whose largest key
+// is not below it, or the last one. curr is the tail only while the list is
+// empty. Frozen nodes met on the way are replaced first, so curr was not
+// frozen when it was read.
+inline void TransUnrolledList::LocatePred(Node*& pred, Node*& curr,
+                                          uint32_t key, Node* spare[]) {
+  uint64_t visited = 0;
+  uint64_t restarts = 0;
+
+  pred = m_head;
+  curr = m_head->next;
+
+  while (curr != m_tail) {
+    Node* next = curr->next;
+
+    if (IS_MARKED(next)) {
+      if (!Replace(pred, curr, 0, NULL, spare)) {
+        // pred is frozen as well, start over to replace it first
+        restarts++;
+        pred = m_head;
+      }
+
+      curr = CLR_MARK(pred->next);
+      continue;
+    }
+
+    if (next == m_tail || curr->keys[curr->count - 1] >= key) {
+      break;
+    }
+
+    pred = curr;
+    curr = next;
+    visited++;
+  }
+
+  TraversalStats& stats = m_traversal.Local();
+  stats.searches++;
+  stats.visited += visited;
+  stats.restarts += restarts;
+}
+
+// Marks the next pointer and then every slot, after which the node no longer
+// changes
+inline void TransUnrolledList::Freeze(Node* node) {
+  if (!IS_MARKED(node->next)) {
+    __sync_fetch_and_or((uintptr_t*)&node->next, 1);
+  }
+
+  for (uint32_t i = 0; i < node->count; i++) {
+    if (!IS_MARKED(node->descs[i])) {
+      __sync_fetch_and_or((uintptr_t*)&node->descs[i], 1);
+    }
+  }
+}
+
+// Swings pred over from curr to a copy of it, with key added when nodeDesc
+// is set. The copy is split in two when the keys do not fit one node. Nodes
+// of a failed try are kept in spare for the next one.
+inline bool TransUnrolledList::Replace(Node* pred, Node* curr, uint32_t key,
+                                       NodeDesc* nodeDesc, Node* spare[]) {
+  uint32_t keys[SLOTS + 1];
+  NodeDesc* descs[SLOTS + 1];
+  uint32_t count = 0;
+  bool added = nodeDesc == NULL;
+  Node* next = m_tail;
+
+  if (curr != m_tail) {
+    Freeze(curr);
+
+    for (uint32_t i = 0; i < curr->count; i++) {
+      if (!added && key < curr->keys[i]) {
+        keys[count] = key;
+        descs[count++] = nodeDesc;
+        added = true;
+      }
+
+      keys[count] = curr->keys[i];
+      descs[count++] = CLR_MARKD(curr->descs[i]);
+    }
+
+    next = CLR_MARK(curr->next);
+  }
+
+  if (!added) {
+    keys[count] = key;
+    descs[count++] = nodeDesc;
+  }
+
+  uint32_t split = count > SLOTS ? count / 2 : count;
+
+  for (uint32_t n = 0, begin = 0; begin < count; n++) {
+    if (spare[n] == NULL) {
+      spare[n] = m_nodeAllocator->Alloc();
+    }
+
+    uint32_t end = begin == 0 ? split : count;
+    Node* node = spare[n];
+
+    node->count = end - begin;
+
+    for (uint32_t i = begin; i < end; i++) {
+      node->keys[i - begin] = keys[i];
+      node->descs[i - begin] = descs[i];
+    }
+
+    begin = end;
+  }
+
+  if (split < count) {
+    spare[0]->next = spare[1];
+    spare[1]->next = next;
+  } else {
+    spare[0]->next = next;
+  }
+
+  if (__sync_bool_compare_and_swap(&pred->next, curr, spare[0])) {
+    spare[0] = NULL;
+
+    if (split < count) {
+      spare[1] = NULL;
+    }
+
+    return true;
+  }
+
+  return false;
+}
+
+inline void TransUnrolledList::Print() {
+  Node* curr = m_head->next;
+
+  while (curr != m_tail) {
+    for (uint32_t i = 0; i < curr->count; i++) {
+      printf("Node [%p] Key [%u] Status [%s]\n", curr, curr->keys[i],
+             IsKeyExist(CLR_MARKD(curr->descs[i])) ? "Exist" : "Inexist");
+    }
+
+    curr = CLR_MARK(curr->next);
+  }
+}
+
+MemoryStats TransUnrolledList::GetMemoryStats() {
+  MemoryStats stats = {};
+
+  for (Node* curr = m_head->next; curr != m_tail;
+       curr = CLR_MARK(curr->next)) {
+    for (uint32_t i = 0; i < curr->count; i++) {
+      if (IsKeyExist(CLR_MARKD(curr->descs[i]))) {
+        stats.liveNodes++;
+      } else {
+        stats.deletedNodes++;
+      }
+    }
+  }
+
+  stats.descriptors = m_descAllocator->Allocated();
+
+  // The sentinels come from the heap, everything else from the pools
+  stats.AddHeap(2 * sizeof(Node));
+  stats.AddPool(m_nodeAllocator);
+  stats.AddPool(m_descAllocator);
+  stats.AddPool(m_nodeDescAllocator);
+
+  return stats;
+}
+
+Metrics TransUnrolledList::GetMetrics() {
+  Metrics metrics = {g_count_commit, g_count_abort, g_count_fake_abort};
+
+  metrics.parts = METRICS_TRAVERSAL | METRICS_MEMORY;
+  metrics.traversal = m_traversal.Sum();
+  metrics.memory = GetMemoryStats();
+
+  return metrics;
+}
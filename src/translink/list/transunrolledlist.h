@@ -0,0 +1,95 @@
+#ifndef TRANSUNROLLEDLIST_H
+#define TRANSUNROLLEDLIST_H
+
+#include <cstdint>
+
+#include "common/allocator.h"
+#include "common/assert.h"
+#include "common/memstats.h"
+#include "common/metrics.h"
+#include "common/threadstats.h"
+#include "translink/transbase.h"
+
+// Unrolled variant of TransList: every node holds a small sorted array of
+// keys, each with its own NodeDesc, so a search reads one cache line per
+// SLOTS keys instead of one per key. Transactions change the NodeDesc of a
+// slot in place with the same CAS as TransList.
+//
+// The keys of a node never change. A new key goes in by freezing the node
+// that covers it, marking its next pointer and every slot, and swinging the
+// predecessor over to a copy holding the new key too, split in two when it
+// does not fit. A frozen slot fails the CAS of any transaction that read it
+// before the freeze, which then finds the key in the copy. A thread running
+// into a frozen node replaces it with a plain copy before going on, so the
+// list never waits on a stalled inserter. Like the other translink
+// structures keys are never removed, a delete only changes the logical
+// status of a slot.
+class TransUnrolledList : public TransBase<TransUnrolledList> {
+ public:
+  struct Operator {
+    uint8_t type;
+    uint32_t key;
+  };
+
+  typedef TransDesc<Operator> Desc;
+  typedef TransNodeDesc<Desc> NodeDesc;
+
+  // A node fills two cache lines, the search only reads the first: the next
+  // pointer, the count and the largest key
+  static const uint32_t NODE_SIZE = 2 * CACHE_LINE_SIZE;
+  static const uint32_t SLOTS =
+      (NODE_SIZE - sizeof(void*) - sizeof(uint32_t)) /
+      (sizeof(uint32_t) + sizeof(NodeDesc*));
+
+  struct Node {
+    Node* volatile next;
+    uint32_t count;
+    uint32_t keys[SLOTS];
+    NodeDesc* volatile descs[SLOTS];
+  } __attribute__((aligned(CACHE_LINE_SIZE)));
+
+  TransUnrolledList(Allocator<Node>* nodeAllocator,
+                    Allocator<Desc>* descAllocator,
+                    Allocator<NodeDesc>* nodeDescAllocator);
+  ~TransUnrolledList();
+
+  bool ExecuteOps(Desc* desc);
+
+  Desc* AllocateDesc(uint32_t size);
+
+  Metrics GetMetrics();
+
+  TraversalStats GetTraversalStats() const { return m_traversal.Sum(); }
+
+  MemoryStats GetMemoryStats();
+
+ private:
+  friend class TransBase<TransUnrolledList>;
+
+  ReturnCode RunOp(Desc* desc, uint32_t opid);
+  ReturnCode Insert(uint32_t key, Desc* desc, uint32_t opid);
+  ReturnCode Delete(uint32_t key, Desc* desc, uint32_t opid);
+  ReturnCode Find(uint32_t key, Desc* desc, uint32_t opid);
+
+
+  int FindSlot(Node* node, uint32_t key);
+  void LocatePred(Node*& pred, Node*& curr, uint32_t key, Node* spare[]);
+  void Freeze(Node* node);
+  bool Replace(Node* pred, Node* curr, uint32_t key, NodeDesc* nodeDesc,
+               Node* spare[]);
+
+  void Print();
+
+ private:
+  // Sentinels without keys, neither is ever frozen
+  Node* m_tail;
+  Node* m_head;
+
+  Allocator<Node>* m_nodeAllocator;
+  Allocator<Desc>* m_descAllocator;
+  Allocator<NodeDesc>* m_nodeDescAllocator;
+
+  ThreadStats<TraversalStats> m_traversal;
+};
+
+#endif /* end of include guard: TRANSUNROLLEDLIST_H */
@@ -4,23 +4,32 @@
 #include <cstdlib>
 #include <new>
 
-#define SET_MARK(_p) ((Node*)(((uintptr_t)(_p)) | 1))
-#define CLR_MARK(_p) ((Node*)(((uintptr_t)(_p)) & ~1))
-#define CLR_MARKD(_p) ((NodeDesc*)(((uintptr_t)(_p)) & ~1))
-#define IS_MARKED(_p) (((uintptr_t)(_p)) & 1)
-
-__thread TransMap::HelpStack mapHelpStack;
-// TODO: make __thread std::vector<VALUE> toR; where each thread can put the
-// results of its find operations and return them to the user
-// TODO: this would have to be made to work even if other threads helped,
-// similarly to the update mechanism
-bool TransMap::ExecuteOps(Desc* desc,
-                          int threadId)  //, std::vector<VALUE> &toR)
+template <typename Key, typename Value>
+thread_local HelpStack<typename BasicTransMap<Key, Value>::Desc>
+    BasicTransMap<Key, Value>::m_helpStack;
+
+// The value found by each FIND is left in its op, see SaveFound, and the
+// value each FETCH_ADD or UPSERT started from in its Prior slot
+template <typename Key, typename Value>
+bool BasicTransMap<Key, Value>::ExecuteOps(
+    Desc* desc,
+    int threadId)  //, std::vector<VALUE> &toR)
 {
-  mapHelpStack.Init();
+  m_helpStack.Init();
+
+  // The insert paths of an UPSERT leave its flag alone
+  for (uint32_t i = 0; i < desc->size; ++i) {
+    if (desc->ops[i].type == MAP_UPSERT) {
+      Missing(desc)[i] = true;
+    }
+  }
+
+  m_size.Begin(desc);
 
   HelpOps(desc, 0, threadId);  //, toR);
 
+  m_size.End();
+
   bool ret = desc->status != MAP_ABORTED;
 
   ASSERT_CODE(if (ret) {
@@ -29,7 +38,9 @@ bool TransMap::ExecuteOps(Desc* desc,
         __sync_fetch_and_add(&g_count, 1);
       } else if (desc->ops[i].type == MAP_DELETE) {
         __sync_fetch_and_sub(&g_count, 1);
-      } else if (desc->ops[i].type == MAP_UPDATE) {
+      } else if (desc->ops[i].type == MAP_UPSERT && Missing(desc)[i]) {
+        __sync_fetch_and_add(&g_count, 1);
+      } else if (desc->ops[i].type != MAP_FIND) {
         __sync_fetch_and_add(&g_count_upd, 1);
       } else
         __sync_fetch_and_add(&g_count_fnd, 1);
@@ -39,15 +50,46 @@ bool TransMap::ExecuteOps(Desc* desc,
   return ret;
 }
 
-inline void TransMap::HelpOps(Desc* desc, uint8_t opid,
-                              int T)  //, std::vector<VALUE> &toR)
+// Net number of keys the share of desc added once committed. An UPSERT adds
+// one when its Missing flag says so, which its helpers settle before the
+// commit.
+template <typename Key, typename Value>
+int64_t BasicTransMap<Key, Value>::SizeDelta(
+    Desc* desc, const typename SizeCounter<Desc>::Share& share) {
+  if (desc->status != MAP_COMMITTED) {
+    return 0;
+  }
+
+  int64_t delta = 0;
+
+  for (uint32_t i = 0; i < desc->size; ++i) {
+    if (!share.Counts(desc, i)) {
+      continue;
+    }
+
+    if (desc->ops[i].type == MAP_INSERT) {
+      delta++;
+    } else if (desc->ops[i].type == MAP_DELETE) {
+      delta--;
+    } else if (desc->ops[i].type == MAP_UPSERT && Missing(desc)[i]) {
+      delta++;
+    }
+  }
+
+  return delta;
+}
+
+template <typename Key, typename Value>
+void BasicTransMap<Key, Value>::HelpOps(
+    Desc* desc, uint32_t opid,
+    int T)  //, std::vector<VALUE> &toR)
 {
   if (desc->status != MAP_ACTIVE) {
     return;  // return NULL;
   }
 
   // Cyclic dependcy check
-  if (mapHelpStack.Contain(desc)) {
+  if (m_helpStack.Contain(desc)) {
     if (__sync_bool_compare_and_swap(&desc->status, MAP_ACTIVE, MAP_ABORTED)) {
       __sync_fetch_and_add(&g_count_abort, 1);
       __sync_fetch_and_add(&g_count_fake_abort, 1);
@@ -60,7 +102,7 @@ inline void TransMap::HelpOps(Desc* desc, uint8_t opid,
   // td::vector<DataNode*> retVector;
   // std::vector<VALUE> foundValues;
 
-  mapHelpStack.Push(desc);
+  m_helpStack.Push(desc);
 
   while (desc->status == MAP_ACTIVE && ret != false && opid < desc->size) {
     const Operator& op = desc->ops[opid];
@@ -76,24 +118,21 @@ inline void TransMap::HelpOps(Desc* desc, uint8_t opid,
       ret = Update(desc, opid, op.key, op.value, T);  //, toRet);
       // the pointer is copied into the vector
       // retVector.push_back(toRet);
+    } else if (op.type == MAP_FETCH_ADD || op.type == MAP_CAS) {
+      // the new value comes from the NodeDesc, see ReadPrior
+      ret = Update(desc, opid, op.key, op.value, T);
+    } else if (op.type == MAP_UPSERT) {
+      ret = Upsert(desc, opid, op.key, op.value, T);
     } else {
-      // ret = Find(op.key, desc, opid);
-      // if find is successful it returns a non-null value
-      VALUE retVal = Find(desc, opid, op.key, T);
-
-      if (retVal == (VALUE)NULL)
-        ret = false;
-      else
-        ret = true;
-      // if (retVal != 0)
-      // toR.push_back(retVal);//foundValues.push_back(retVal);
-      // TODO: edit helpops to return an array of values?
+      // if find is successful it returns a non-null value, which it also left
+      // in op.value for the caller
+      ret = Find(desc, opid, op.key, T) != (Value)NULL;
     }
 
     opid++;
   }
 
-  mapHelpStack.Pop();
+  m_helpStack.Pop();
 
   if (ret != false) {
     // // any concurrent txn will see that ours is live and not use/modify our
@@ -154,4 +193,7 @@ inline void TransMap::HelpOps(Desc* desc, uint8_t opid,
     }
     return;  // return NULL;
   }
-}
\ No newline at end of file
+}
+
+template class BasicTransMap<uint32_t, uint32_t>;
+template class BasicTransMap<uint64_t, uint64_t>;
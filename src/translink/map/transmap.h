@@ -7,17 +7,23 @@
 
 #include <cmath>
 #include <cstdint>
+#include <cstring>
 #include <iomanip>
 #include <iostream>
+#include <type_traits>
 #include <vector>
 
 #include "common/allocator.h"
 #include "common/assert.h"
+#include "common/helpstack.h"
+#include "common/memstats.h"
+#include "common/metrics.h"
+#include "common/sizecounter.h"
+#include "common/tablestats.h"
+#include "common/threadstats.h"
 
 #define USE_MEM_POOL
 
-#define HASH unsigned int
-#define KEY_SIZE 32
 #define toHash 5
 #ifndef SUB_POW
 #define SUB_POW 6  // TODO:note subspine size
@@ -25,11 +31,31 @@
 
 #define MAX_CAS_FAILURE 10
 
-// template <class KEY, class VALUE>//, typename _tMemory>
-#define KEY uint32_t
-#define VALUE uint32_t
-class TransMap {
+// The table stores the hash instead of the key, so a key must fit in the hash
+// and the hash must be 1:1. Keys are trivially copyable and at most 8 bytes,
+// and hash to their own bits: 4 byte keys keep the 32 bit table, larger ones
+// get a 64 bit one with deeper spines. Values are updated with a CAS, so they
+// are scalars; larger values go in by pointer. A zero value reads as a missing
+// key to FIND.
+//
+// The transaction code lives in transmap.cc, which instantiates 32 and 64 bit
+// keys and values; other key and value types need an instantiation there too.
+template <typename Key, typename Value>
+class BasicTransMap {
+  static_assert(std::is_trivially_copyable<Key>::value && sizeof(Key) <= 8,
+                "keys must be trivially copyable and fit in 8 bytes");
+  static_assert(std::is_scalar<Value>::value,
+                "values must be scalars, larger values go in by pointer");
+
  public:
+  typedef typename std::conditional<sizeof(Key) <= 4, uint32_t,
+                                    uint64_t>::type Hash;
+
+  static const int HASH_BITS = sizeof(Hash) * 8;
+
+  // Deepest level a lookup can reach, counting the main array as level 0
+  static const int MAX_DEPTH = 1 + (HASH_BITS + SUB_POW - 1) / SUB_POW;
+
   // inline bool	isSpine(void *s);
   // inline void * /* volatile  */ * unmark_spine(void *s);
   // inline void *  mark_spine(void * /* volatile  */ *s);
@@ -48,78 +74,95 @@ class TransMap {
   //        FAIL
   //    };
 
-  enum OpType { MAP_FIND = 0, MAP_INSERT, MAP_DELETE, MAP_UPDATE };
+  // FETCH_ADD, CAS and UPSERT read and write a key in one op, see Prior
+  enum OpType {
+    MAP_FIND = 0,
+    MAP_INSERT,
+    MAP_DELETE,
+    MAP_UPDATE,
+    MAP_FETCH_ADD,
+    MAP_CAS,
+    MAP_UPSERT
+  };
 
   struct Operator {
     uint8_t type;
-    uint32_t key;
-    uint32_t value;
+    Key key;
+    // For FIND, the value found once the transaction commits. For FETCH_ADD,
+    // the amount added.
+    Value value;
   };
 
   struct Desc {
-    static size_t SizeOf(uint8_t size) {
-      return sizeof(uint8_t) + sizeof(uint8_t) + sizeof(Operator) * size;
+    // Operator holds 32 bit fields, so count the padding in front of ops too
+    static size_t SizeOf(uint32_t size) {
+      return sizeof(Desc) + sizeof(Operator) * size;
     }
 
     // Status of the transaction: values in [0, size] means live txn, values -1
     // means aborted, value -2 means committed.
     volatile uint8_t status;
-    uint8_t size;
+    // Up to 16M ops. Packed in next to status, the header is no larger than
+    // with an 8 bit size.
+    uint32_t size : 24;
     Operator ops[];
   };
 
   struct NodeDesc {
-    NodeDesc(Desc *_desc, uint8_t _opid) : desc(_desc), opid(_opid) {}
+    NodeDesc(Desc *_desc, uint32_t _opid)
+        : desc(_desc), opid(_opid), value(0), missing(true) {}
 
     Desc *desc;
-    uint8_t opid;
+    uint32_t opid;
+    // For a FIND, the value it read, for a FETCH_ADD, CAS or UPSERT the value
+    // before it. Set before the NodeDesc is published, so every thread
+    // helping the op copies out the same result.
+    Value value;
+    // For an UPSERT, whether the key was missing before it. A value of 0
+    // does not tell, as CAS and FETCH_ADD can store 0.
+    bool missing;
   };
 
+  // Descs holding FETCH_ADD, CAS or UPSERT ops need room for a Prior slot and
+  // a Missing flag per op behind the ops
+  static size_t RmwSizeOf(uint32_t size) {
+    return Desc::SizeOf(size) + (sizeof(Value) + sizeof(bool)) * size;
+  }
+
+  // A CAS fails unless the key holds the value in its slot. A FETCH_ADD or
+  // UPSERT leaves there the value the key had before it, 0 if it was missing.
+  static Value *Prior(Desc *desc) {
+    return reinterpret_cast<Value *>(&desc->ops[desc->size]);
+  }
+
+  // Whether each UPSERT found its key missing, and so added it. ExecuteOps
+  // sets them before the ops run.
+  static bool *Missing(Desc *desc) {
+    return reinterpret_cast<bool *>(&Prior(desc)[desc->size]);
+  }
+
   typedef struct {
     union {
-      HASH hash;
+      Hash hash;
       void *next;
     };
 #ifdef USE_KEY
-    KEY key; /*For debugging */
+    Key key; /*For debugging */
 #endif
 
-    VALUE value;
+    Value value;
 
     NodeDesc *nodeDesc;
   } DataNode;
 
-  struct HelpStack {
-    void Init() { index = 0; }
+  // Structures built out of several maps share one Desc between them, and only
+  // the owner knows which map each op goes to. Helping then goes through it.
+  typedef void (*HelpFn)(void *owner, Desc *desc, uint32_t opid, int threadId);
 
-    void Push(Desc *desc) {
-      ASSERT(index < 255, "index out of range");
-
-      helps[index++] = desc;
-    }
-
-    void Pop() {
-      ASSERT(index > 0, "nothing to pop");
-
-      index--;
-    }
-
-    bool Contain(Desc *desc) {
-      for (uint8_t i = 0; i < index; i++) {
-        if (helps[i] == desc) {
-          return true;
-        }
-      }
-
-      return false;
-    }
-
-    Desc *helps[256];
-    uint8_t index;
-  };
+  static_assert(MAX_DEPTH <= TABLE_MAX_DEPTH, "TableStats is too shallow");
 
 #ifdef useThreadWatch
-  HASH * /* volatile  */ Thread_watch;
+  Hash * /* volatile  */ Thread_watch;
 #endif
 #ifdef useVectorPool
 
@@ -137,20 +180,20 @@ class TransMap {
 
   void * /* volatile  */ *head;
   /* volatile  */ unsigned int elements;
-#ifdef SPINE_COUNT
-  /* volatile  */ unsigned int spine_elements;
-#endif
+  // Data nodes obtained from the heap, pooled ones included
+  unsigned int node_allocations;
 
-  TransMap(/*Allocator<Node>* nodeAllocator,*/ Allocator<TransMap::Desc>
-               *descAllocator,
-           Allocator<TransMap::NodeDesc> *nodeDescAllocator,
-           uint64_t initalPowerOfTwo, uint64_t numThreads)
+  BasicTransMap(/*Allocator<Node>* nodeAllocator,*/ Allocator<Desc>
+                    *descAllocator,
+                Allocator<NodeDesc> *nodeDescAllocator,
+                uint64_t initalPowerOfTwo, uint64_t numThreads)
       : m_descAllocator(descAllocator)  // m_nodeAllocator(nodeAllocator),
         ,
-        m_nodeDescAllocator(nodeDescAllocator)
+        m_nodeDescAllocator(nodeDescAllocator),
+        m_size(SizeDelta)
   // WaitFreeHashTable(int initalPowerOfTwo, int numThreads)
   {
-    MAIN_SIZE = TransMap::POW(((int)std::ceil(std::log2(initalPowerOfTwo))));
+    MAIN_SIZE = POW(((int)std::ceil(std::log2(initalPowerOfTwo))));
     MAIN_POW = ((int)std::ceil(std::log2(initalPowerOfTwo)));
     Threads = numThreads;
     assert(Threads > 0);
@@ -158,7 +201,7 @@ class TransMap {
                                             sizeof(void * /* volatile  */));
 
 #ifdef useThreadWatch
-    Thread_watch = (HASH * /* volatile  */) calloc(Threads, sizeof(HASH));
+    Thread_watch = (Hash * /* volatile  */) calloc(Threads, sizeof(Hash));
 #endif
     Thread_pool_stack = (void **)calloc(Threads, sizeof(void *));
 #ifdef useVectorPool
@@ -172,18 +215,14 @@ class TransMap {
     Thread_spines = (void **)calloc(Threads, sizeof(void *));
 
     elements = 0;
-#ifdef SPINE_COUNT
-    spine_elements = 0;
-#endif
+    node_allocations = 0;
 // v_capacity=MAIN_SIZE;
 #ifdef DEBUGPRINTS_MARK
     printf("DEBUGPRINTS_MARK output enabled\n");
 #endif
   }
 
-  ~TransMap() {
-    printf("Total commit %u, abort (total/fake) %u/%u\n", g_count_commit,
-           g_count_abort, g_count_fake_abort);
+  ~BasicTransMap() {
     // Print();
 
     // NOTE: counts are not incremented with correct semantics in any method
@@ -221,9 +260,9 @@ class TransMap {
   /**
    Hash function must only reorder bits! it must be 1:1
    **/
-  inline HASH HASH_KEY(KEY k) {
+  inline Hash HASH_KEY(Key k) {
 #if toHash == 1
-    HASH x = k;
+    Hash x = k;
     // XY
     register unsigned int y = 0x55555555;
 
@@ -254,12 +293,19 @@ class TransMap {
     return ((k & 0xFFFF0000) >> 16) + ((k & 0x0000FFFF) << 16);
 
 #else
-    return (HASH)k;
+    Hash h = 0;
+    memcpy(&h, &k, sizeof(Key));
+    return h;
 #endif
   }
 
   bool ExecuteOps(Desc *desc, int threadId);
 
+  void SetOwner(void *owner, HelpFn help) {
+    m_owner = owner;
+    m_help = help;
+  }
+
   //////////////////////////////////////////////////////////////////////////////////
   //////////////////////////////////////////////////////////////////////////////////
   ///////////////////////////////Bit Marking
@@ -301,12 +347,93 @@ class TransMap {
     __sync_fetch_and_or(&(s[pos]), 2);
   }
 
-  inline int getMAINPOS(HASH hash) { return hash & (MAIN_SIZE - 1); };
+  inline int getMAINPOS(Hash hash) { return hash & (MAIN_SIZE - 1); };
+
+  inline Value GetValue(NodeDesc *oldCurrDesc) {
+    if (oldCurrDesc->desc->ops[oldCurrDesc->opid].type == MAP_FIND) {
+      return oldCurrDesc->value;
+    }
+
+    if (oldCurrDesc->desc->ops[oldCurrDesc->opid].type == MAP_FETCH_ADD) {
+      return oldCurrDesc->value +
+             oldCurrDesc->desc->ops[oldCurrDesc->opid].value;
+    }
 
-  inline VALUE GetValue(NodeDesc *oldCurrDesc) {
     return oldCurrDesc->desc->ops[oldCurrDesc->opid].value;
   }
 
+  // Value a FIND reads from a node whose NodeDesc is oldCurrDesc
+  inline Value ReadValue(DataNode *node, NodeDesc *oldCurrDesc) {
+    // if this txn did an update here, then use that value
+    if (IsLiveUpdate(oldCurrDesc)) {
+      return GetValue(oldCurrDesc);
+    }
+
+    // if it's not a live update then use the value at the node
+    return node->value;
+  }
+
+  // Hands the result of a FIND to the caller through its slot in the Desc.
+  // Helpers may do this more than once, always with the same value.
+  inline Value SaveFound(NodeDesc *nodeDesc) {
+    nodeDesc->desc->ops[nodeDesc->opid].value = nodeDesc->value;
+    return nodeDesc->value;
+  }
+
+  // Reads the value a FETCH_ADD, CAS or UPSERT starts from into its NodeDesc,
+  // before it replaces oldCurrDesc. Fails a CAS that does not find the value
+  // it expects.
+  inline bool ReadPrior(NodeDesc *nodeDesc, DataNode *node,
+                        NodeDesc *oldCurrDesc) {
+    uint8_t opType = nodeDesc->desc->ops[nodeDesc->opid].type;
+
+    if (opType == MAP_UPDATE) {
+      return true;
+    }
+
+    nodeDesc->value = ReadValue(node, oldCurrDesc);
+    nodeDesc->missing = false;
+
+    return opType != MAP_CAS ||
+           nodeDesc->value == Prior(nodeDesc->desc)[nodeDesc->opid];
+  }
+
+  // Hands the value a FETCH_ADD or UPSERT started from to the caller, and
+  // whether an UPSERT found its key. As with SaveFound, only a published
+  // NodeDesc is saved.
+  inline bool SavePrior(NodeDesc *nodeDesc) {
+    uint8_t opType = nodeDesc->desc->ops[nodeDesc->opid].type;
+
+    if (opType == MAP_FETCH_ADD || opType == MAP_UPSERT) {
+      Prior(nodeDesc->desc)[nodeDesc->opid] = nodeDesc->value;
+    }
+
+    if (opType == MAP_UPSERT) {
+      Missing(nodeDesc->desc)[nodeDesc->opid] = nodeDesc->missing;
+    }
+
+    return true;
+  }
+
+  // FETCH_ADD and CAS change a key that is there, they never add one
+  inline bool NeedsKey(NodeDesc *nodeDesc) {
+    uint8_t opType = nodeDesc->desc->ops[nodeDesc->opid].type;
+    return opType == MAP_FETCH_ADD || opType == MAP_CAS;
+  }
+
+  // Updates the key if it is there and inserts it if not. Each attempt either
+  // publishes the op or leaves the key as it found it, so it is safe to go
+  // back and forth while other transactions add and remove the key.
+  inline bool Upsert(Desc *desc, uint32_t opid, Key k, Value v, int T) {
+    while (desc->status == MAP_ACTIVE) {
+      if (Update(desc, opid, k, v, T) || Insert(desc, opid, k, v, T)) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
   // private:
   // inline bool putIfAbsent_main(HASH hash,DataNode *temp_bucket, int T,
   // NodeDesc* nodeDesc); inline bool putIfAbsent_sub(void* /* volatile  */*
@@ -401,7 +528,7 @@ class TransMap {
   // TODO: make sure that nodedesc is updated before all low-level data node
   // manipulations
 
-  inline bool Insert(Desc *desc, uint8_t opid, KEY k, VALUE v, int T) {
+  inline bool Insert(Desc *desc, uint32_t opid, Key k, Value v, int T) {
     // inserted = NULL;
 
 #ifdef USE_MEM_POOL
@@ -413,7 +540,7 @@ class TransMap {
     nodeDesc->opid = opid;
 #endif
 
-    HASH hash = HASH_KEY(
+    Hash hash = HASH_KEY(
         k);  // reorders the bits in the key to more evenly distribute the bits
 #ifdef useThreadWatch
     Thread_watch[T] = hash;  // Puts the hash in the watchlist
@@ -440,7 +567,7 @@ class TransMap {
     return res;
   }
 
-  inline bool putIfAbsent_main(Desc *desc, HASH hash, DataNode *temp_bucket,
+  inline bool putIfAbsent_main(Desc *desc, Hash hash, DataNode *temp_bucket,
                                int T, NodeDesc *nodeDesc) {
     // This count bounds the number of times the thread will loop as a result of
     // CAS failure.
@@ -517,7 +644,7 @@ class TransMap {
           FinishPendingTxn(oldCurrDesc, desc, T);
 
           if (IsSameOperation(oldCurrDesc, nodeDesc)) {
-            return true;
+            return SavePrior(oldCurrDesc);
           }
 
           // the key that we wanted to insert is already in there, so fail
@@ -602,10 +729,10 @@ class TransMap {
                               DataNode *temp_bucket, int T,
                               NodeDesc *nodeDesc) {
   insert_sub:
-    HASH h = (temp_bucket->hash) >>
+    Hash h = (temp_bucket->hash) >>
              MAIN_POW;  // Shifts the hash to move the siginifcant bits to the
                         // right most position
-    for (int right = MAIN_POW; right < KEY_SIZE; right += SUB_POW) {
+    for (int right = MAIN_POW; right < HASH_BITS; right += SUB_POW) {
       int pos = h & (SUB_SIZE - 1);  // Gets the sig bits from the hash
 #ifdef DEBUG
       assert(pos >= 0 && pos < SUB_SIZE);  // Check to make sure pos is valid
@@ -653,7 +780,7 @@ class TransMap {
               FinishPendingTxn(oldCurrDesc, desc, T);
 
               if (IsSameOperation(oldCurrDesc, nodeDesc)) {
-                return true;
+                return SavePrior(oldCurrDesc);
               }
 
               if (IsKeyExist(oldCurrDesc))
@@ -737,7 +864,7 @@ class TransMap {
             FinishPendingTxn(oldCurrDesc, desc, T);
 
             if (IsSameOperation(oldCurrDesc, nodeDesc)) {
-              return true;
+              return SavePrior(oldCurrDesc);
             }
 
             if (IsKeyExist(oldCurrDesc))
@@ -810,7 +937,7 @@ class TransMap {
   // workthread inline bool Insert(Desc* desc, uint8_t opid, KEY k, VALUE v, int
   // T)
   inline bool Update(
-      Desc *desc, uint8_t opid, KEY k, /*VALUE e_value,*/ VALUE v,
+      Desc *desc, uint32_t opid, Key k, /*Value e_value,*/ Value v,
       int T) {  //, DataNode*& toreturn){//T is the executing thread's ID
 /*if(e_value==v)
         return true;*/
@@ -823,7 +950,7 @@ class TransMap {
     nodeDesc->opid = opid;
 #endif
 
-    HASH hash = HASH_KEY(
+    Hash hash = HASH_KEY(
         k);  // reorders the bits in the key to more evenly distribute the bits
 #ifdef useThreadWatch
     Thread_watch[T] = hash;  // Buts the hash in the watchlist
@@ -852,8 +979,8 @@ class TransMap {
     return res;
   }
 
-  inline bool putUpdate_main(Desc *desc, HASH hash,
-                             /*VALUE e_value,*/ DataNode *temp_bucket, int T,
+  inline bool putUpdate_main(Desc *desc, Hash hash,
+                             /*Value e_value,*/ DataNode *temp_bucket, int T,
                              NodeDesc *nodeDesc) {  //, DataNode*& toreturn){
 
     // This count bounds the number of times the thread will loop as a result of
@@ -907,7 +1034,7 @@ class TransMap {
           FinishPendingTxn(oldCurrDesc, desc, T);
 
           if (IsSameOperation(oldCurrDesc, nodeDesc)) {
-            return true;
+            return SavePrior(oldCurrDesc);
           }
 
           if (IsKeyExist(oldCurrDesc)) {
@@ -919,8 +1046,11 @@ class TransMap {
             }
 
             if (IsUnsavedUpdate(currDesc, ((DataNode *)node)->value)) {
-              ((DataNode *)node)->value =
-                  currDesc->desc->ops[currDesc->opid].value;
+              ((DataNode *)node)->value = GetValue(currDesc);
+            }
+
+            if (!ReadPrior(nodeDesc, (DataNode *)node, oldCurrDesc)) {
+              return false;
             }
 
             // if(currDesc == oldCurrDesc)
@@ -937,7 +1067,7 @@ class TransMap {
                 ASSERT_CODE(__sync_fetch_and_add(&g_count_ins, 1););
 
                 // toReturn = (DataNode *)node;//node;
-                return true;
+                return SavePrior(nodeDesc);
               } else  // weren't able to update the descriptor so retry
               {
                 goto update_main;  // restart, preserving fail count and
@@ -955,10 +1085,14 @@ class TransMap {
           }
           // else
           //	goto noMatch_updateMain;
+        } else if (NeedsKey(nodeDesc)) {
+          return false;  // key isn't in the table
         } else {  // Create a Spine
           // Allocate Spine will return true if it succeded, and false if it
           // failed. See Below for functionality.
           // noMatch_updateMain:
+          nodeDesc->value = 0;  // an UPSERT found the key missing
+          nodeDesc->missing = true;
           bool res = Allocate_Spine(T, head, pos, (DataNode *)node, temp_bucket,
                                     MAIN_POW);
           if (res) {
@@ -984,13 +1118,13 @@ class TransMap {
    **DONT FORGET: to do get/delete as well
    */
   inline bool putUpdate_sub(Desc *desc, void * /* volatile  */ *local,
-                            /*VALUE e_value,*/ DataNode *temp_bucket, int T,
+                            /*Value e_value,*/ DataNode *temp_bucket, int T,
                             NodeDesc *nodeDesc) {  //, DataNode*& toreturn){
   update_sub:
-    HASH h = (temp_bucket->hash) >>
+    Hash h = (temp_bucket->hash) >>
              MAIN_POW;  // Shifts the hash to move the siginifcant bits to the
                         // right most position
-    for (int right = MAIN_POW; right < KEY_SIZE; right += SUB_POW) {
+    for (int right = MAIN_POW; right < HASH_BITS; right += SUB_POW) {
       int pos = h & (SUB_SIZE - 1);  // Gets the sig bits from the hash
 #ifdef DEBUG
       assert(pos >= 0 && pos < SUB_SIZE);  // Check to make sure pos is valid
@@ -1038,7 +1172,7 @@ class TransMap {
             FinishPendingTxn(oldCurrDesc, desc, T);
 
             if (IsSameOperation(oldCurrDesc, nodeDesc)) {
-              return true;
+              return SavePrior(oldCurrDesc);
             }
 
             if (IsKeyExist(oldCurrDesc)) {
@@ -1053,8 +1187,11 @@ class TransMap {
               }
 
               if (IsUnsavedUpdate(currDesc, ((DataNode *)node)->value)) {
-                ((DataNode *)node)->value =
-                    currDesc->desc->ops[currDesc->opid].value;
+                ((DataNode *)node)->value = GetValue(currDesc);
+              }
+
+              if (!ReadPrior(nodeDesc, (DataNode *)node, oldCurrDesc)) {
+                return false;
               }
 
               // if(currDesc == oldCurrDesc)
@@ -1071,15 +1208,19 @@ class TransMap {
                   ASSERT_CODE(__sync_fetch_and_add(&g_count_ins, 1););
 
                   // toReturn = (DataNode *)node;//node;
-                  return true;
+                  return SavePrior(nodeDesc);
                 } else
                   goto update_sub;
               }
             } else {
               return false;  // key not there, can't update
             }
+          } else if (NeedsKey(nodeDesc)) {
+            return false;  // key isn't in the table
           } else {  // Create a Spine
             // noMatch_updateSub:
+            nodeDesc->value = 0;  // an UPSERT found the key missing
+            nodeDesc->missing = true;
             bool res = Allocate_Spine(T, local, pos, (DataNode *)node,
                                       temp_bucket, right + SUB_POW);
             if (res) {
@@ -1106,7 +1247,7 @@ class TransMap {
   //////////////////////////////////////////////////////////////////////////////////
   //////////////////////////////////////////////////////////////////////////////////
   /**
-  The get functions retun VALUE if the key is in the table and NULL if it is
+  The get functions retun Value if the key is in the table and NULL if it is
   not. They don't modify the table and if a data node is marked they ignore the
   marking
 
@@ -1119,7 +1260,7 @@ class TransMap {
   //  needs to be done for map interface in general in the update template
   //  pseudocode
   // inline VALUE get_first(KEY k, int T){
-  inline VALUE Find(Desc *desc, uint8_t opid, KEY k, int T) {
+  inline Value Find(Desc *desc, uint32_t opid, Key k, int T) {
 #ifdef USE_MEM_POOL
     NodeDesc *nodeDesc =
         new (m_nodeDescAllocator->Alloc()) NodeDesc(desc, opid);
@@ -1128,19 +1269,23 @@ class TransMap {
     nodeDesc->desc = desc;
     nodeDesc->opid = opid;
 #endif
-    HASH h = HASH_KEY(k);  // Reorders the bits for more even distribution
+    Hash h = HASH_KEY(k);  // Reorders the bits for more even distribution
 #ifdef useThreadWatch
     Thread_watch[T] = h;  // Adds the hash to the watchlist
 #endif
-    VALUE v = get_main(desc, h, nodeDesc, T);  // Calls the get main function
-                                               // //TODO: MemCopy?
+    int depth = 0;
+    Value v = get_main(desc, h, nodeDesc, T,
+                       depth);  // Calls the get main function
+                                // //TODO: MemCopy?
+    m_stats.Local().lookupDepth[depth]++;
 #ifdef useThreadWatch
     Thread_watch[T] = 0;  // Removes the hash from the watchlist
 #endif
     return v;
   }
 
-  inline VALUE get_main(Desc *desc, HASH hash, NodeDesc *nodeDesc, int T) {
+  inline Value get_main(Desc *desc, Hash hash, NodeDesc *nodeDesc, int T,
+                        int &depth) {
   find_main:
     int pos = getMAINPOS(hash);  //&(MAIN_SIZE-1));
 #ifdef DEBUG
@@ -1151,10 +1296,12 @@ class TransMap {
                                       // stripping bit mark if it had it
 
     if (node == NULL)
-      return (VALUE)NULL;  // Returns NULL because key is not in the table
-    else if (isSpine(node))
-      return get_sub(desc, hash, unmark_spine(node), nodeDesc,
-                     T);  // Checks the Sub_Spine
+      return (Value)NULL;  // Returns NULL because key is not in the table
+    else if (isSpine(node)) {
+      depth = 1;
+      return get_sub(desc, hash, unmark_spine(node), nodeDesc, T,
+                     depth);  // Checks the Sub_Spine
+    }
     else {  // Is Data Node//Found a Data if it is a key match then it returns
             // the value
       if (((DataNode *)node)->hash == hash)  // HASH COMPARE
@@ -1163,31 +1310,31 @@ class TransMap {
         FinishPendingTxn(oldCurrDesc, desc, T);
 
         if (IsSameOperation(oldCurrDesc, nodeDesc)) {
-          return 0;  // TODO: need to return some value here, maybe make up a
-                     // sentinel
+          return SaveFound(oldCurrDesc);
         }
 
         // NOTE: because we use a perfect hash function with our wfhm, if the
         // key doesn't exist here, then it doesn't logically exist anywhere in
         // the table
         if (!IsKeyExist(oldCurrDesc))
-          return (VALUE)NULL;
+          return (Value)NULL;
         else  // the key they wanted to insert, isn't logically in the table so
               // we can insert
         {
           NodeDesc *currDesc = ((DataNode *)node)->nodeDesc;
 
           if (desc->status != MAP_ACTIVE) {
-            return (VALUE)NULL;
+            return (Value)NULL;
           }
 
           if (IsUnsavedUpdate(currDesc, ((DataNode *)node)->value)) {
-            ((DataNode *)node)->value =
-                currDesc->desc->ops[currDesc->opid].value;
+            ((DataNode *)node)->value = GetValue(currDesc);
           }
 
           // if(currDesc == oldCurrDesc)
           {
+            nodeDesc->value = ReadValue((DataNode *)node, oldCurrDesc);
+
             // Update desc to logically add the key to the table since it's
             // already physically there
             currDesc = __sync_val_compare_and_swap(
@@ -1199,16 +1346,7 @@ class TransMap {
             if (currDesc == oldCurrDesc) {
               ASSERT_CODE(__sync_fetch_and_add(&g_count_ins, 1););
 
-              // if this txn did an update here, then use that value
-              if (IsLiveUpdate(oldCurrDesc)) {
-                nodeDesc->desc->ops[nodeDesc->opid].value = GetValue(
-                    oldCurrDesc);  // oldCurrDesc->desc->ops[oldCurrDesc->opid].value;
-                return nodeDesc->desc->ops[nodeDesc->opid]
-                    .value;  // nodeDesc->value;
-              } else {
-                // if it's not a live update then use the value at the node
-                return ((DataNode *)node)->value;
-              }
+              return SaveFound(nodeDesc);
             } else
               goto find_main;
           }
@@ -1218,15 +1356,15 @@ class TransMap {
       } else  // otherwise return NULL because there is no key match
       {
         // noMatch_getMain:
-        return (VALUE)NULL;
+        return (Value)NULL;
       }
     }  // End Is Data Node
   }    // End Get Main
 
-  inline VALUE get_sub(Desc *desc, HASH hash, void * /* volatile  */ *local,
-                       NodeDesc *nodeDesc, int T) {
+  inline Value get_sub(Desc *desc, Hash hash, void * /* volatile  */ *local,
+                       NodeDesc *nodeDesc, int T, int &depth) {
   find_sub:
-    HASH h = hash >> MAIN_POW;     // Adjusts the hash bits
+    Hash h = hash >> MAIN_POW;     // Adjusts the hash bits
     int pos = h & (SUB_SIZE - 1);  // determines the position to check
 #ifdef DEBUG
     assert(pos >= 0 && pos < SUB_SIZE);
@@ -1234,11 +1372,11 @@ class TransMap {
 
     // This loop will run until the max depth is reached, the spine at the max
     // depth will be examined by the code block below
-    for (int right = MAIN_POW; right < KEY_SIZE - SUB_POW; right += SUB_POW) {
+    for (int right = MAIN_POW; right < HASH_BITS - SUB_POW; right += SUB_POW) {
       h = h >> SUB_POW;  // adjusts the hash bits for the next time
       void *node = getNode(local, pos);
       if (node == NULL)  // See Logic above
-        return (VALUE)NULL;
+        return (Value)NULL;
       else if (!isSpine(node)) {
         if (((DataNode *)node)->hash == hash)  // HASH COMPARE
         {
@@ -1246,23 +1384,22 @@ class TransMap {
           FinishPendingTxn(oldCurrDesc, desc, T);
 
           if (IsSameOperation(oldCurrDesc, nodeDesc)) {
-            return true;  // TODO: use sentinel
+            return SaveFound(oldCurrDesc);
           }
 
           if (!IsKeyExist(oldCurrDesc))
-            return (VALUE)NULL;
+            return (Value)NULL;
           else  // the key they wanted to insert, isn't logically in the table
                 // so we can insert
           {
             NodeDesc *currDesc = ((DataNode *)node)->nodeDesc;
 
             if (desc->status != MAP_ACTIVE) {
-              return (VALUE)NULL;
+              return (Value)NULL;
             }
 
             if (IsUnsavedUpdate(currDesc, ((DataNode *)node)->value)) {
-              ((DataNode *)node)->value =
-                  currDesc->desc->ops[currDesc->opid].value;
+              ((DataNode *)node)->value = GetValue(currDesc);
             }
 
             // if(currDesc == oldCurrDesc)
@@ -1270,6 +1407,9 @@ class TransMap {
               // if(IsAbortedUpdate(oldCurrDesc))
               //	return oldCurrDesc->desc->ops[oldCurrDesc->opid].value;
 
+              nodeDesc->value = ReadValue((DataNode *)node, oldCurrDesc);
+
+
               // Update desc to logically add the key to the table since it's
               // already physically there
               currDesc = __sync_val_compare_and_swap(
@@ -1281,17 +1421,7 @@ class TransMap {
               if (currDesc == oldCurrDesc) {
                 ASSERT_CODE(__sync_fetch_and_add(&g_count_ins, 1););
 
-                // if this txn did an update here, then use that value
-                if (IsLiveUpdate(oldCurrDesc)) {
-                  nodeDesc->desc->ops[nodeDesc->opid].value = GetValue(
-                      oldCurrDesc);  // nodeDesc->value =
-                                     // oldCurrDesc->desc->ops[oldCurrDesc->opid].value;
-                  return nodeDesc->desc->ops[nodeDesc->opid]
-                      .value;  // nodeDesc->value;
-                } else {
-                  // if it's not a live update then use the value at the node
-                  return ((DataNode *)node)->value;
-                }
+                return SaveFound(nodeDesc);
               } else
                 goto find_sub;
             }
@@ -1300,11 +1430,12 @@ class TransMap {
           // goto noMatch_getSub;
         } else {
           // noMatch_getSub:
-          return (VALUE)NULL;
+          return (Value)NULL;
         }
       }  // End Is Data Node
       local = unmark_spine(node);
       pos = h & (SUB_SIZE - 1);
+      depth++;
     }  // End For loop
 
   find_final:
@@ -1315,7 +1446,7 @@ class TransMap {
     assert(!isSpine(node));
 #endif
     if (node == NULL)
-      return (VALUE)NULL;
+      return (Value)NULL;
     else { /* if (((DataNode *)node)->hash == hash)*/  // HASH COMPARE
 #ifdef DEBUG
       assert(((DataNode *)node)->hash == hash);
@@ -1325,26 +1456,28 @@ class TransMap {
       FinishPendingTxn(oldCurrDesc, desc, T);
 
       if (IsSameOperation(oldCurrDesc, nodeDesc)) {
-        return true;  // TODO: use sentinel
+        return SaveFound(oldCurrDesc);
       }
 
       if (!IsKeyExist(oldCurrDesc))
-        return (VALUE)NULL;
+        return (Value)NULL;
       else  // the key they wanted to insert, isn't logically in the table so we
             // can insert
       {
         NodeDesc *currDesc = ((DataNode *)node)->nodeDesc;
 
         if (desc->status != MAP_ACTIVE) {
-          return (VALUE)NULL;
+          return (Value)NULL;
         }
 
         if (IsUnsavedUpdate(currDesc, ((DataNode *)node)->value)) {
-          ((DataNode *)node)->value = currDesc->desc->ops[currDesc->opid].value;
+          ((DataNode *)node)->value = GetValue(currDesc);
         }
 
         // if(currDesc == oldCurrDesc)
         {
+          nodeDesc->value = ReadValue((DataNode *)node, oldCurrDesc);
+
           // Update desc to logically add the key to the table since it's
           // already physically there
           currDesc = __sync_val_compare_and_swap(&((DataNode *)node)->nodeDesc,
@@ -1356,17 +1489,7 @@ class TransMap {
           if (currDesc == oldCurrDesc) {
             ASSERT_CODE(__sync_fetch_and_add(&g_count_ins, 1););
 
-            // if this txn did an update here, then use that value
-            if (IsLiveUpdate(oldCurrDesc)) {
-              nodeDesc->desc->ops[nodeDesc->opid].value = GetValue(
-                  oldCurrDesc);  // nodeDesc->value =
-                                 // //oldCurrDesc->desc->ops[oldCurrDesc->opid].value;
-              return nodeDesc->desc->ops[nodeDesc->opid]
-                  .value;  // nodeDesc->value;
-            } else {
-              // if it's not a live update then use the value at the node
-              return ((DataNode *)node)->value;
-            }
+            return SaveFound(nodeDesc);
           } else
             goto find_final;  // keep retrying until we're aborted by a
                               // concurrent txn, or we succeed
@@ -1404,7 +1527,7 @@ class TransMap {
   **/
   // inline bool remove_first(KEY k, int T){
   // NOTE: nodeDesc is pass by value
-  inline bool Delete(Desc *desc, uint8_t opid, KEY k, int T) {
+  inline bool Delete(Desc *desc, uint32_t opid, Key k, int T) {
 #ifdef USE_MEM_POOL
     NodeDesc *nodeDesc =
         new (m_nodeDescAllocator->Alloc()) NodeDesc(desc, opid);
@@ -1413,7 +1536,7 @@ class TransMap {
     nodeDesc->desc = desc;
     nodeDesc->opid = opid;
 #endif
-    HASH h = HASH_KEY(k);  // Reorders the bits for more even distribution
+    Hash h = HASH_KEY(k);  // Reorders the bits for more even distribution
 #ifdef useThreadWatch
     Thread_watch[T] = h;  // Adds the key to the watchlist
 #endif
@@ -1426,7 +1549,7 @@ class TransMap {
     return res;  // Returns the result.
   }
 
-  inline bool remove_main(Desc *desc, HASH hash, int T, NodeDesc *nodeDesc) {
+  inline bool remove_main(Desc *desc, Hash hash, int T, NodeDesc *nodeDesc) {
   delete_main:
     int pos = getMAINPOS(hash);  //&(MAIN_SIZE-1));
 #ifdef DEBUG
@@ -1459,6 +1582,15 @@ class TransMap {
           return false;
         }
 
+
+        // The key keeps this value if the delete aborts
+
+        if (IsUnsavedUpdate(currDesc, ((DataNode *)node)->value)) {
+
+          ((DataNode *)node)->value = GetValue(currDesc);
+
+        }
+
         // if(currDesc == oldCurrDesc)
         {
           // Update desc to logically add the key to the table since it's
@@ -1489,16 +1621,16 @@ class TransMap {
     return false;
   }  // End Remove Main
 
-  inline bool remove_sub(Desc *desc, HASH hash, void * /* volatile  */ *local,
+  inline bool remove_sub(Desc *desc, Hash hash, void * /* volatile  */ *local,
                          int T, NodeDesc *nodeDesc) {
   delete_sub:
-    HASH h = hash >> MAIN_POW;     // Adjusts the hash
+    Hash h = hash >> MAIN_POW;     // Adjusts the hash
     int pos = h & (SUB_SIZE - 1);  // Gets the position of the sig node
 #ifdef DEBUG
     assert(pos >= 0 && pos < SUB_SIZE);  // verifies position is valid
 #endif
 
-    for (int right = MAIN_POW; right < KEY_SIZE;
+    for (int right = MAIN_POW; right < HASH_BITS;
          right += SUB_POW) {                // Traverses the sub spines
       h = h >> SUB_POW;                     // Adjusts the hash
       void *node = getNodeRaw(local, pos);  // gets the node
@@ -1525,6 +1657,15 @@ class TransMap {
               return false;
             }
 
+
+            // The key keeps this value if the delete aborts
+
+            if (IsUnsavedUpdate(currDesc, ((DataNode *)node)->value)) {
+
+              ((DataNode *)node)->value = GetValue(currDesc);
+
+            }
+
             // if(currDesc == oldCurrDesc)
             {
               // Update desc to logically add the key to the table since it's
@@ -1588,12 +1729,14 @@ position
                          int right) {
     // Gets a Spine node from the Spine pool or allocates a new one
     // See Allocate_Spine for more details on the Spine Pool
+    TableStats &stats = m_stats.Local();
     void **s_head;
     if (Thread_spines[T] == NULL) {
       s_head = (void **)getSpine();
     } else {
       s_head = (void **)Thread_spines[T];
       Thread_spines[T] = s_head[0];
+      stats.spineReuses++;
     }
 
     // Determines the location that the current node belongs in the spine
@@ -1623,9 +1766,8 @@ position
       return cas_res;
     } else {  // If it passes, return the spine that was inserted
       assert(isSpine(getNode(local, pos)));
-#ifdef SPINE_COUNT
-      __sync_fetch_and_add(&spine_elements, 1);
-#endif
+      stats.spinesLinked++;
+      stats.casFailureExpansions++;
       return mark_spine(s_head);
       ;
     }
@@ -1661,10 +1803,10 @@ new node
 
 **/
 #ifdef USE_KEY
-  inline DataNode *Allocate_Node(VALUE v, KEY k, HASH h, int T,
+  inline DataNode *Allocate_Node(Value v, Key k, Hash h, int T,
                                  NodeDesc *nodeDesc) {
 #else
-  inline DataNode *Allocate_Node(VALUE v, HASH h, int T, NodeDesc *nodeDesc) {
+  inline DataNode *Allocate_Node(Value v, Hash h, int T, NodeDesc *nodeDesc) {
 #endif
 
     DataNode *new_temp_node = (DataNode *)Thread_pool_stack[T];
@@ -1703,6 +1845,7 @@ new node
 #endif
       // No valid nodes, then malloc
       new_temp_node = (DataNode *)calloc(1, sizeof(DataNode));
+      __sync_fetch_and_add(&node_allocations, 1);
 #ifdef DEBUG
       assert(new_temp_node != NULL);  // Insures a node was allocated
 #endif
@@ -1799,17 +1942,17 @@ new node
     if (s[pos] != n1) return false;
 
     // Gets the current hash value
-    HASH n1_hash = ((n1->hash) >> right);
-    HASH n2_hash = ((n2->hash) >> right);
+    Hash n1_hash = ((n1->hash) >> right);
+    Hash n2_hash = ((n2->hash) >> right);
 
-#ifdef SPINE_COUNT
+    TableStats &stats = m_stats.Local();
     int spine_count = 1;
-#endif
     void **s_head;  // Gets a spine by either allocting or from the stack
     if (Thread_spines[T] == NULL) {
       s_head = (void **)getSpine();
     } else {
       s_head = (void **)Thread_spines[T];
+      stats.spineReuses++;
     }
 
     // Get the sig positions
@@ -1860,11 +2003,10 @@ new node
       } else {                  // Get a spine from the stack
         s_temp2 = s_temp[0];
         s_temp[0] = NULL;
+        stats.spineReuses++;
         //	assert(isEmptyArray(s_temp,SUB_SIZE));
       }
-#ifdef SPINE_COUNT
       spine_count++;
-#endif
       // Add the spine to the privous spine
       s_temp[n1_pos] = mark_spine((void * /* volatile  */ *)s_temp2);
       s_temp = (void * /* volatile  */ *)s_temp2;
@@ -1896,9 +2038,8 @@ new node
              mark_spine((void * /* volatile  */ *)s_head))) == n1) {
       //  __sync_fetch_and_add(&v_capacity, count*SUB_SIZE);
       //		printf("Added Spine %p replacing %p (1)\n",s_head,n1);
-#ifdef SPINE_COUNT
-      __sync_fetch_and_add(&spine_elements, spine_count);
-#endif
+      stats.spinesLinked += spine_count;
+      stats.collisionExpansions++;
       return true;  // return true if passes
 
     } else {  // If failed then add the allocated spines to the spine stack
@@ -1937,6 +2078,7 @@ new node
   inline void *getSpine() {
     // Could add Code to allocate more than one spine
     void *s = (void *)calloc(SUB_SIZE, (sizeof(void * /* volatile  */)));
+    m_stats.Local().spineAllocations++;
 #ifdef DEBUG
     assert(s != NULL);
     //	assert(isEmptyArray(s,SUB_SIZE));
@@ -1949,7 +2091,7 @@ new node
      thread
   */
 #ifdef useThreadWatch
-  inline bool inUse(HASH h, int T) {
+  inline bool inUse(Hash h, int T) {
     // Thread_pool_stack		Thread_pool_vector
     for (int i = 0; i < Threads; i++) {
       if (h == Thread_watch[i] && T != i)  // HASH Compare
@@ -2000,13 +2142,140 @@ new node
 
   int size() { return elements; }
 
+  // Number of keys, as of one instant between the call and its return.
+  // size() counts nodes as they are linked in, whether or not their
+  // transaction commits. Kept by ExecuteOps, and by the owner for maps that
+  // have one.
+  uint64_t Size() const { return m_size.Read(); }
+
+  SizeCounter<Desc> &GetSizeCounter() { return m_size; }
+
+  /*
+  Walks the table counting the data nodes and spines that are linked in.
+  Nodes and spines sitting in the per-thread reuse pools (Thread_pool_stack,
+  Thread_spines) are reserved but not used.
+  */
+  MemoryStats GetMemoryStats() {
+    MemoryStats stats = {};
+    uint64_t spines = 0;
+
+    CountNodes(head, MAIN_SIZE, stats, spines);
+
+    stats.descriptors = m_descAllocator->Allocated();
+
+    uint64_t nodes = stats.liveNodes + stats.deletedNodes;
+
+    stats.bytesReserved =
+        MAIN_SIZE * sizeof(void *) +
+        m_stats.Sum().spineAllocations * SUB_SIZE * sizeof(void *) +
+        (uint64_t)node_allocations * sizeof(DataNode) +
+        m_descAllocator->BytesReserved() + m_nodeDescAllocator->BytesReserved();
+    stats.bytesUsed = MAIN_SIZE * sizeof(void *) +
+                      spines * SUB_SIZE * sizeof(void *) +
+                      nodes * sizeof(DataNode) + m_descAllocator->BytesUsed() +
+                      m_nodeDescAllocator->BytesUsed();
+
+    return stats;
+  }
+
+  void CountNodes(void * /* volatile  */ *s, int size, MemoryStats &stats,
+                  uint64_t &spines) {
+    for (int i = 0; i < size; i++) {
+      void *node = getNodeRaw(s, i);
+      if (node == NULL) {
+        continue;
+      } else if (isSpine(node)) {
+        spines++;
+        CountNodes(unmark_spine(node), SUB_SIZE, stats, spines);
+      } else if (IsKeyExist(unmark_data(node)->nodeDesc)) {
+        stats.liveNodes++;
+      } else {
+        stats.deletedNodes++;
+      }
+    }
+  }
+
+  // The counters summed over the threads, and the levels from GetLevelStats
+  TableStats GetTableStats() {
+    TableStats stats = m_stats.Sum();
+    std::vector<LevelStats> levels = GetLevelStats();
+
+    stats.buckets = MAIN_SIZE;
+    stats.depth = levels.size();
+    for (size_t i = 0; i < levels.size(); i++) {
+      stats.levels[i] = levels[i];
+    }
+
+    return stats;
+  }
+
+  Metrics GetMetrics() {
+    Metrics metrics = {g_count_commit, g_count_abort, g_count_fake_abort};
+
+    metrics.parts = METRICS_MEMORY | METRICS_TABLE;
+    metrics.memory = GetMemoryStats();
+    metrics.table = GetTableStats();
+
+    return metrics;
+  }
+
+  // Keys that are logically present, in table order. Weakly consistent like
+  // GetMemoryStats. Keys are read back from the hashes, so this takes the
+  // identity hash (toHash 5).
+  void GetKeys(std::vector<Key> &keys) {
+    CollectKeys(head, MAIN_SIZE, keys);
+  }
+
+  void CollectKeys(void * /* volatile  */ *s, int size,
+                   std::vector<Key> &keys) {
+    for (int i = 0; i < size; i++) {
+      void *node = getNodeRaw(s, i);
+      if (node == NULL) {
+        continue;
+      } else if (isSpine(node)) {
+        CollectKeys(unmark_spine(node), SUB_SIZE, keys);
+      } else if (IsKeyExist(unmark_data(node)->nodeDesc)) {
+        Key k;
+        memcpy(&k, &unmark_data(node)->hash, sizeof(Key));
+        keys.push_back(k);
+      }
+    }
+  }
+
+  // Walks the table, so it is only exact while no thread expands it
+  std::vector<LevelStats> GetLevelStats() {
+    std::vector<LevelStats> levels;
+
+    CountLevel(head, MAIN_SIZE, 0, levels);
+
+    return levels;
+  }
+
+  void CountLevel(void * /* volatile  */ *s, int size, size_t level,
+                  std::vector<LevelStats> &levels) {
+    if (levels.size() <= level) {
+      levels.resize(level + 1, LevelStats());
+    }
+
+    levels[level].spines++;
+    levels[level].slots += size;
+
+    for (int i = 0; i < size; i++) {
+      void *node = getNodeRaw(s, i);
+      if (node == NULL) {
+        continue;
+      } else if (isSpine(node)) {
+        levels[level].subSpines++;
+        CountLevel(unmark_spine(node), SUB_SIZE, level + 1, levels);
+      } else {
+        levels[level].dataNodes++;
+      }
+    }
+  }
+
   // Debug Interfaces//
   int capacity() {
-#ifdef SPINE_COUNT
-    return (SUB_SIZE * spine_elements + MAIN_SIZE);
-#else
-    return -1;
-#endif
+    return (SUB_SIZE * m_stats.Sum().spinesLinked + MAIN_SIZE);
   }
 
   //////////////////////////////////////////////////////////////////////////////////
@@ -2035,7 +2304,11 @@ new node
       return;
     }
 
-    HelpOps(nodeDesc->desc, nodeDesc->opid + 1, threadId);
+    if (m_owner != NULL) {
+      m_help(m_owner, nodeDesc->desc, nodeDesc->opid + 1, threadId);
+    } else {
+      HelpOps(nodeDesc->desc, nodeDesc->opid + 1, threadId);
+    }
   }
 
   inline bool IsNodeActive(NodeDesc *nodeDesc) {
@@ -2052,38 +2325,42 @@ new node
     // update operations should have this method return that the key exists,
     // then the old value from the descriptor should be used
     return (opType == MAP_FIND) || (isNodeActive && opType == MAP_INSERT) ||
-           (!isNodeActive && opType == MAP_DELETE) || (opType == MAP_UPDATE);
+           (!isNodeActive && opType == MAP_DELETE) || (opType == MAP_UPDATE) ||
+           (opType == MAP_FETCH_ADD) || (opType == MAP_CAS) ||
+           (opType == MAP_UPSERT && (isNodeActive || !nodeDesc->missing));
     // if the operation performed was an update then the key remains in the hash
     // map regardless of return value
     //((nodeDesc->desc->status == MAP_COMMITTED || nodeDesc->desc->status ==
     //MAP_ABORTED) && opType == MAP_UPDATE);
   }
 
+  // An aborted update leaves the value the node had before it
   inline bool IsLiveUpdate(NodeDesc *nodeDesc) {
+    if (nodeDesc->desc->status == MAP_ABORTED) {
+      return false;
+    }
+
     if (nodeDesc->desc->ops[nodeDesc->opid].type == MAP_UPDATE ||
+        nodeDesc->desc->ops[nodeDesc->opid].type >= MAP_FETCH_ADD ||
         (nodeDesc->desc->ops[nodeDesc->opid].type == MAP_FIND &&
-         nodeDesc->desc->ops[nodeDesc->opid].value !=
-             0))  // nodeDesc->value != 0) )
+         nodeDesc->value != 0))
       return true;
     return false;
   }
 
-  // TODO: this should call IsLiveUpdate
-  inline bool IsUnsavedUpdate(NodeDesc *nodeDesc, VALUE val) {
-    if (nodeDesc->desc->ops[nodeDesc->opid].value != val &&
-        nodeDesc->desc->status == MAP_COMMITTED)
-      if (nodeDesc->desc->ops[nodeDesc->opid].type == MAP_UPDATE ||
-          (nodeDesc->desc->ops[nodeDesc->opid].type == MAP_FIND &&
-           nodeDesc->desc->ops[nodeDesc->opid].value != 0))
-        return true;  // else error?
-    return false;
+  inline bool IsUnsavedUpdate(NodeDesc *nodeDesc, Value val) {
+    return nodeDesc->desc->status == MAP_COMMITTED && IsLiveUpdate(nodeDesc) &&
+           GetValue(nodeDesc) != val;
   }
 
  private:
   // Node* m_tail;
   // Node* m_head;
 
-  void HelpOps(Desc *desc, uint8_t opid, int threadId);
+  void HelpOps(Desc *desc, uint32_t opid, int threadId);
+
+  static int64_t SizeDelta(Desc *desc,
+                           const typename SizeCounter<Desc>::Share &share);
 
   Allocator<DataNode> *m_nodeAllocator;
   Allocator<Desc> *m_descAllocator;
@@ -2105,6 +2382,16 @@ new node
   uint32_t g_count_commit = 0;
   uint32_t g_count_abort = 0;
   uint32_t g_count_fake_abort = 0;
-};  // end class TransMap
+
+  ThreadStats<TableStats> m_stats;
+  SizeCounter<Desc> m_size;
+
+  void *m_owner = NULL;
+  HelpFn m_help = NULL;
+
+  static thread_local HelpStack<Desc> m_helpStack;
+};  // end class BasicTransMap
+
+typedef BasicTransMap<uint32_t, uint32_t> TransMap;
 
 #endif /* end of include guard: TRANSMAP_H */
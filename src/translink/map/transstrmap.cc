@@ -0,0 +1,494 @@
+//------------------------------------------------------------------------------
+//
+//
+//
+//------------------------------------------------------------------------------
+
+#include "translink/map/transstrmap.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#define IS_SPINE(_p) (((uintptr_t)(_p)) & 1)
+#define MARK_SPINE(_p) ((void*)(((uintptr_t)(_p)) | 1))
+#define UNMARK_SPINE(_p) ((void* volatile*)(((uintptr_t)(_p)) & ~1))
+
+TransStrMap::TransStrMap(Allocator<Node>* nodeAllocator,
+                         Allocator<Desc>* descAllocator,
+                         Allocator<NodeDesc>* nodeDescAllocator,
+                         uint64_t initalPowerOfTwo)
+    : m_mainPow(0),
+      m_values(NULL),
+      m_nodeAllocator(nodeAllocator),
+      m_descAllocator(descAllocator),
+      m_nodeDescAllocator(nodeDescAllocator) {
+  while ((1ULL << m_mainPow) < initalPowerOfTwo) {
+    m_mainPow++;
+  }
+
+  m_head = (void* volatile*)calloc(1ULL << m_mainPow, sizeof(void*));
+}
+
+TransStrMap::~TransStrMap() {
+  FreeSlots(m_head, 1 << m_mainPow);
+  free((void*)m_head);
+
+  while (m_values != NULL) {
+    Copy* next = m_values->next;
+    free(m_values);
+    m_values = next;
+  }
+}
+
+TransStrMap::Desc* TransStrMap::AllocateDesc(uint32_t size) {
+  Desc* desc = m_descAllocator->Alloc();
+  desc->size = size;
+  desc->status = ACTIVE;
+
+  return desc;
+}
+
+bool TransStrMap::ExecuteOps(Desc* desc) {
+  // No other thread sees desc yet
+  for (uint32_t i = 0; i < desc->size; i++) {
+    Operator& op = desc->ops[i];
+
+    if (op.type == INSERT || op.type == UPDATE) {
+      OwnValue(op.value);
+    }
+  }
+
+  return ExecuteDesc(desc);
+}
+
+inline TransStrMap::ReturnCode TransStrMap::RunOp(Desc* desc, uint32_t opid) {
+  const Operator& op = desc->ops[opid];
+
+  if (op.type == INSERT) {
+    return Insert(desc, opid);
+  } else if (op.type == DELETE) {
+    return Delete(desc, opid);
+  } else {
+    return Find(desc, opid);
+  }
+}
+
+inline TransStrMap::ReturnCode TransStrMap::Insert(Desc* desc, uint32_t opid) {
+  const Operator& op = desc->ops[opid];
+  NodeDesc* nodeDesc = new (m_nodeDescAllocator->Alloc()) NodeDesc(desc, opid);
+  uint64_t hash = HashOf(op.key.Data(), op.key.length);
+  Node* fresh = NULL;
+  Node* node = Locate(op.key, hash, nodeDesc, fresh);
+
+  if (node == fresh) {
+    return OK;
+  }
+
+  // Another thread added the key first, the pool keeps the node but the heap
+  // copy of a long key can go
+  if (fresh != NULL && fresh->key.length > Bytes::INLINE_SIZE) {
+    free((void*)fresh->key.data);
+  }
+
+  while (true) {
+    NodeDesc* oldCurrDesc = node->nodeDesc;
+
+    FinishPendingTxn(oldCurrDesc, desc);
+
+    if (IsSameOperation(oldCurrDesc, nodeDesc)) {
+      return SKIP;
+    }
+
+    if (IsKeyExist(oldCurrDesc)) {
+      return FAIL;
+    }
+
+    if (desc->status != ACTIVE) {
+      return FAIL;
+    }
+
+    nodeDesc->value = PriorValue(oldCurrDesc, desc);
+
+    if (__sync_bool_compare_and_swap(&node->nodeDesc, oldCurrDesc, nodeDesc)) {
+      return OK;
+    }
+
+    m_traversal.Local().restarts++;
+  }
+}
+
+inline TransStrMap::ReturnCode TransStrMap::Delete(Desc* desc, uint32_t opid) {
+  const Operator& op = desc->ops[opid];
+  NodeDesc* nodeDesc = new (m_nodeDescAllocator->Alloc()) NodeDesc(desc, opid);
+  Node* fresh = NULL;
+  Node* node =
+      Locate(op.key, HashOf(op.key.Data(), op.key.length), NULL, fresh);
+
+  if (node == NULL) {
+    return FAIL;
+  }
+
+  while (true) {
+    NodeDesc* oldCurrDesc = node->nodeDesc;
+
+    FinishPendingTxn(oldCurrDesc, desc);
+
+    if (IsSameOperation(oldCurrDesc, nodeDesc)) {
+      return SKIP;
+    }
+
+    if (!IsKeyExist(oldCurrDesc)) {
+      return FAIL;
+    }
+
+    if (desc->status != ACTIVE) {
+      return FAIL;
+    }
+
+    nodeDesc->value = PriorValue(oldCurrDesc, desc);
+
+    if (__sync_bool_compare_and_swap(&node->nodeDesc, oldCurrDesc, nodeDesc)) {
+      return OK;
+    }
+
+    m_traversal.Local().restarts++;
+  }
+}
+
+// FIND and UPDATE, both need the key present. FIND copies the value it saw
+// into its operation.
+inline TransStrMap::ReturnCode TransStrMap::Find(Desc* desc, uint32_t opid) {
+  Operator& op = desc->ops[opid];
+  NodeDesc* nodeDesc = NULL;
+  Node* fresh = NULL;
+  Node* node =
+      Locate(op.key, HashOf(op.key.Data(), op.key.length), NULL, fresh);
+
+  if (node == NULL) {
+    return FAIL;
+  }
+
+  while (true) {
+    NodeDesc* oldCurrDesc = node->nodeDesc;
+
+    FinishPendingTxn(oldCurrDesc, desc);
+
+    if (nodeDesc == NULL) {
+      nodeDesc = new (m_nodeDescAllocator->Alloc()) NodeDesc(desc, opid);
+    }
+
+    if (IsSameOperation(oldCurrDesc, nodeDesc)) {
+      if (op.type == FIND && oldCurrDesc->value != NULL) {
+        op.value = *oldCurrDesc->value;
+      }
+
+      return SKIP;
+    }
+
+    // A key an earlier FIND or UPDATE of ours holds is ours already. Taking it
+    // over again would lose the value of that UPDATE.
+    if (op.type == FIND && oldCurrDesc->desc == desc) {
+      const Operator& own = desc->ops[oldCurrDesc->opid];
+
+      if (own.type == FIND || own.type == UPDATE) {
+        if (desc->status != ACTIVE) {
+          return FAIL;
+        }
+
+        op.value = own.value;
+        return OK;
+      }
+    }
+
+    if (!IsKeyExist(oldCurrDesc)) {
+      return FAIL;
+    }
+
+    if (desc->status != ACTIVE) {
+      return FAIL;
+    }
+
+    nodeDesc->value = PriorValue(oldCurrDesc, desc);
+
+    if (__sync_bool_compare_and_swap(&node->nodeDesc, oldCurrDesc, nodeDesc)) {
+      if (op.type == FIND && nodeDesc->value != NULL) {
+        op.value = *nodeDesc->value;
+      }
+
+      return OK;
+    }
+
+    m_traversal.Local().restarts++;
+  }
+}
+
+// Node holding key, NULL if there is none. With nodeDesc set a missing key is
+// added, as a node carrying nodeDesc. That node is made once in fresh and
+// returned once it is in.
+inline TransStrMap::Node* TransStrMap::Locate(const Bytes& key, uint64_t hash,
+                                              NodeDesc* nodeDesc,
+                                              Node*& fresh) {
+  void* volatile* slots = m_head;
+  uint32_t shift = 0;
+  uint32_t width = m_mainPow;
+  Node* found = NULL;
+  // Count into locals and publish once, like the list searches
+  uint64_t visited = 0;
+  uint64_t restarts = 0;
+
+  while (true) {
+    void* volatile* slot = &slots[(hash >> shift) & ((1ULL << width) - 1)];
+    void* curr = *slot;
+
+    visited++;
+
+    if (curr == NULL) {
+      if (nodeDesc == NULL) {
+        break;
+      }
+
+      if (fresh == NULL) {
+        fresh = AllocateNode(key, hash, nodeDesc);
+      }
+
+      if (__sync_bool_compare_and_swap(slot, NULL, fresh)) {
+        found = fresh;
+        break;
+      }
+
+      restarts++;
+      continue;
+    }
+
+    if (IS_SPINE(curr)) {
+      slots = UNMARK_SPINE(curr);
+      shift += width;
+      width = SPINE_POW;
+      continue;
+    }
+
+    Node* node = static_cast<Node*>(curr);
+
+    if (node->hash == hash) {
+      // Same hash, the key is on this chain or goes at its end
+      while (!node->key.Equals(key)) {
+        Node* next = node->next;
+
+        if (next != NULL) {
+          node = next;
+          visited++;
+          continue;
+        }
+
+        if (nodeDesc == NULL) {
+          node = NULL;
+          break;
+        }
+
+        if (fresh == NULL) {
+          fresh = AllocateNode(key, hash, nodeDesc);
+        }
+
+        if (__sync_bool_compare_and_swap(&node->next, NULL, fresh)) {
+          node = fresh;
+          break;
+        }
+
+        restarts++;
+      }
+
+      found = node;
+      break;
+    }
+
+    if (nodeDesc == NULL) {
+      break;
+    }
+
+    // The hashes differ in a bit past this level, so move the node one level
+    // down into a new spine and read the slot again
+    void* volatile* spine =
+        (void* volatile*)calloc(SPINE_SIZE, sizeof(void*));
+    spine[(node->hash >> (shift + width)) & (SPINE_SIZE - 1)] = node;
+
+    if (!__sync_bool_compare_and_swap(slot, curr, MARK_SPINE(spine))) {
+      free((void*)spine);
+      restarts++;
+    }
+  }
+
+  TraversalStats& stats = m_traversal.Local();
+  stats.searches++;
+  stats.visited += visited;
+  stats.restarts += restarts;
+
+  return found;
+}
+
+inline TransStrMap::Node* TransStrMap::AllocateNode(const Bytes& key,
+                                                    uint64_t hash,
+                                                    NodeDesc* nodeDesc) {
+  Node* node = m_nodeAllocator->Alloc();
+  node->hash = hash;
+  node->key = key;
+  node->nodeDesc = nodeDesc;
+  node->next = NULL;
+
+  // The key in the operation only lives as long as its descriptor
+  if (key.length > Bytes::INLINE_SIZE) {
+    char* copy = static_cast<char*>(malloc(key.length));
+    memcpy(copy, key.data, key.length);
+    node->key.data = copy;
+  }
+
+  return node;
+}
+
+// Points a long value at a copy owned by the map. Committed values are read
+// through the descriptor of their op for as long as the map lives.
+void TransStrMap::OwnValue(Bytes& value) {
+  if (value.length <= Bytes::INLINE_SIZE) {
+    return;
+  }
+
+  Copy* copy = static_cast<Copy*>(malloc(sizeof(Copy) + value.length));
+
+  ASSERT(copy, "Value copy allocation failed.");
+
+  copy->length = value.length;
+  memcpy(copy->bytes, value.data, value.length);
+  value.data = copy->bytes;
+
+  do {
+    copy->next = m_values;
+  } while (!__sync_bool_compare_and_swap(&m_values, copy->next, copy));
+}
+
+// FNV-1a, with the finalizer of MurmurHash3 on top since the low bits pick the
+// slots and FNV leaves them poorly mixed
+uint64_t TransStrMap::HashOf(const char* bytes, uint32_t size) {
+  uint64_t hash = 14695981039346656037ULL;
+
+  for (uint32_t i = 0; i < size; i++) {
+    hash ^= (uint8_t)bytes[i];
+    hash *= 1099511628211ULL;
+  }
+
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ULL;
+  hash ^= hash >> 33;
+
+  return hash;
+}
+
+// Value of a key nodeDesc keeps present
+inline const TransStrMap::Bytes* TransStrMap::CurrentValue(
+    NodeDesc* nodeDesc) {
+  const Operator& op = nodeDesc->desc->ops[nodeDesc->opid];
+
+  if (IsNodeActive(nodeDesc) && (op.type == INSERT || op.type == UPDATE)) {
+    return &op.value;
+  }
+
+  return nodeDesc->value;
+}
+
+// Value the key had before desc touched it, which is what it gets back if desc
+// aborts. Earlier operations of desc already recorded it.
+inline const TransStrMap::Bytes* TransStrMap::PriorValue(NodeDesc* nodeDesc,
+                                                         Desc* desc) {
+  if (nodeDesc->desc == desc) {
+    return nodeDesc->value;
+  }
+
+  return CurrentValue(nodeDesc);
+}
+
+void TransStrMap::CountSlots(void* volatile* slots, uint32_t size,
+                             MemoryStats& stats, uint64_t& heapBytes) {
+  heapBytes += size * sizeof(void*);
+
+  for (uint32_t i = 0; i < size; i++) {
+    void* curr = slots[i];
+
+    if (curr == NULL) {
+      continue;
+    }
+
+    if (IS_SPINE(curr)) {
+      CountSlots(UNMARK_SPINE(curr), SPINE_SIZE, stats, heapBytes);
+      continue;
+    }
+
+    for (Node* node = static_cast<Node*>(curr); node != NULL;
+         node = node->next) {
+      if (IsKeyExist(node->nodeDesc)) {
+        stats.liveNodes++;
+      } else {
+        stats.deletedNodes++;
+      }
+
+      if (node->key.length > Bytes::INLINE_SIZE) {
+        heapBytes += node->key.length;
+      }
+    }
+  }
+}
+
+void TransStrMap::FreeSlots(void* volatile* slots, uint32_t size) {
+  for (uint32_t i = 0; i < size; i++) {
+    void* curr = slots[i];
+
+    if (curr == NULL) {
+      continue;
+    }
+
+    if (IS_SPINE(curr)) {
+      FreeSlots(UNMARK_SPINE(curr), SPINE_SIZE);
+      free((void*)UNMARK_SPINE(curr));
+      continue;
+    }
+
+    for (Node* node = static_cast<Node*>(curr); node != NULL;
+         node = node->next) {
+      if (node->key.length > Bytes::INLINE_SIZE) {
+        free((void*)node->key.data);
+      }
+    }
+  }
+}
+
+MemoryStats TransStrMap::GetMemoryStats() {
+  MemoryStats stats = {};
+  uint64_t heapBytes = 0;
+
+  CountSlots(m_head, 1 << m_mainPow, stats, heapBytes);
+
+  for (Copy* copy = m_values; copy != NULL; copy = copy->next) {
+    heapBytes += sizeof(Copy) + copy->length;
+  }
+
+  stats.descriptors = m_descAllocator->Allocated();
+
+  // Spines, long keys and long values come from the heap, everything else
+  // from the pools
+  stats.AddHeap(heapBytes);
+  stats.AddPool(m_nodeAllocator);
+  stats.AddPool(m_descAllocator);
+  stats.AddPool(m_nodeDescAllocator);
+
+  return stats;
+}
+
+Metrics TransStrMap::GetMetrics() {
+  Metrics metrics = {g_count_commit, g_count_abort, g_count_fake_abort};
+
+  metrics.parts = METRICS_TRAVERSAL | METRICS_MEMORY;
+  metrics.traversal = m_traversal.Sum();
+  metrics.memory = GetMemoryStats();
+
+  return metrics;
+}
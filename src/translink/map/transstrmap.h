@@ -0,0 +1,150 @@
+#ifndef TRANSSTRMAP_H
+#define TRANSSTRMAP_H
+
+#include <cstdint>
+#include <cstring>
+
+#include "common/allocator.h"
+#include "common/assert.h"
+#include "common/memstats.h"
+#include "common/metrics.h"
+#include "common/threadstats.h"
+#include "translink/transbase.h"
+
+// TransMap for byte string keys. TransMap keeps only the hash of a key, which
+// then has to be 1:1 and limits keys to 8 bytes. Here data nodes keep the
+// whole key and every lookup compares it. The 64 bit hash of the key only
+// picks the path through the spines: the main array takes its low bits and
+// each spine below the next SPINE_POW bits. A slot holds one data node until a
+// key with another hash needs it, then it is expanded into a spine holding
+// that node one level down. Keys whose hashes are equal in all 64 bits share
+// one slot and are chained off the first node.
+//
+// Like the translink lists, data nodes are never removed, a delete only
+// changes the logical status of the key through its NodeDesc. The slot of a
+// node and its chain then only ever move down into new spines, so a node is
+// always found on the path of its hash.
+//
+// Values are kept in the descriptors like in TransSkip's map ops: the value
+// of a key is the one of the last committed INSERT or UPDATE, and every
+// NodeDesc points at the value from before its operation, so an aborted op
+// leaves the old value in place.
+//
+// The map keeps copies of long keys and values, so nodes and readers of a
+// committed value never point into the caller's memory. A key is copied with
+// the node that holds it, a value when the transaction writing it starts.
+// Like the descriptors, value copies stay until the map goes.
+class TransStrMap : public TransBase<TransStrMap> {
+ public:
+  // A byte string, held inline when it is short enough and otherwise pointing
+  // at bytes that stay valid as long as the descriptor holding it. The map
+  // swaps those it keeps for its own copy.
+  struct Bytes {
+    static const uint32_t INLINE_SIZE = 24;
+
+    void Set(const char* bytes, uint32_t size) {
+      length = size;
+
+      if (size <= INLINE_SIZE) {
+        memcpy(inlined, bytes, size);
+      } else {
+        data = bytes;
+      }
+    }
+
+    const char* Data() const { return length <= INLINE_SIZE ? inlined : data; }
+
+    bool Equals(const Bytes& other) const {
+      return length == other.length &&
+             memcmp(Data(), other.Data(), length) == 0;
+    }
+
+    uint32_t length;
+    union {
+      char inlined[INLINE_SIZE];
+      const char* data;
+    };
+  };
+
+  struct Operator {
+    uint8_t type;
+    Bytes key;
+    Bytes value;  // written by INSERT and UPDATE, read back by FIND
+  };
+
+  typedef TransDesc<Operator> Desc;
+
+  struct NodeDesc : TransNodeDesc<Desc> {
+    NodeDesc(Desc* _desc, uint32_t _opid)
+        : TransNodeDesc<Desc>(_desc, _opid), value(NULL) {}
+
+    const Bytes* value;  // value of the key before this operation, if any
+  };
+
+  struct Node {
+    uint64_t hash;
+    Bytes key;  // long keys are copied to the heap
+    NodeDesc* volatile nodeDesc;
+    Node* volatile next;  // next key with the same hash
+  };
+
+  static const uint32_t SPINE_POW = 6;
+  static const uint32_t SPINE_SIZE = 1 << SPINE_POW;
+
+  TransStrMap(Allocator<Node>* nodeAllocator, Allocator<Desc>* descAllocator,
+              Allocator<NodeDesc>* nodeDescAllocator,
+              uint64_t initalPowerOfTwo);
+  ~TransStrMap();
+
+  bool ExecuteOps(Desc* desc);
+
+  Desc* AllocateDesc(uint32_t size);
+
+  Metrics GetMetrics();
+
+  TraversalStats GetTraversalStats() const { return m_traversal.Sum(); }
+
+  MemoryStats GetMemoryStats();
+
+  static uint64_t HashOf(const char* bytes, uint32_t size);
+
+ private:
+  friend class TransBase<TransStrMap>;
+
+  ReturnCode RunOp(Desc* desc, uint32_t opid);
+  ReturnCode Insert(Desc* desc, uint32_t opid);
+  ReturnCode Delete(Desc* desc, uint32_t opid);
+  ReturnCode Find(Desc* desc, uint32_t opid);
+
+  const Bytes* CurrentValue(NodeDesc* nodeDesc);
+  const Bytes* PriorValue(NodeDesc* nodeDesc, Desc* desc);
+
+  Node* Locate(const Bytes& key, uint64_t hash, NodeDesc* nodeDesc,
+               Node*& fresh);
+  Node* AllocateNode(const Bytes& key, uint64_t hash, NodeDesc* nodeDesc);
+  void OwnValue(Bytes& value);
+  void CountSlots(void* volatile* slots, uint32_t size, MemoryStats& stats,
+                  uint64_t& heapBytes);
+  void FreeSlots(void* volatile* slots, uint32_t size);
+
+  // Heap block holding the copy of a long value
+  struct Copy {
+    Copy* next;
+    uint32_t length;
+    char bytes[];
+  };
+
+ private:
+  void* volatile* m_head;
+  uint32_t m_mainPow;
+  // Every copy made by OwnValue, newest first
+  Copy* volatile m_values;
+
+  Allocator<Node>* m_nodeAllocator;
+  Allocator<Desc>* m_descAllocator;
+  Allocator<NodeDesc>* m_nodeDescAllocator;
+
+  ThreadStats<TraversalStats> m_traversal;
+};
+
+#endif /* end of include guard: TRANSSTRMAP_H */
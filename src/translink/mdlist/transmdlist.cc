@@ -0,0 +1,381 @@
+//------------------------------------------------------------------------------
+//
+//
+//
+//------------------------------------------------------------------------------
+
+#include "translink/mdlist/transmdlist.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+// A child pointer with the low bit set was adopted by a newer node, or is a
+// dimension the node can never have children in. Either way no insert may
+// link behind it anymore.
+#define SET_ADP(_p) ((Node*)(((uintptr_t)(_p)) | 1))
+#define CLR_ADP(_p) ((Node*)(((uintptr_t)(_p)) & ~1))
+#define IS_ADP(_p) (((uintptr_t)(_p)) & 1)
+
+TransMDList::TransMDList(Allocator<Node>* nodeAllocator,
+                         Allocator<AdoptDesc>* adoptDescAllocator,
+                         Allocator<Desc>* descAllocator,
+                         Allocator<NodeDesc>* nodeDescAllocator)
+    : m_head(new Node()),
+      m_nodeAllocator(nodeAllocator),
+      m_adoptDescAllocator(adoptDescAllocator),
+      m_descAllocator(descAllocator),
+      m_nodeDescAllocator(nodeDescAllocator) {
+  Desc* desc = static_cast<Desc*>(malloc(Desc::SizeOf(1)));
+  desc->status = ABORTED;
+  desc->size = 1;
+  desc->ops[0].type = INSERT;
+  desc->ops[0].key = 0;
+
+  m_head->key = 0;
+  m_head->nodeDesc = new NodeDesc(desc, 0);
+  m_head->adesc = NULL;
+
+  for (uint32_t i = 0; i < DIMENSION; i++) {
+    m_head->coord[i] = 0;
+    m_head->child[i] = NULL;
+  }
+}
+
+TransMDList::~TransMDList() {
+  // Print();
+}
+
+TransMDList::Desc* TransMDList::AllocateDesc(uint32_t size) {
+  Desc* desc = m_descAllocator->Alloc();
+  desc->size = size;
+  desc->status = ACTIVE;
+
+  return desc;
+}
+
+bool TransMDList::ExecuteOps(Desc* desc) { return ExecuteDesc(desc); }
+
+inline TransMDList::ReturnCode TransMDList::RunOp(Desc* desc, uint32_t opid) {
+  const Operator& op = desc->ops[opid];
+
+  if (op.type == INSERT) {
+    return Insert(op.key, desc, opid);
+  } else if (op.type == DELETE) {
+    return Delete(op.key, desc, opid);
+  } else {
+    return Find(op.key, desc, opid);
+  }
+}
+
+inline TransMDList::ReturnCode TransMDList::Insert(uint32_t key, Desc* desc,
+                                                   uint32_t opid) {
+  NodeDesc* nodeDesc =
+      new (m_nodeDescAllocator->Alloc()) NodeDesc(desc, opid);
+  Node* node = NULL;
+  AdoptDesc* adesc = NULL;
+  uint8_t coord[DIMENSION];
+
+  KeyToCoord(key, coord);
+
+  while (true) {
+    Node* pred;
+    Node* curr;
+    uint32_t dp;
+    uint32_t dc;
+
+    LocatePred(coord, pred, curr, dp, dc);
+
+    if (dc == DIMENSION) {
+      NodeDesc* oldCurrDesc = curr->nodeDesc;
+
+      FinishPendingTxn(oldCurrDesc, desc);
+
+      if (IsSameOperation(oldCurrDesc, nodeDesc)) {
+        return SKIP;
+      }
+
+      if (!IsKeyExist(oldCurrDesc)) {
+        if (desc->status != ACTIVE) {
+          return FAIL;
+        }
+
+        if (__sync_bool_compare_and_swap(&curr->nodeDesc, oldCurrDesc,
+                                         nodeDesc)) {
+          return OK;
+        }
+
+        continue;
+      } else {
+        return FAIL;
+      }
+    }
+
+    if (desc->status != ACTIVE) {
+      return FAIL;
+    }
+
+    // The children curr hands over must be its own first
+    AdoptDesc* pending = curr != NULL ? curr->adesc : NULL;
+
+    if (pending != NULL && dp != dc) {
+      FinishInserting(curr, pending);
+    }
+
+    if (node == NULL) {
+      node = m_nodeAllocator->Alloc();
+      node->key = key;
+      node->nodeDesc = nodeDesc;
+      memcpy(node->coord, coord, sizeof(coord));
+    }
+
+    FillNewNode(node, adesc, curr, dp, dc);
+    pending = node->adesc;
+
+    if (__sync_bool_compare_and_swap(&pred->child[dp], curr, node)) {
+      if (pending != NULL) {
+        FinishInserting(node, pending);
+      }
+
+      return OK;
+    }
+
+    // The slot changed or curr gave it away, nothing is unlinked so the
+    // next search finds the node that took it
+    m_traversal.Local().restarts++;
+  }
+}
+
+inline TransMDList::ReturnCode TransMDList::Delete(uint32_t key, Desc* desc,
+                                                   uint32_t opid) {
+  NodeDesc* nodeDesc =
+      new (m_nodeDescAllocator->Alloc()) NodeDesc(desc, opid);
+  uint8_t coord[DIMENSION];
+  Node* pred;
+  Node* curr;
+  uint32_t dp;
+  uint32_t dc;
+
+  KeyToCoord(key, coord);
+  LocatePred(coord, pred, curr, dp, dc);
+
+  if (dc != DIMENSION) {
+    return FAIL;
+  }
+
+  while (true) {
+    NodeDesc* oldCurrDesc = curr->nodeDesc;
+
+    FinishPendingTxn(oldCurrDesc, desc);
+
+    if (IsSameOperation(oldCurrDesc, nodeDesc)) {
+      return SKIP;
+    }
+
+    if (IsKeyExist(oldCurrDesc)) {
+      if (desc->status != ACTIVE) {
+        return FAIL;
+      }
+
+      if (__sync_bool_compare_and_swap(&curr->nodeDesc, oldCurrDesc,
+                                       nodeDesc)) {
+        return OK;
+      }
+    } else {
+      return FAIL;
+    }
+  }
+}
+
+inline TransMDList::ReturnCode TransMDList::Find(uint32_t key, Desc* desc,
+                                                 uint32_t opid) {
+  NodeDesc* nodeDesc = NULL;
+  uint8_t coord[DIMENSION];
+  Node* pred;
+  Node* curr;
+  uint32_t dp;
+  uint32_t dc;
+
+  KeyToCoord(key, coord);
+  LocatePred(coord, pred, curr, dp, dc);
+
+  if (dc != DIMENSION) {
+    return FAIL;
+  }
+
+  while (true) {
+    NodeDesc* oldCurrDesc = curr->nodeDesc;
+
+    FinishPendingTxn(oldCurrDesc, desc);
+
+    if (nodeDesc == NULL)
+      nodeDesc = new (m_nodeDescAllocator->Alloc()) NodeDesc(desc, opid);
+
+    if (IsSameOperation(oldCurrDesc, nodeDesc)) {
+      return SKIP;
+    }
+
+    if (IsKeyExist(oldCurrDesc)) {
+      if (desc->status != ACTIVE) {
+        return FAIL;
+      }
+
+      if (__sync_bool_compare_and_swap(&curr->nodeDesc, oldCurrDesc,
+                                       nodeDesc)) {
+        return OK;
+      }
+    } else {
+      return FAIL;
+    }
+  }
+}
+
+// Digits of key in base BASIS, the most significant one first
+inline void TransMDList::KeyToCoord(uint32_t key, uint8_t coord[]) {
+  for (int i = DIMENSION - 1; i >= 0; i--) {
+    coord[i] = key % BASIS;
+    key /= BASIS;
+  }
+}
+
+// Finds the node with coord, or the place a node with coord goes: between
+// pred and curr, as pred's child in dimension dp and curr's parent in
+// dimension dc. curr is NULL at the end of a dimension and dc is DIMENSION
+// when curr holds the key. Adoptions still running on the way are finished
+// before following a child they move.
+inline void TransMDList::LocatePred(const uint8_t coord[], Node*& pred,
+                                    Node*& curr, uint32_t& dp, uint32_t& dc) {
+  uint64_t visited = 0;
+
+  pred = NULL;
+  curr = m_head;
+  dp = 0;
+  dc = 0;
+
+  while (dc < DIMENSION) {
+    while (curr != NULL && coord[dc] > curr->coord[dc]) {
+      pred = curr;
+      dp = dc;
+
+      AdoptDesc* adesc = curr->adesc;
+
+      if (adesc != NULL && dp >= adesc->pred_dim && dp <= adesc->curr_dim) {
+        FinishInserting(curr, adesc);
+      }
+
+      curr = CLR_ADP(curr->child[dc]);
+      visited++;
+    }
+
+    if (curr == NULL || coord[dc] < curr->coord[dc]) {
+      break;
+    }
+
+    dc++;
+  }
+
+  TraversalStats& stats = m_traversal.Local();
+  stats.searches++;
+  stats.visited += visited;
+}
+
+// Sets up node to go in between pred and curr. If node takes curr's place in
+// a lower dimension than curr's own, the children of curr in the dimensions
+// in between are node's to adopt.
+inline void TransMDList::FillNewNode(Node* node, AdoptDesc*& adesc, Node* curr,
+                                     uint32_t dp, uint32_t dc) {
+  if (dp != dc) {
+    if (adesc == NULL) {
+      adesc = m_adoptDescAllocator->Alloc();
+    }
+
+    adesc->curr = curr;
+    adesc->pred_dim = dp;
+    adesc->curr_dim = dc;
+    node->adesc = adesc;
+  } else {
+    node->adesc = NULL;
+  }
+
+  for (uint32_t i = 0; i < DIMENSION; i++) {
+    node->child[i] = i < dp ? SET_ADP(NULL) : NULL;
+  }
+
+  node->child[dc] = curr;
+}
+
+// Moves the children of adesc->curr over to node. Marking a child first
+// keeps inserts from linking behind it while it moves.
+inline void TransMDList::FinishInserting(Node* node, AdoptDesc* adesc) {
+  Node* curr = adesc->curr;
+
+  for (uint32_t i = adesc->pred_dim; i < adesc->curr_dim; i++) {
+    Node* child = (Node*)__sync_fetch_and_or((uintptr_t*)&curr->child[i], 1);
+
+    if (node->child[i] == NULL) {
+      __sync_bool_compare_and_swap(&node->child[i], NULL, CLR_ADP(child));
+    }
+  }
+
+  __sync_bool_compare_and_swap(&node->adesc, adesc, NULL);
+}
+
+// Children in higher dimensions hold the smaller keys
+inline void TransMDList::PrintNode(Node* node) {
+  printf("Node [%p] Key [%u] Status [%s]\n", node, node->key,
+         IsKeyExist(node->nodeDesc) ? "Exist" : "Inexist");
+
+  for (int i = DIMENSION - 1; i >= 0; i--) {
+    Node* child = node->child[i];
+
+    if (child != NULL && !IS_ADP(child)) {
+      PrintNode(child);
+    }
+  }
+}
+
+void TransMDList::Print() { PrintNode(m_head); }
+
+inline void TransMDList::CollectStats(Node* node, MemoryStats& stats) {
+  if (IsKeyExist(node->nodeDesc)) {
+    stats.liveNodes++;
+  } else if (node != m_head) {
+    stats.deletedNodes++;
+  }
+
+  for (uint32_t i = 0; i < DIMENSION; i++) {
+    Node* child = node->child[i];
+
+    if (child != NULL && !IS_ADP(child)) {
+      CollectStats(child, stats);
+    }
+  }
+}
+
+MemoryStats TransMDList::GetMemoryStats() {
+  MemoryStats stats = {};
+
+  CollectStats(m_head, stats);
+
+  stats.descriptors = m_descAllocator->Allocated();
+
+  // The head comes from the heap, everything else from the pools
+  stats.AddHeap(sizeof(Node));
+  stats.AddPool(m_nodeAllocator);
+  stats.AddPool(m_adoptDescAllocator);
+  stats.AddPool(m_descAllocator);
+  stats.AddPool(m_nodeDescAllocator);
+
+  return stats;
+}
+
+Metrics TransMDList::GetMetrics() {
+  Metrics metrics = {g_count_commit, g_count_abort, g_count_fake_abort};
+
+  metrics.parts = METRICS_TRAVERSAL | METRICS_MEMORY;
+  metrics.traversal = m_traversal.Sum();
+  metrics.memory = GetMemoryStats();
+
+  return metrics;
+}
@@ -0,0 +1,110 @@
+#ifndef TRANSMDLIST_H
+#define TRANSMDLIST_H
+
+#include <cstdint>
+
+#include "common/allocator.h"
+#include "common/assert.h"
+#include "common/memstats.h"
+#include "common/metrics.h"
+#include "common/threadstats.h"
+#include "translink/transbase.h"
+
+// Transactional multi-dimensional list (Zhang and Dechev, "An Efficient
+// Lock-free Logarithmic Search Data Structure Based on Multi-dimensional
+// List"). A key is split into DIMENSION digits of base BASIS, and a node's
+// child in dimension d shares the digits before d with it and is larger in
+// digit d. A search takes at most BASIS steps per dimension, and an insert
+// is a single CAS on the predecessor plus, when the new node goes in
+// front of a node with children in lower dimensions, the adoption of those
+// children. An AdoptDesc on the new node tells other threads to finish that
+// adoption before they go through its unfinished dimensions.
+//
+// Inserts touch nothing but the predecessor and the node they displace, so
+// they contend far less than the towers of a skiplist. As in the other
+// translink structures nodes are never removed, which leaves out the delete
+// marking of the original: a delete only changes the logical status of a
+// node through its NodeDesc.
+class TransMDList : public TransBase<TransMDList> {
+ public:
+  struct Operator {
+    uint8_t type;
+    uint32_t key;
+  };
+
+  typedef TransDesc<Operator> Desc;
+  typedef TransNodeDesc<Desc> NodeDesc;
+
+  // 16 digits of 2 bits cover the 32 bit keys
+  static const uint32_t DIMENSION = 16;
+  static const uint32_t BASIS = 4;
+
+  struct Node;
+
+  // Children of curr in dimensions [pred_dim, curr_dim) move to the new node
+  struct AdoptDesc {
+    Node* curr;
+    uint32_t pred_dim;
+    uint32_t curr_dim;
+  };
+
+  struct Node {
+    uint32_t key;
+    uint8_t coord[DIMENSION];
+    NodeDesc* nodeDesc;
+
+    AdoptDesc* volatile adesc;
+    Node* volatile child[DIMENSION];
+  };
+
+  TransMDList(Allocator<Node>* nodeAllocator,
+              Allocator<AdoptDesc>* adoptDescAllocator,
+              Allocator<Desc>* descAllocator,
+              Allocator<NodeDesc>* nodeDescAllocator);
+  ~TransMDList();
+
+  bool ExecuteOps(Desc* desc);
+
+  Desc* AllocateDesc(uint32_t size);
+
+  Metrics GetMetrics();
+
+  TraversalStats GetTraversalStats() const { return m_traversal.Sum(); }
+
+  MemoryStats GetMemoryStats();
+
+  // Keys in order, one per line, as script/verifymdlist.py reads them
+  void Print();
+
+ private:
+  friend class TransBase<TransMDList>;
+
+  ReturnCode RunOp(Desc* desc, uint32_t opid);
+  ReturnCode Insert(uint32_t key, Desc* desc, uint32_t opid);
+  ReturnCode Delete(uint32_t key, Desc* desc, uint32_t opid);
+  ReturnCode Find(uint32_t key, Desc* desc, uint32_t opid);
+
+
+  void KeyToCoord(uint32_t key, uint8_t coord[]);
+  void LocatePred(const uint8_t coord[], Node*& pred, Node*& curr,
+                  uint32_t& dp, uint32_t& dc);
+  void FillNewNode(Node* node, AdoptDesc*& adesc, Node* curr, uint32_t dp,
+                   uint32_t dc);
+  void FinishInserting(Node* node, AdoptDesc* adesc);
+  void PrintNode(Node* node);
+  void CollectStats(Node* node, MemoryStats& stats);
+
+ private:
+  // The head has all digits 0, so it doubles as the node of key 0. It starts
+  // out with a NodeDesc of an aborted insert, which leaves the key absent.
+  Node* m_head;
+
+  Allocator<Node>* m_nodeAllocator;
+  Allocator<AdoptDesc>* m_adoptDescAllocator;
+  Allocator<Desc>* m_descAllocator;
+  Allocator<NodeDesc>* m_nodeDescAllocator;
+
+  ThreadStats<TraversalStats> m_traversal;
+};
+
+#endif /* end of include guard: TRANSMDLIST_H */
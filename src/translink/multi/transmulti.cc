@@ -0,0 +1,330 @@
+//------------------------------------------------------------------------------
+//
+//
+//
+//------------------------------------------------------------------------------
+
+#include "translink/multi/transmulti.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+// The containers read the shared Desc through their own types
+static_assert(offsetof(TransEntryList::Desc, ops) == offsetof(Desc, ops) &&
+                  sizeof(TransEntryList::Operator) == sizeof(Operator) &&
+                  offsetof(TransEntryList::Operator, key) ==
+                      offsetof(Operator, key),
+              "TransEntryList ops must line up with TransSkip ops");
+static_assert(offsetof(TransMulti::Map::Desc, ops) == offsetof(Desc, ops) &&
+                  sizeof(TransMulti::Map::Operator) == sizeof(Operator) &&
+                  offsetof(TransMulti::Map::Operator, key) ==
+                      offsetof(Operator, key) &&
+                  offsetof(TransMulti::Map::Operator, value) ==
+                      offsetof(Operator, value),
+              "TransMap ops must line up with TransSkip ops");
+static_assert(offsetof(TransQueue::Desc, ops) == offsetof(Desc, ops) &&
+                  sizeof(TransQueue::Operator) == sizeof(Operator) &&
+                  offsetof(TransQueue::Operator, node) ==
+                      offsetof(Operator, key) &&
+                  offsetof(TransQueue::Operator, value) ==
+                      offsetof(Operator, value),
+              "TransQueue ops must line up with TransSkip ops");
+static_assert(offsetof(TransVector::Desc, ops) == offsetof(Desc, ops) &&
+                  sizeof(TransVector::Operator) == sizeof(Operator) &&
+                  offsetof(TransVector::Operator, index) ==
+                      offsetof(Operator, key) &&
+                  offsetof(TransVector::Operator, value) ==
+                      offsetof(Operator, value),
+              "TransVector ops must line up with TransSkip ops");
+static_assert((int)TransQueue::ENQUEUE == (int)TransMulti::INSERT &&
+                  (int)TransQueue::DEQUEUE == (int)TransMulti::DELETE,
+              "Queue ops must keep the codes TransMulti hands them");
+static_assert((int)TransVector::READ == (int)TransMulti::FIND &&
+                  (int)TransVector::PUSH == (int)TransMulti::INSERT &&
+                  (int)TransVector::POP == (int)TransMulti::DELETE &&
+                  (int)TransVector::WRITE == (int)TransMulti::UPDATE,
+              "Vector ops must keep the codes TransMulti hands them");
+
+thread_local HelpStack<TransMulti::Desc> multiHelpStack;
+
+// Lists and skips do not pass a thread id along when they hand helping over,
+// maps need one
+__thread int multiThreadId;
+
+TransMulti::TransMulti(Allocator<Desc>* descAllocator)
+    : m_descAllocator(descAllocator) {}
+
+uint32_t TransMulti::Attach(TransEntryList* list) {
+  Container c = {LIST, list};
+  list->SetOwner(this, HelpList);
+  m_containers.push_back(c);
+
+  return m_containers.size() - 1;
+}
+
+uint32_t TransMulti::Attach(trans_skip* skip) {
+  Container c = {SKIP, skip};
+  transskip_set_owner(skip, this, HelpSkip);
+  m_containers.push_back(c);
+
+  return m_containers.size() - 1;
+}
+
+uint32_t TransMulti::Attach(Map* map) {
+  Container c = {MAP, map};
+  map->SetOwner(this, HelpMap);
+  m_containers.push_back(c);
+
+  return m_containers.size() - 1;
+}
+
+uint32_t TransMulti::Attach(TransQueue* queue) {
+  Container c = {QUEUE, queue};
+  queue->SetOwner(this, HelpBase);
+  m_containers.push_back(c);
+
+  return m_containers.size() - 1;
+}
+
+uint32_t TransMulti::Attach(TransVector* vector) {
+  Container c = {VECTOR, vector};
+  vector->SetOwner(this, HelpBase);
+  m_containers.push_back(c);
+
+  return m_containers.size() - 1;
+}
+
+TransMulti::Desc* TransMulti::AllocateDesc(uint32_t size) {
+  Desc* desc = m_descAllocator->Alloc();
+  desc->size = size;
+  desc->status = ACTIVE;
+
+  return desc;
+}
+
+bool TransMulti::ExecuteOps(Desc* desc, int threadId) {
+  const uint32_t* targets = Targets(desc);
+
+  // No other thread sees the Desc yet, so the ops can still be turned into
+  // the codes of their containers
+  for (uint32_t i = 0; i < desc->size; i++) {
+    uint8_t type = desc->ops[i].type;
+
+    if (targets[i] >= m_containers.size()) {
+      continue;
+    }
+
+    Kind kind = m_containers[targets[i]].kind;
+
+    if ((type == UPDATE && kind == LIST) ||
+        (kind == QUEUE && type != INSERT && type != DELETE)) {
+      desc->status = ABORTED;
+      __sync_fetch_and_add(&g_count_abort, 1);
+
+      return false;
+    }
+
+    if (type == UPDATE && kind == SKIP) {
+      desc->ops[i].type = OP_UPDATE;
+    } else if (kind == QUEUE) {
+      // The key of the op is where the queue keeps its node
+      desc->ops[i].key = 0;
+    }
+  }
+
+  multiHelpStack.Init();
+  multiThreadId = threadId;
+
+  CountSizes(desc, true);
+
+  HelpOps(desc, 0, threadId);
+
+  CountSizes(desc, false);
+
+  return desc->status != ABORTED;
+}
+
+// Begins or ends the share of desc on the size counter of each container it
+// has ops on, once per container. Queues and vectors keep no size.
+void TransMulti::CountSizes(Desc* desc, bool begin) {
+  const uint32_t* targets = Targets(desc);
+
+  for (uint32_t i = 0; i < desc->size; i++) {
+    uint32_t target = targets[i];
+    uint32_t first = 0;
+
+    while (targets[first] != target) {
+      first++;
+    }
+
+    if (first < i || target >= m_containers.size()) {
+      continue;
+    }
+
+    const Container& c = m_containers[target];
+
+    if (c.kind == LIST) {
+      SizeCounter<TransEntryList::Desc>& size =
+          static_cast<TransEntryList*>(c.container)->GetSizeCounter();
+
+      if (begin) {
+        size.Begin(reinterpret_cast<TransEntryList::Desc*>(desc), target);
+      } else {
+        size.End();
+      }
+    } else if (c.kind == SKIP) {
+      SizeCounter<Desc>& size = static_cast<trans_skip*>(c.container)->size;
+
+      if (begin) {
+        size.Begin(desc, target);
+      } else {
+        size.End();
+      }
+    } else if (c.kind == MAP) {
+      SizeCounter<Map::Desc>& size =
+          static_cast<Map*>(c.container)->GetSizeCounter();
+
+      if (begin) {
+        size.Begin(reinterpret_cast<Map::Desc*>(desc), target);
+      } else {
+        size.End();
+      }
+    }
+  }
+}
+
+void TransMulti::HelpList(void* multi, TransEntryList::Desc* desc,
+                          uint32_t opid) {
+  static_cast<TransMulti*>(multi)->HelpOps(reinterpret_cast<Desc*>(desc), opid,
+                                           multiThreadId);
+}
+
+void TransMulti::HelpSkip(void* multi, Desc* desc, uint32_t opid) {
+  static_cast<TransMulti*>(multi)->HelpOps(desc, opid, multiThreadId);
+}
+
+void TransMulti::HelpMap(void* multi, Map::Desc* desc, uint32_t opid,
+                         int threadId) {
+  static_cast<TransMulti*>(multi)->HelpOps(reinterpret_cast<Desc*>(desc), opid,
+                                           threadId);
+}
+
+void TransMulti::HelpBase(void* multi, void* desc, uint32_t opid) {
+  static_cast<TransMulti*>(multi)->HelpOps(static_cast<Desc*>(desc), opid,
+                                           multiThreadId);
+}
+
+inline void TransMulti::HelpOps(Desc* desc, uint32_t opid, int threadId) {
+  if (desc->status != ACTIVE) {
+    return;
+  }
+
+  // Cyclic dependcy check
+  if (multiHelpStack.Contain(desc)) {
+    if (__sync_bool_compare_and_swap(&desc->status, ACTIVE, ABORTED)) {
+      __sync_fetch_and_add(&g_count_abort, 1);
+      __sync_fetch_and_add(&g_count_fake_abort, 1);
+    }
+
+    return;
+  }
+
+  bool ret = true;
+
+  multiHelpStack.Push(desc);
+
+  while (desc->status == ACTIVE && ret && opid < desc->size) {
+    ret = ExecuteOp(desc, opid, threadId);
+
+    opid++;
+  }
+
+  multiHelpStack.Pop();
+
+  if (ret) {
+    if (__sync_bool_compare_and_swap(&desc->status, ACTIVE, COMMITTED)) {
+      __sync_fetch_and_add(&g_count_commit, 1);
+    }
+  } else {
+    if (__sync_bool_compare_and_swap(&desc->status, ACTIVE, ABORTED)) {
+      __sync_fetch_and_add(&g_count_abort, 1);
+    }
+  }
+}
+
+inline bool TransMulti::ExecuteOp(Desc* desc, uint32_t opid, int threadId) {
+  uint32_t target = Targets(desc)[opid];
+
+  if (target >= m_containers.size()) {
+    return false;
+  }
+
+  const Container& c = m_containers[target];
+
+  if (c.kind == LIST) {
+    return static_cast<TransEntryList*>(c.container)
+        ->ExecuteOp(reinterpret_cast<TransEntryList::Desc*>(desc), opid);
+  } else if (c.kind == SKIP) {
+    return transskip_execute_op(static_cast<trans_skip*>(c.container), desc,
+                                opid);
+  } else if (c.kind == QUEUE) {
+    return static_cast<TransQueue*>(c.container)
+        ->ExecuteOp(reinterpret_cast<TransQueue::Desc*>(desc), opid);
+  } else if (c.kind == VECTOR) {
+    return static_cast<TransVector*>(c.container)
+        ->ExecuteOp(reinterpret_cast<TransVector::Desc*>(desc), opid);
+  }
+
+  Map* map = static_cast<Map*>(c.container);
+  Map::Desc* mapDesc = reinterpret_cast<Map::Desc*>(desc);
+  const Operator& op = desc->ops[opid];
+
+  if (op.type == INSERT) {
+    return map->Insert(mapDesc, opid, op.key, op.value, threadId);
+  } else if (op.type == DELETE) {
+    return map->Delete(mapDesc, opid, op.key, threadId);
+  } else if (op.type == UPDATE) {
+    return map->Update(mapDesc, opid, op.key, op.value, threadId);
+  } else {
+    return map->Find(mapDesc, opid, op.key, threadId) != 0;
+  }
+}
+
+// Traversal and memory are summed over the containers
+Metrics TransMulti::GetMetrics() {
+  Metrics metrics = {g_count_commit, g_count_abort, g_count_fake_abort};
+
+  metrics.parts = METRICS_TRAVERSAL | METRICS_MEMORY;
+
+  for (uint32_t i = 0; i < m_containers.size(); i++) {
+    const Container& c = m_containers[i];
+
+    if (c.kind == LIST) {
+      TransEntryList* list = static_cast<TransEntryList*>(c.container);
+      metrics.traversal += list->GetTraversalStats();
+      metrics.memory += list->GetMemoryStats();
+    } else if (c.kind == SKIP) {
+      trans_skip* skip = static_cast<trans_skip*>(c.container);
+      metrics.traversal += GetTraversalStats(skip);
+      metrics.memory += GetMemoryStats(skip);
+
+      // The GC is shared by all skips
+      if ((metrics.parts & METRICS_GC) == 0) {
+        metrics.parts |= METRICS_GC;
+        fr_gc_get_stats(&metrics.gc);
+      }
+    } else if (c.kind == QUEUE) {
+      TransQueue* queue = static_cast<TransQueue*>(c.container);
+      metrics.traversal += queue->GetTraversalStats();
+      metrics.memory += queue->GetMemoryStats();
+    } else if (c.kind == VECTOR) {
+      TransVector* vector = static_cast<TransVector*>(c.container);
+      metrics.traversal += vector->GetTraversalStats();
+      metrics.memory += vector->GetMemoryStats();
+    } else {
+      metrics.memory += static_cast<Map*>(c.container)->GetMemoryStats();
+    }
+  }
+
+  return metrics;
+}
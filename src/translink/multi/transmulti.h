@@ -0,0 +1,96 @@
+#ifndef TRANSMULTI_H
+#define TRANSMULTI_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include "common/allocator.h"
+#include "common/assert.h"
+#include "common/helpstack.h"
+#include "common/metrics.h"
+#include "translink/list/translist.h"
+#include "translink/map/transmap.h"
+#include "translink/queue/transqueue.h"
+#include "translink/skiplist/transskip.h"
+#include "translink/vector/transvector.h"
+
+// Transactions across several containers. TransSkip, TransEntryList,
+// BasicTransMap<uint64_t, uint64_t>, TransQueue and TransVector lay out their
+// descriptors the same way, so one TransSkip Desc can carry ops for all of
+// them, and moving a key from a TransSkip index into a TransMap, or out of a
+// TransMap onto a TransQueue, commits or aborts as a whole. Like in
+// TransGraph, the container of each op is kept in a target array right behind
+// the ops, and the containers hand helping over to TransMulti, as only it can
+// tell where an op of another transaction goes.
+//
+// Containers are attached before any transaction runs, and from then on every
+// transaction on them has to go through TransMulti. Ops use the OpType codes
+// below whatever the container. UPDATE is for skips and maps, DELETEMIN is not
+// supported, and FIND leaves the value it found in its op for skips and maps.
+// On a queue INSERT enqueues the value of its op and DELETE dequeues into it,
+// and only those two are taken. On a vector FIND reads the slot at the key of
+// its op into its value, INSERT pushes and DELETE pops the value, and UPDATE
+// writes it.
+class TransMulti {
+ public:
+  typedef ::Desc Desc;
+  typedef BasicTransMap<uint64_t, uint64_t> Map;
+
+  enum OpStatus { ACTIVE = 0, COMMITTED, ABORTED };
+
+  enum OpType { FIND = 0, INSERT, DELETE, UPDATE };
+
+  TransMulti(Allocator<Desc>* descAllocator);
+
+  // Each returns the target that sends an op to the container
+  uint32_t Attach(TransEntryList* list);
+  uint32_t Attach(trans_skip* skip);
+  uint32_t Attach(Map* map);
+  uint32_t Attach(TransQueue* queue);
+  uint32_t Attach(TransVector* vector);
+
+  static size_t SizeOf(uint32_t size) {
+    return Desc::SizeOf(size) + sizeof(uint32_t) * size;
+  }
+
+  static uint32_t* Targets(Desc* desc) {
+    return reinterpret_cast<uint32_t*>(&desc->ops[desc->size]);
+  }
+
+  Desc* AllocateDesc(uint32_t size);
+
+  bool ExecuteOps(Desc* desc, int threadId);
+
+  Metrics GetMetrics();
+
+ private:
+  enum Kind { LIST = 0, SKIP, MAP, QUEUE, VECTOR };
+
+  struct Container {
+    Kind kind;
+    void* container;
+  };
+
+  static void HelpList(void* multi, TransEntryList::Desc* desc, uint32_t opid);
+  static void HelpSkip(void* multi, Desc* desc, uint32_t opid);
+  static void HelpMap(void* multi, Map::Desc* desc, uint32_t opid,
+                      int threadId);
+  // For the containers on TransBase, queues and vectors
+  static void HelpBase(void* multi, void* desc, uint32_t opid);
+  void HelpOps(Desc* desc, uint32_t opid, int threadId);
+  bool ExecuteOp(Desc* desc, uint32_t opid, int threadId);
+  void CountSizes(Desc* desc, bool begin);
+
+ private:
+  Allocator<Desc>* m_descAllocator;
+
+  std::vector<Container> m_containers;
+
+  uint32_t g_count_commit = 0;
+  uint32_t g_count_abort = 0;
+  uint32_t g_count_fake_abort = 0;
+};
+
+#endif /* end of include guard: TRANSMULTI_H */
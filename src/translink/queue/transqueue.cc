@@ -0,0 +1,238 @@
+//------------------------------------------------------------------------------
+//
+//
+//
+//------------------------------------------------------------------------------
+
+#include "translink/queue/transqueue.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+TransQueue::TransQueue(Allocator<Node>* nodeAllocator,
+                       Allocator<Desc>* descAllocator,
+                       Allocator<NodeDesc>* nodeDescAllocator)
+    : m_head(new Node()),
+      m_tail(m_head),
+      m_nodeAllocator(nodeAllocator),
+      m_descAllocator(descAllocator),
+      m_nodeDescAllocator(nodeDescAllocator) {}
+
+TransQueue::~TransQueue() {}
+
+TransQueue::Desc* TransQueue::AllocateDesc(uint32_t size) {
+  Desc* desc = m_descAllocator->Alloc();
+  desc->size = size;
+  desc->status = ACTIVE;
+
+  for (uint32_t i = 0; i < size; i++) {
+    desc->ops[i].node = NULL;
+  }
+
+  return desc;
+}
+
+bool TransQueue::ExecuteOps(Desc* desc) { return ExecuteDesc(desc); }
+
+TransQueue::ReturnCode TransQueue::RunOp(Desc* desc, uint32_t opid) {
+  const Operator& op = desc->ops[opid];
+
+  if (op.type == ENQUEUE) {
+    return Enqueue(desc, opid);
+  } else {
+    return Dequeue(desc, opid);
+  }
+}
+
+inline TransQueue::ReturnCode TransQueue::Enqueue(Desc* desc, uint32_t opid) {
+  Operator& op = desc->ops[opid];
+
+  if (op.node == NULL) {
+    NodeDesc* nodeDesc =
+        new (m_nodeDescAllocator->Alloc()) NodeDesc(desc, opid);
+    Node* node = new (m_nodeAllocator->Alloc()) Node(op.value, nodeDesc);
+
+    // The first helper decides which node goes in
+    __sync_bool_compare_and_swap(&op.node, NULL, node);
+  }
+
+  Node* node = op.node;
+
+  while (!node->linked) {
+    Node* last = m_tail;
+    Node* next = last->next;
+
+    if (last != m_tail) {
+      continue;
+    }
+
+    if (next == NULL) {
+      if (desc->status != ACTIVE) {
+        return FAIL;
+      }
+
+      // A helper that read the tail before our node went in finds it no
+      // longer last, one that reads it later finds the node flagged
+      if (!node->linked &&
+          __sync_bool_compare_and_swap(&last->next, NULL, node)) {
+        FinishLink(last);
+        return OK;
+      }
+
+      m_traversal.Local().restarts++;
+    } else {
+      FinishLink(last);
+    }
+  }
+
+  return OK;
+}
+
+inline TransQueue::ReturnCode TransQueue::Dequeue(Desc* desc, uint32_t opid) {
+  NodeDesc* nodeDesc = new (m_nodeDescAllocator->Alloc()) NodeDesc(desc, opid);
+  Operator& op = desc->ops[opid];
+
+  while (true) {
+    Node* node = op.node;
+
+    // Like the node of an enqueue, the item is picked once for all helpers.
+    // A helper running late could otherwise take a second item after the
+    // first one is already past the head.
+    if (node == NULL) {
+      node = FirstQueued(desc);
+
+      if (node == NULL) {
+        return FAIL;
+      }
+
+      if (!__sync_bool_compare_and_swap(&op.node, NULL, node)) {
+        continue;
+      }
+    }
+
+    NodeDesc* oldCurrDesc = node->nodeDesc;
+
+    if (IsSameOperation(oldCurrDesc, nodeDesc)) {
+      op.value = node->value;
+      return SKIP;
+    }
+
+    FinishPendingTxn(oldCurrDesc, desc);
+
+    // Another transaction got it first, pick again
+    if (oldCurrDesc->desc == desc || !IsItemQueued(oldCurrDesc)) {
+      __sync_bool_compare_and_swap(&op.node, node, NULL);
+      m_traversal.Local().restarts++;
+      continue;
+    }
+
+    if (desc->status != ACTIVE) {
+      return FAIL;
+    }
+
+    if (__sync_bool_compare_and_swap(&node->nodeDesc, oldCurrDesc, nodeDesc)) {
+      op.value = node->value;
+      return OK;
+    }
+  }
+}
+
+// First item that is queued once the transactions holding the nodes in
+// front of it are settled, or NULL when there is none. Nodes desc holds are
+// passed over.
+inline TransQueue::Node* TransQueue::FirstQueued(Desc* desc) {
+  Node* prev = m_head;
+  Node* curr = prev->next;
+  bool front = true;
+  uint64_t visited = 0;
+
+  for (; curr != NULL; prev = curr, curr = curr->next) {
+    NodeDesc* oldCurrDesc = curr->nodeDesc;
+    visited++;
+
+    // Our own earlier operations hold this one, it can not be dequeued and
+    // nothing behind it is gone for good yet
+    if (oldCurrDesc->desc == desc) {
+      front = false;
+      continue;
+    }
+
+    FinishPendingTxn(oldCurrDesc, desc);
+
+    if (IsItemQueued(oldCurrDesc)) {
+      break;
+    }
+
+    m_traversal.Local().markedSkipped++;
+
+    // Dequeued or never committed, so the head can move past it. It must
+    // not pass the tail, whose link may still be unfinished.
+    if (front) {
+      if (prev == m_tail) {
+        FinishLink(prev);
+      }
+
+      if (!__sync_bool_compare_and_swap(&m_head, prev, curr)) {
+        m_traversal.Local().unlinkCasFailures++;
+        front = false;
+      }
+    }
+  }
+
+  TraversalStats& stats = m_traversal.Local();
+  stats.searches++;
+  stats.visited += visited;
+
+  return curr;
+}
+
+// Flags the node after last as linked, then swings the tail to it
+inline void TransQueue::FinishLink(Node* last) {
+  Node* next = last->next;
+
+  if (next != NULL) {
+    next->linked = true;
+    __sync_bool_compare_and_swap(&m_tail, last, next);
+  }
+}
+
+inline bool TransQueue::IsItemQueued(NodeDesc* nodeDesc) {
+  bool isNodeActive = IsNodeActive(nodeDesc);
+  uint8_t opType = nodeDesc->desc->ops[nodeDesc->opid].type;
+
+  return (isNodeActive && opType == ENQUEUE) ||
+         (!isNodeActive && opType == DEQUEUE);
+}
+
+MemoryStats TransQueue::GetMemoryStats() {
+  MemoryStats stats = {};
+
+  for (Node* curr = m_head->next; curr != NULL; curr = curr->next) {
+    if (IsItemQueued(curr->nodeDesc)) {
+      stats.liveNodes++;
+    } else {
+      stats.deletedNodes++;
+    }
+  }
+
+  stats.descriptors = m_descAllocator->Allocated();
+
+  // The first dummy comes from the heap, everything else from the pools
+  stats.AddHeap(sizeof(Node));
+  stats.AddPool(m_nodeAllocator);
+  stats.AddPool(m_descAllocator);
+  stats.AddPool(m_nodeDescAllocator);
+
+  return stats;
+}
+
+Metrics TransQueue::GetMetrics() {
+  Metrics metrics = {g_count_commit, g_count_abort, g_count_fake_abort};
+
+  metrics.parts = METRICS_TRAVERSAL | METRICS_MEMORY;
+  metrics.traversal = m_traversal.Sum();
+  metrics.memory = GetMemoryStats();
+
+  return metrics;
+}
@@ -0,0 +1,92 @@
+#ifndef TRANSQUEUE_H
+#define TRANSQUEUE_H
+
+#include <cstdint>
+
+#include "common/allocator.h"
+#include "common/assert.h"
+#include "common/memstats.h"
+#include "common/metrics.h"
+#include "common/threadstats.h"
+#include "translink/transbase.h"
+
+// Transactional FIFO queue on the Michael-Scott linked queue. An enqueue links
+// a node tagged with its NodeDesc at the tail, and the item only counts as
+// queued once that transaction commits. A dequeue claims the first queued
+// item by swapping in its own NodeDesc, so the item leaves the queue when the
+// dequeuing transaction commits and is back in place if it aborts. Dequeues
+// help the live transactions they meet at the front before passing them, so
+// items come out in the order their enqueues committed.
+//
+// Helpers of an operation must all work on a single node. The op records the
+// node an enqueue links or a dequeue claims, and the Kogan-Petrank flag on a
+// node tells late helpers of an enqueue it is already in, as the tail only
+// moves past a node after flagging it.
+class TransQueue : public TransBase<TransQueue> {
+ public:
+  enum OpType { ENQUEUE = 1, DEQUEUE };
+
+  struct Node;
+
+  // Laid out like the ops of TransSkip, so TransMulti can carry queue ops in
+  // its Desc
+  struct Operator {
+    uint8_t type;
+    Node* volatile node;  // the node every helper links or claims
+    uint64_t value;  // for DEQUEUE, the removed item once it succeeds
+  };
+
+  typedef TransDesc<Operator> Desc;
+  typedef TransNodeDesc<Desc> NodeDesc;
+
+  struct Node {
+    Node() : value(0), nodeDesc(NULL), next(NULL), linked(true) {}
+    Node(uint64_t _value, NodeDesc* _nodeDesc)
+        : value(_value), nodeDesc(_nodeDesc), next(NULL), linked(false) {}
+
+    uint64_t value;
+    NodeDesc* nodeDesc;
+
+    Node* next;
+    volatile bool linked;
+  };
+
+  TransQueue(Allocator<Node>* nodeAllocator, Allocator<Desc>* descAllocator,
+             Allocator<NodeDesc>* nodeDescAllocator);
+  ~TransQueue();
+
+  bool ExecuteOps(Desc* desc);
+
+  Desc* AllocateDesc(uint32_t size);
+
+  Metrics GetMetrics();
+
+  TraversalStats GetTraversalStats() const { return m_traversal.Sum(); }
+
+  MemoryStats GetMemoryStats();
+
+ private:
+  friend class TransBase<TransQueue>;
+
+  ReturnCode RunOp(Desc* desc, uint32_t opid);
+  ReturnCode Enqueue(Desc* desc, uint32_t opid);
+  ReturnCode Dequeue(Desc* desc, uint32_t opid);
+
+  bool IsItemQueued(NodeDesc* nodeDesc);
+  Node* FirstQueued(Desc* desc);
+  void FinishLink(Node* last);
+
+ private:
+  // Both point at a dummy node when the queue is empty. Dequeues move the
+  // head past items that are gone for good, the dummy being the last of them
+  Node* volatile m_head;
+  Node* volatile m_tail;
+
+  Allocator<Node>* m_nodeAllocator;
+  Allocator<Desc>* m_descAllocator;
+  Allocator<NodeDesc>* m_nodeDescAllocator;
+
+  ThreadStats<TraversalStats> m_traversal;
+};
+
+#endif /* end of include guard: TRANSQUEUE_H */
@@ -29,51 +29,32 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <new>
 #include <vector>
 extern "C" {
 #include "common/fraser/portable_defns.h"
 #include "common/fraser/ptst.h"
 }
+#include "common/helpstack.h"
 #include "transskip.h"
 
 #define SET_MARK(_p) ((node_t*)(((uintptr_t)(_p)) | 1))
+#define SET_MARKD(_p) ((NodeDesc*)(((uintptr_t)(_p)) | 1))
 #define CLR_MARKD(_p) ((NodeDesc*)(((uintptr_t)(_p)) & ~1))
 #define IS_MARKED(_p) (((uintptr_t)(_p)) & 1)
 
-struct HelpStack {
-  void Init() { index = 0; }
-
-  void Push(Desc* desc) {
-    ASSERT(index < 255, "index out of range");
-
-    helps[index++] = desc;
-  }
-
-  void Pop() {
-    ASSERT(index > 0, "nothing to pop");
-
-    index--;
-  }
-
-  bool Contain(Desc* desc) {
-    for (uint8_t i = 0; i < index; i++) {
-      if (helps[i] == desc) {
-        return true;
-      }
-    }
-
-    return false;
-  }
-
-  Desc* helps[256];
-  uint8_t index;
-};
-
-static __thread HelpStack helpStack;
+static thread_local HelpStack<Desc> helpStack;
 
 enum OpStatus { LIVE = 0, COMMITTED, ABORTED };
 
-enum OpType { FIND = 0, INSERT, DELETE };
+enum OpType {
+  FIND = 0,
+  INSERT,
+  DELETE,
+  DELETEMIN = OP_DELETEMIN,
+  UPDATE = OP_UPDATE,
+  RANGE = OP_RANGE
+};
 
 static int gc_id[NUM_LEVELS];
 
@@ -81,11 +62,15 @@ static uint32_t g_count_commit = 0;
 static uint32_t g_count_abort = 0;
 static uint32_t g_count_fake_abort = 0;
 
+static ThreadStats<TraversalStats> g_traversal;
+
 /*
  * PRIVATE FUNCTIONS
  */
 
-static bool help_ops(trans_skip* l, Desc* desc, uint8_t opid);
+static bool help_ops(trans_skip* l, Desc* desc, uint32_t opid);
+static void help_dynamic(trans_skip* l, Desc* desc, uint32_t opid);
+static void save_result(NodeDesc* nodeDesc);
 
 static inline bool FinishPendingTxn(trans_skip* l, NodeDesc* nodeDesc,
                                     Desc* desc) {
@@ -95,7 +80,15 @@ static inline bool FinishPendingTxn(trans_skip* l, NodeDesc* nodeDesc,
   }
 
   if (nodeDesc->desc->status == LIVE) {
-    help_ops(l, nodeDesc->desc, nodeDesc->opid + 1);
+    if (l->owner != NULL) {
+      l->help(l->owner, nodeDesc->desc, nodeDesc->opid + 1);
+    } else if (nodeDesc->desc->ops[nodeDesc->opid].type & OP_DYNAMIC) {
+      /* The op that got here may not have told the others what it found */
+      save_result(nodeDesc);
+      help_dynamic(l, nodeDesc->desc, nodeDesc->opid + 1);
+    } else {
+      help_ops(l, nodeDesc->desc, nodeDesc->opid + 1);
+    }
   }
 
   return true;
@@ -105,12 +98,64 @@ static inline bool IsNodeActive(NodeDesc* nodeDesc) {
   return nodeDesc->desc->status == COMMITTED;
 }
 
+/* Whether the key is there once the op of a dynamic transaction is done. */
+static inline bool PresentAfter(NodeDesc* nodeDesc) {
+  uint8_t opType = nodeDesc->desc->ops[nodeDesc->opid].type & ~OP_DYNAMIC;
+
+  return opType == INSERT || (opType != DELETE && nodeDesc->present);
+}
+
+/* Value of the key once the op of a dynamic transaction is done. */
+static inline uint64_t ValueAfter(NodeDesc* nodeDesc) {
+  const Operator& op = nodeDesc->desc->ops[nodeDesc->opid];
+  uint8_t opType = op.type & ~OP_DYNAMIC;
+
+  if ((opType == INSERT && !nodeDesc->present) ||
+      (opType == UPDATE && nodeDesc->present)) {
+    return op.value;
+  }
+
+  return nodeDesc->value;
+}
+
 static inline bool IsKeyExist(NodeDesc* nodeDesc) {
   bool isNodeActive = IsNodeActive(nodeDesc);
   uint8_t opType = nodeDesc->desc->ops[nodeDesc->opid].type;
 
-  return (opType == FIND) || (isNodeActive && opType == INSERT) ||
-         (!isNodeActive && opType == DELETE);
+  if (opType & OP_DYNAMIC) {
+    return isNodeActive ? PresentAfter(nodeDesc) : nodeDesc->original;
+  }
+
+  return (opType == FIND) || (opType == UPDATE) ||
+         (isNodeActive && opType == INSERT) ||
+         (!isNodeActive && (opType == DELETE || opType == DELETEMIN));
+}
+
+/* Value of a key @nodeDesc keeps present. */
+static inline uint64_t CurrentValue(NodeDesc* nodeDesc) {
+  const Operator& op = nodeDesc->desc->ops[nodeDesc->opid];
+
+  if (op.type & OP_DYNAMIC) {
+    return IsNodeActive(nodeDesc) ? ValueAfter(nodeDesc) : nodeDesc->value;
+  }
+
+  if (IsNodeActive(nodeDesc) && (op.type == INSERT || op.type == UPDATE)) {
+    return op.value;
+  }
+
+  return nodeDesc->value;
+}
+
+/*
+ * Value the key had before @desc touched it, which is what it gets back if
+ * @desc aborts. Earlier operations of @desc already recorded it.
+ */
+static inline uint64_t PriorValue(NodeDesc* nodeDesc, Desc* desc) {
+  if (nodeDesc->desc == desc) {
+    return nodeDesc->value;
+  }
+
+  return CurrentValue(nodeDesc);
 }
 
 static inline bool IsSameOperation(NodeDesc* nodeDesc1, NodeDesc* nodeDesc2) {
@@ -165,8 +210,15 @@ static node_t* strong_search_predecessors(trans_skip* l, setkey_t k,
   node_t *x, *x_next, *old_x_next, *y, *y_next;
   setkey_t y_k;
   int i;
+  /* Counted locally, published once per search. */
+  uint64_t visited = 0, marked_skipped = 0, restarts = 0, cas_failures = 0;
+
+  goto start;
 
 retry:
+  restarts++;
+
+start:
   RMB();
 
   x = &l->head;
@@ -177,11 +229,15 @@ retry:
     if (is_marked_ref(x_next)) goto retry;
 
     for (y = x_next;; y = y_next) {
+      visited++;
+
       /* Shift over a sequence of marked nodes. */
       for (;;) {
         READ_FIELD(y_next, y->next[i]);
         if (!is_marked_ref(y_next)) break;
         y = (node_t*)get_unmarked_ref(y_next);
+        visited++;
+        marked_skipped++;
       }
 
       READ_FIELD(y_k, y->k);
@@ -195,13 +251,23 @@ retry:
     /* Swing forward pointer over any marked nodes. */
     if (x_next != y) {
       old_x_next = CASPO(&x->next[i], x_next, y);
-      if (old_x_next != x_next) goto retry;
+      if (old_x_next != x_next) {
+        cas_failures++;
+        goto retry;
+      }
     }
 
     if (pa) pa[i] = x;
     if (na) na[i] = y;
   }
 
+  TraversalStats& stats = g_traversal.Local();
+  stats.searches++;
+  stats.visited += visited;
+  stats.markedSkipped += marked_skipped;
+  stats.restarts += restarts;
+  stats.unlinkCasFailures += cas_failures;
+
   return (y);
 }
 
@@ -211,12 +277,14 @@ static node_t* weak_search_predecessors(trans_skip* l, setkey_t k, node_t** pa,
   node_t *x, *x_next;
   setkey_t x_next_k;
   int i;
+  uint64_t visited = 0;
 
   x = &l->head;
   for (i = NUM_LEVELS - 1; i >= 0; i--) {
     for (;;) {
       READ_FIELD(x_next, x->next[i]);
       x_next = (node_t*)get_unmarked_ref(x_next);
+      visited++;
 
       READ_FIELD(x_next_k, x_next->k);
       if (x_next_k >= k) break;
@@ -228,6 +296,82 @@ static node_t* weak_search_predecessors(trans_skip* l, setkey_t k, node_t** pa,
     if (na) na[i] = x_next;
   }
 
+  TraversalStats& stats = g_traversal.Local();
+  stats.searches++;
+  stats.visited += visited;
+
+  return (x_next);
+}
+
+/*
+ * Predecessors found by the last search of a transaction, at every level.
+ * While the keys of its ops ascend, each search picks up from here rather
+ * than from the head, so a sorted batch of k keys costs about one traversal
+ * and k splices. The nodes are only safe to visit while the critical region
+ * the finger was set up in is open.
+ */
+struct finger_t {
+  setkey_t k;
+  node_t* preds[NUM_LEVELS];
+};
+
+/*
+ * Ops run in one critical region before help_ops leaves it and sets the
+ * finger up again. An open region holds back the epoch, so a batch of
+ * thousands of ops would keep every thread from reclaiming until it is done.
+ * Starting over from the head costs one traversal per this many ops.
+ */
+static const uint32_t FINGER_OPS = 64;
+
+static void init_finger(trans_skip* l, finger_t* f) {
+  f->k = SENTINEL_KEYMIN;
+
+  for (int i = 0; i < NUM_LEVELS; i++) {
+    f->preds[i] = &l->head;
+  }
+}
+
+/*
+ * Same as weak_search_predecessors, leaving the predecessors in @f. A key
+ * below the last one of @f starts over from the head. At each level the
+ * search starts from whichever is further on, the predecessor of @f or the
+ * one found a level up, unless the one of @f has been deleted at that level.
+ */
+static node_t* finger_search_predecessors(trans_skip* l, setkey_t k,
+                                          finger_t* f, node_t** na) {
+  node_t *x, *x_next, *y;
+  setkey_t x_next_k;
+  int i;
+  uint64_t visited = 0;
+
+  if (k < f->k) init_finger(l, f);
+
+  x = &l->head;
+  for (i = NUM_LEVELS - 1; i >= 0; i--) {
+    y = f->preds[i];
+    if (y->k > x->k && !is_marked_ref(y->next[i])) x = y;
+
+    for (;;) {
+      READ_FIELD(x_next, x->next[i]);
+      x_next = (node_t*)get_unmarked_ref(x_next);
+      visited++;
+
+      READ_FIELD(x_next_k, x_next->k);
+      if (x_next_k >= k) break;
+
+      x = x_next;
+    }
+
+    f->preds[i] = x;
+    if (na) na[i] = x_next;
+  }
+
+  f->k = k;
+
+  TraversalStats& stats = g_traversal.Local();
+  stats.searches++;
+  stats.visited += visited;
+
   return (x_next);
 }
 
@@ -283,6 +427,93 @@ retry:
   free_node(ptst, x);
 }
 
+/*
+ * Link @new_node, already in at level 1, at the levels above. @preds and
+ * @succs are from the search that linked it.
+ */
+static void link_levels(trans_skip* l, ptst_t* ptst, node_t* new_node,
+                        int level, node_t** preds, node_t** succs) {
+  node_t *pred, *succ, *new_next, *old_next;
+  setkey_t k = new_node->k;
+  int i;
+
+  /* Insert at each of the other levels in turn. */
+  i = 1;
+  while (i < level) {
+    pred = preds[i];
+    succ = succs[i];
+
+    /* Someone *can* delete @new under our feet! */
+    new_next = new_node->next[i];
+    if (is_marked_ref(new_next)) goto success;
+
+    /* Ensure forward pointer of new node is up to date. */
+    if (new_next != succ) {
+      old_next = CASPO(&new_node->next[i], new_next, succ);
+      if (is_marked_ref(old_next)) goto success;
+      assert(old_next == new_next);
+    }
+
+    /* Ensure we have unique key values at every level. */
+    if (succ->k == k) goto new_world_view;
+    assert((pred->k < k) && (succ->k > k));
+
+    /* Replumb predecessor's forward pointer. */
+    old_next = CASPO(&pred->next[i], succ, new_node);
+    if (old_next != succ) {
+    new_world_view:
+      RMB(); /* get up-to-date view of the world. */
+      (void)strong_search_predecessors(l, k, preds, succs);
+      continue;
+    }
+
+    /* Succeeded at this level. */
+    i++;
+  }
+
+success:
+  /* Ensure node is visible at all levels before punting deletion. */
+  WEAK_DEP_ORDER_WMB();
+  if (check_for_full_delete(new_node)) {
+    MB(); /* make sure we see all marks in @new. */
+    do_full_delete(ptst, l, new_node, level - 1);
+  }
+}
+
+/*
+ * Net number of keys the @share of @desc added once committed. The ops of a
+ * dynamic transaction see each other, so only those that got through count.
+ */
+static int64_t size_delta(Desc* desc, const SizeCounter<Desc>::Share& share) {
+  bool dynamic;
+  int64_t delta = 0;
+  uint32_t i;
+
+  if (desc->status != COMMITTED) return 0;
+
+  dynamic = desc->size > 0 && (desc->ops[0].type & OP_DYNAMIC);
+
+  for (i = 0; i < desc->size; i++) {
+    uint8_t type = desc->ops[i].type & ~OP_DYNAMIC;
+
+    if (dynamic && GetProgram(desc)->steps[i].result != STEP_SUCCEEDED) {
+      continue;
+    }
+
+    if (!share.Counts(desc, i)) {
+      continue;
+    }
+
+    if (type == INSERT) {
+      delta++;
+    } else if (type == DELETE || type == DELETEMIN) {
+      delta--;
+    }
+  }
+
+  return delta;
+}
+
 /*
  * PUBLIC FUNCTIONS
  */
@@ -316,27 +547,41 @@ trans_skip* transskip_alloc(Allocator<Desc>* _descAllocator,
   l->descAllocator = _descAllocator;
   l->nodeDescAllocator = _nodeDescAllocator;
 
+  l->spray_width = 0;
+
+  l->owner = NULL;
+  l->help = NULL;
+
+  l->stamp = 0;
+
+  for (i = 0; i < RANGE_SLOTS; i++) {
+    l->ranges[i] = NULL;
+  }
+
+  new (&l->size) SizeCounter<Desc>(size_delta);
+
   return (l);
 }
 
-bool transskip_insert(trans_skip* l, setkey_t k, Desc* desc, uint8_t opid,
-                      node_t*& n) {
+bool transskip_insert(trans_skip* l, setkey_t k, Desc* desc, uint32_t opid,
+                      finger_t* f, node_t*& n) {
   n = NULL;
   bool ret = false;
   NodeDesc* nodeDesc = l->nodeDescAllocator->Alloc();
   nodeDesc->desc = desc;
   nodeDesc->opid = opid;
+  nodeDesc->value = 0;
 
   ptst_t* ptst;
-  node_t *preds[NUM_LEVELS], *succs[NUM_LEVELS];
-  node_t *pred, *succ, *new_node = NULL, *new_next, *old_next;
+  node_t **preds = f->preds, *succs[NUM_LEVELS];
+  node_t *succ, *new_node = NULL, *old_next;
   int i, level;
 
   k = CALLER_TO_INTERNAL_KEY(k);
 
   ptst = fr_critical_enter();
 
-  succ = weak_search_predecessors(l, k, preds, succs);
+  succ = finger_search_predecessors(l, k, f, succs);
 
 retry:
 
@@ -428,47 +673,7 @@ retry:
     goto retry;
   }
 
-  /* Insert at each of the other levels in turn. */
-  i = 1;
-  while (i < level) {
-    pred = preds[i];
-    succ = succs[i];
-
-    /* Someone *can* delete @new under our feet! */
-    new_next = new_node->next[i];
-    if (is_marked_ref(new_next)) goto success;
-
-    /* Ensure forward pointer of new node is up to date. */
-    if (new_next != succ) {
-      old_next = CASPO(&new_node->next[i], new_next, succ);
-      if (is_marked_ref(old_next)) goto success;
-      assert(old_next == new_next);
-    }
-
-    /* Ensure we have unique key values at every level. */
-    if (succ->k == k) goto new_world_view;
-    assert((pred->k < k) && (succ->k > k));
-
-    /* Replumb predecessor's forward pointer. */
-    old_next = CASPO(&pred->next[i], succ, new_node);
-    if (old_next != succ) {
-    new_world_view:
-      RMB(); /* get up-to-date view of the world. */
-      (void)strong_search_predecessors(l, k, preds, succs);
-      continue;
-    }
-
-    /* Succeeded at this level. */
-    i++;
-  }
-
-success:
-  /* Ensure node is visible at all levels before punting deletion. */
-  WEAK_DEP_ORDER_WMB();
-  if (check_for_full_delete(new_node)) {
-    MB(); /* make sure we see all marks in @new. */
-    do_full_delete(ptst, l, new_node, level - 1);
-  }
+  link_levels(l, ptst, new_node, level, preds, succs);
 
   n = new_node;
   ret = true;
@@ -478,8 +683,8 @@ out:
   return ret;
 }
 
-bool transskip_delete(trans_skip* l, setkey_t k, Desc* desc, uint8_t opid,
-                      node_t*& n) {
+bool transskip_delete(trans_skip* l, setkey_t k, Desc* desc, uint32_t opid,
+                      finger_t* f, node_t*& n) {
   n = NULL;
   bool ret = false;
   NodeDesc* nodeDesc = NULL;
@@ -491,7 +696,7 @@ bool transskip_delete(trans_skip* l, setkey_t k, Desc* desc, uint8_t opid,
 
   ptst = fr_critical_enter();
 
-  succ = weak_search_predecessors(l, k, NULL, NULL);
+  succ = finger_search_predecessors(l, k, f, NULL);
 
 retry:
 
@@ -531,6 +736,8 @@ retry:
         goto out;
       }
 
+      nodeDesc->value = PriorValue(oldCurrDesc, desc);
+
       // if(currDesc == oldCurrDesc)
       {
         // Update desc
@@ -612,8 +819,14 @@ out:
   return (v);
 }
 
-bool transskip_find(trans_skip* l, setkey_t k, Desc* desc, uint8_t opid) {
+/*
+ * FIND and UPDATE both need the key present and take it over. A FIND also
+ * copies the value it saw into its operation.
+ */
+bool transskip_find(trans_skip* l, setkey_t k, Desc* desc, uint32_t opid,
+                    finger_t* f) {
   NodeDesc* nodeDesc = NULL;
+  Operator& op = desc->ops[opid];
 
   bool ret;
   ptst_t* ptst;
@@ -623,7 +836,7 @@ bool transskip_find(trans_skip* l, setkey_t k, Desc* desc, uint8_t opid) {
 
   ptst = fr_critical_enter();
 
-  x = weak_search_predecessors(l, k, NULL, NULL);
+  x = finger_search_predecessors(l, k, f, NULL);
 
 retry:
   if (x->k == k) {
@@ -650,10 +863,30 @@ retry:
     }
 
     if (IsSameOperation(oldCurrDesc, nodeDesc)) {
+      if (op.type == FIND) op.value = oldCurrDesc->value;
       ret = true;
       goto out;
     }
 
+    /*
+     * A key an earlier FIND or UPDATE of ours holds is ours already. Taking
+     * it over again would lose the value of that UPDATE.
+     */
+    if (op.type == FIND && oldCurrDesc->desc == desc) {
+      const Operator& own = desc->ops[oldCurrDesc->opid];
+
+      if (own.type == FIND || own.type == UPDATE) {
+        if (desc->status != LIVE) {
+          ret = false;
+          goto out;
+        }
+
+        op.value = own.value;
+        ret = true;
+        goto out;
+      }
+    }
+
     if (IsKeyExist(oldCurrDesc)) {
       NodeDesc* currDesc = x->nodeDesc;
 
@@ -662,6 +895,8 @@ retry:
         goto out;
       }
 
+      nodeDesc->value = PriorValue(oldCurrDesc, desc);
+
       // if(currDesc == oldCurrDesc)
       {
         // Update desc
@@ -669,6 +904,7 @@ retry:
             __sync_val_compare_and_swap(&x->nodeDesc, oldCurrDesc, nodeDesc);
 
         if (currDesc == oldCurrDesc) {
+          if (op.type == FIND) op.value = nodeDesc->value;
           ret = true;
           goto out;
         }
@@ -705,64 +941,508 @@ setval_t transskip_find_original(trans_skip* l, setkey_t k) {
   return (v);
 }
 
-void init_transskip_subsystem(void) {
-  int i;
+/*
+ * Physically remove @x, which @nodeDesc left logically absent. Marking the
+ * NodeDesc first makes sure only one thread removes it, and tells inserts of
+ * the same key to help unlink it and link a fresh node instead of reviving
+ * this one. Must be called inside a critical section.
+ */
+static void unlink_node(trans_skip* l, ptst_t* ptst, node_t* x,
+                        NodeDesc* nodeDesc) {
+  int level;
 
-  fr_init_ptst_subsystem();
-  fr_init_gc_subsystem();
+  if (!__sync_bool_compare_and_swap(&x->nodeDesc, nodeDesc,
+                                    SET_MARKD(nodeDesc))) {
+    return;
+  }
 
-  for (i = 0; i < NUM_LEVELS; i++) {
-    gc_id[i] = fr_gc_add_allocator(sizeof(node_t) + i * sizeof(node_t*));
+  READ_FIELD(level, x->level);
+  level = level & LEVEL_MASK;
+
+  /* Same hand-off as a plain delete: whoever of us and the inserter finishes
+   * with the node last frees it. */
+  mark_deleted(x, level);
+  WEAK_DEP_ORDER_WMB();
+  if (check_for_full_delete(x)) {
+    MB();
+    do_full_delete(ptst, l, x, level - 1);
+  } else {
+    (void)strong_search_predecessors(l, x->k, NULL, NULL);
   }
 }
 
-void destroy_transskip_subsystem(void) { fr_destroy_gc_subsystem(); }
+/*
+ * First node from @x on whose key is logically present, or the tail. Nodes
+ * @desc already holds are passed over. Nodes held by live transactions are
+ * helped first when @help is set, so the choice is made on settled state,
+ * and passed over otherwise. Settled absent nodes, such as aborted inserts,
+ * are unlinked on the way so they do not pile up at the front.
+ */
+static node_t* first_present(trans_skip* l, ptst_t* ptst, node_t* x,
+                             Desc* desc, bool help) {
+  uint64_t visited = 0;
 
-static inline bool help_ops(trans_skip* l, Desc* desc, uint8_t opid) {
-  bool ret = true;
-  // For less than 1 million nodes, it is faster not to delete nodes
-  // std::vector<node_t*> deletedNodes;
-  // std::vector<node_t*> insertedNodes;
+  for (; x != l->tail; x = (node_t*)get_unmarked_ref(x->next[0])) {
+    NodeDesc* nodeDesc = x->nodeDesc;
+    visited++;
 
-  // Cyclic dependcy check
-  if (helpStack.Contain(desc)) {
-    if (__sync_bool_compare_and_swap(&desc->status, LIVE, ABORTED)) {
-      __sync_fetch_and_add(&g_count_abort, 1);
-      __sync_fetch_and_add(&g_count_fake_abort, 1);
-    }
-    return false;
-  }
+    if (IS_MARKED(nodeDesc) || nodeDesc->desc == desc) continue;
 
-  helpStack.Push(desc);
+    if (nodeDesc->desc->status == LIVE) {
+      if (!help) continue;
 
-  while (desc->status == LIVE && ret && opid < desc->size) {
-    const Operator& op = desc->ops[opid];
-
-    if (op.type == INSERT) {
-      node_t* n;
-      ret = transskip_insert(l, op.key, desc, opid, n);
-      // insertedNodes.push_back(n);
-    } else if (op.type == DELETE) {
-      node_t* n;
-      ret = transskip_delete(l, op.key, desc, opid, n);
-      // deletedNodes.push_back(n);
-    } else {
-      ret = transskip_find(l, op.key, desc, opid);
+      FinishPendingTxn(l, nodeDesc, desc);
+      if (nodeDesc->desc->status == LIVE) continue;
     }
 
-    opid++;
+    if (IsKeyExist(nodeDesc)) break;
+
+    unlink_node(l, ptst, x, nodeDesc);
   }
 
-  helpStack.Pop();
+  TraversalStats& stats = g_traversal.Local();
+  stats.searches++;
+  stats.visited += visited;
 
-  if (ret == true) {
-    if (__sync_bool_compare_and_swap(&desc->status, LIVE, COMMITTED)) {
-      __sync_fetch_and_add(&g_count_commit, 1);
+  return x;
+}
 
-      // Mark nodes for physical deletion
-      // for(uint32_t i = 0; i < deletedNodes.size(); ++i)
-      //{
-      // node_t* x = deletedNodes[i];
+/*
+ * SprayList-style landing spot (Alistarh et al.): descend from the head,
+ * jumping a random 0..log(width) nodes at each of log(width) + 1 levels, so
+ * concurrent callers spread over the first keys instead of all meeting at
+ * the smallest one.
+ */
+static node_t* spray(trans_skip* l, ptst_t* ptst) {
+  int height = 0, i;
+  unsigned long jumps;
+  node_t *x, *x_next;
+
+  while ((1U << height) < l->spray_width && height < NUM_LEVELS - 1) height++;
+
+  x = &l->head;
+  for (i = height; i >= 0; i--) {
+    for (jumps = (rand_next(ptst) >> 16) % (height + 1); jumps > 0; jumps--) {
+      x_next = (node_t*)get_unmarked_ref(x->next[i]);
+      if (x_next == l->tail) break;
+      x = x_next;
+    }
+  }
+
+  return x == &l->head ? (node_t*)get_unmarked_ref(x->next[0]) : x;
+}
+
+/*
+ * Choose the key a DELETEMIN operation removes. The first helper to record
+ * a key in the operation decides it, so every thread running the
+ * transaction removes the same node. A smaller key inserted behind a scan
+ * is not seen by it, as with other lock-free skip list queues.
+ *
+ * With spraying, nodes other transactions hold are passed over instead of
+ * helped and the key is picked at random near the front; the exact scan is
+ * only the fallback for a queue that looks empty that way.
+ */
+static setkey_t select_min(trans_skip* l, Desc* desc, uint32_t opid) {
+  Operator& op = desc->ops[opid];
+  node_t* min = l->tail;
+  setkey_t key, old;
+  ptst_t* ptst;
+
+  if (op.key != DELETEMIN_KEY_UNSET) return op.key;
+
+  ptst = fr_critical_enter();
+
+  if (l->spray_width > 1) {
+    min = first_present(l, ptst, spray(l, ptst), desc, false);
+  }
+
+  if (min == l->tail) {
+    min = first_present(l, ptst, (node_t*)get_unmarked_ref(l->head.next[0]),
+                        desc, true);
+  }
+
+  key = (min == l->tail) ? DELETEMIN_KEY_EMPTY
+                         : INTERNAL_TO_CALLER_KEY(min->k);
+
+  fr_critical_exit(ptst);
+
+  old = __sync_val_compare_and_swap(&op.key, DELETEMIN_KEY_UNSET, key);
+
+  return old == DELETEMIN_KEY_UNSET ? key : old;
+}
+
+/*
+ * Unlink the node a committed DELETEMIN took. The node is looked up again so
+ * that a fresh node for the key is never mistaken for it.
+ */
+static void unlink_deleted(trans_skip* l, Desc* desc, uint32_t opid) {
+  setkey_t k = CALLER_TO_INTERNAL_KEY(desc->ops[opid].key);
+  NodeDesc* nodeDesc;
+  ptst_t* ptst;
+  node_t* x;
+
+  ptst = fr_critical_enter();
+
+  x = weak_search_predecessors(l, k, NULL, NULL);
+  if (x->k != k) goto out;
+
+  nodeDesc = x->nodeDesc;
+  if (IS_MARKED(nodeDesc) || nodeDesc->desc != desc ||
+      nodeDesc->opid != opid) {
+    goto out;
+  }
+
+  unlink_node(l, ptst, x, nodeDesc);
+
+out:
+  fr_critical_exit(ptst);
+}
+
+bool transskip_delete_min(trans_skip* l, Desc* desc, uint32_t opid) {
+  node_t* n;
+  finger_t f;
+  setkey_t key = select_min(l, desc, opid);
+
+  if (key == DELETEMIN_KEY_EMPTY) return false;
+
+  init_finger(l, &f);
+
+  return transskip_delete(l, key, desc, opid, &f, n);
+}
+
+/*
+ * Make the ranges of @desc visible to writers before reading anything, see
+ * respect_ranges. Slots of finished transactions are taken over.
+ */
+static bool register_range(trans_skip* l, Desc* desc) {
+  Desc* other;
+  int i;
+
+  for (i = 0; i < RANGE_SLOTS; i++) {
+    other = l->ranges[i];
+
+    if (other == desc) return true;
+
+    if ((other == NULL || other->status != LIVE) &&
+        __sync_bool_compare_and_swap(&l->ranges[i], other, desc)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+static void release_ranges(trans_skip* l, Desc* desc) {
+  int i;
+
+  for (i = 0; i < RANGE_SLOTS; i++) {
+    if (l->ranges[i] == desc) {
+      __sync_bool_compare_and_swap(&l->ranges[i], desc, NULL);
+    }
+  }
+}
+
+/*
+ * Whether the key of a node @desc holds was there when op @opid of the same
+ * transaction ran: as the op holding it left it if that came earlier, as it
+ * found it otherwise. The ops got this far, so they all succeeded.
+ */
+static inline bool OwnKeyExist(NodeDesc* nodeDesc, uint32_t opid) {
+  uint8_t opType = nodeDesc->desc->ops[nodeDesc->opid].type;
+
+  if (nodeDesc->opid < opid) {
+    return opType != DELETE && opType != DELETEMIN;
+  }
+
+  return opType != INSERT;
+}
+
+/* Left in a result slot once execute_ops took the result out */
+#define RANGE_RESULT_TAKEN ((RangeResult*)1)
+
+/*
+ * Collect the keys of a range. What a thread reads while the transaction is
+ * live is what every other thread reads: writers that committed before the
+ * range registered are seen by all, live ones are helped to the end, and
+ * later ones cannot commit until the range is done. Each thread collects into
+ * a result of its own, and the first one done while the transaction is still
+ * live publishes it in the Desc. The others drop theirs.
+ */
+bool transskip_range(trans_skip* l, Desc* desc, uint32_t opid) {
+  const Operator& op = desc->ops[opid];
+  Range* range = (Range*)op.value;
+  RangeResult* volatile* slot = &GetRangeResults(desc)[opid];
+  setkey_t hi = CALLER_TO_INTERNAL_KEY(range->hi);
+  uint32_t limit = range->limit;
+  uint64_t visited = 0;
+  bool present;
+
+  RangeResult* result;
+  ptst_t* ptst;
+  node_t* x;
+
+  ASSERT(l->owner == NULL, "ranges do not go through an owner");
+
+  if (*slot != NULL) return desc->status == LIVE;
+
+  if (!register_range(l, desc)) return false;
+
+  result = (RangeResult*)malloc(sizeof(RangeResult) +
+                                limit * sizeof(setkey_t));
+  result->count = 0;
+
+  ptst = fr_critical_enter();
+
+  x = weak_search_predecessors(l, CALLER_TO_INTERNAL_KEY(op.key), NULL, NULL);
+
+  for (; x->k < hi && result->count < limit;
+       x = (node_t*)get_unmarked_ref(x->next[0])) {
+    NodeDesc* nodeDesc = x->nodeDesc;
+    visited++;
+
+    if (IS_MARKED(nodeDesc)) continue;
+
+    if (nodeDesc->desc == desc) {
+      present = OwnKeyExist(nodeDesc, opid);
+    } else {
+      FinishPendingTxn(l, nodeDesc, desc);
+      present = IsKeyExist(nodeDesc);
+    }
+
+    if (!present) continue;
+
+    if (desc->status != LIVE) break;
+
+    result->keys[result->count++] = INTERNAL_TO_CALLER_KEY(x->k);
+  }
+
+  fr_critical_exit(ptst);
+
+  if (desc->status != LIVE ||
+      !__sync_bool_compare_and_swap(slot, NULL, result)) {
+    free(result);
+  }
+
+  TraversalStats& stats = g_traversal.Local();
+  stats.searches++;
+  stats.visited += visited;
+
+  return desc->status == LIVE;
+}
+
+/*
+ * Hand the published results of the ranges of @desc over to their Ranges,
+ * once the transaction is over. A result published later by a helper that
+ * lost track would never be freed, so the slots are closed.
+ */
+static void take_ranges(Desc* desc) {
+  RangeResult* volatile* results = GetRangeResults(desc);
+  RangeResult* result;
+  Range* range;
+  uint32_t i;
+
+  for (i = 0; i < desc->size; i++) {
+    if (desc->ops[i].type != RANGE) continue;
+
+    result = __sync_lock_test_and_set(&results[i], RANGE_RESULT_TAKEN);
+    if (result == NULL) continue;
+
+    if (desc->status == COMMITTED) {
+      range = (Range*)desc->ops[i].value;
+      range->count = result->count;
+      memcpy(range->keys, result->keys, result->count * sizeof(setkey_t));
+    }
+
+    free(result);
+  }
+}
+
+void transskip_set_spray(trans_skip* l, unsigned int threads) {
+  l->spray_width = threads;
+}
+
+void init_transskip_subsystem(void) {
+  int i;
+
+  fr_init_ptst_subsystem();
+  fr_init_gc_subsystem();
+
+  for (i = 0; i < NUM_LEVELS; i++) {
+    gc_id[i] = fr_gc_add_allocator(sizeof(node_t) + i * sizeof(node_t*));
+  }
+}
+
+void destroy_transskip_subsystem(void) { fr_destroy_gc_subsystem(); }
+
+void transskip_set_owner(trans_skip* l, void* owner, transskip_help_fn help) {
+  l->owner = owner;
+  l->help = help;
+}
+
+static bool execute_op(trans_skip* l, Desc* desc, uint32_t opid,
+                       finger_t* f) {
+  const Operator& op = desc->ops[opid];
+  node_t* n;
+
+  if (op.type == INSERT) {
+    return transskip_insert(l, op.key, desc, opid, f, n);
+  } else if (op.type == DELETE) {
+    return transskip_delete(l, op.key, desc, opid, f, n);
+  } else if (op.type == DELETEMIN) {
+    return transskip_delete_min(l, desc, opid);
+  } else if (op.type == RANGE) {
+    return transskip_range(l, desc, opid);
+  } else {
+    return transskip_find(l, op.key, desc, opid, f);
+  }
+}
+
+bool transskip_execute_op(trans_skip* l, Desc* desc, uint32_t opid) {
+  finger_t f;
+
+  init_finger(l, &f);
+
+  return execute_op(l, desc, opid, &f);
+}
+
+static inline bool is_older(Desc* desc1, Desc* desc2) {
+  unsigned int stamp1, stamp2;
+
+  if (desc1->size == 0 || desc2->size == 0 ||
+      !(desc1->ops[0].type & desc2->ops[0].type & OP_DYNAMIC)) {
+    return false;
+  }
+
+  stamp1 = GetProgram(desc1)->stamp;
+  stamp2 = GetProgram(desc2)->stamp;
+
+  return stamp1 != 0 && stamp2 != 0 && (int)(stamp1 - stamp2) < 0;
+}
+
+/*
+ * @desc is on the help stack, so helping it waits on itself. Break the cycle
+ * by aborting @desc, or the transaction on top of the stack if @desc is an
+ * older wait-free one.
+ */
+static inline void abort_cycle(Desc* desc) {
+  Desc* victim = is_older(desc, helpStack.Top()) ? helpStack.Top() : desc;
+
+  if (__sync_bool_compare_and_swap(&victim->status, LIVE, ABORTED)) {
+    __sync_fetch_and_add(&g_count_abort, 1);
+    __sync_fetch_and_add(&g_count_fake_abort, 1);
+  }
+}
+
+/*
+ * Whether a range of @range covers @k, given as the caller sees keys.
+ */
+static bool in_range(Desc* range, setkey_t k) {
+  for (uint32_t i = 0; i < range->size; i++) {
+    const Operator& op = range->ops[i];
+
+    if (op.type == RANGE && op.key <= k && k < ((Range*)op.value)->hi) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/*
+ * Checked by whoever commits @desc, once all its nodes are taken over. A
+ * range registered before this sees the writes of @desc only by helping it,
+ * and may have read past their keys already, so @desc has to give way to
+ * it. A range registered after this sees all of them. Finished ranges are
+ * cleared from their slots on the way.
+ */
+static bool respect_ranges(trans_skip* l, Desc* desc) {
+  Desc* range;
+  uint8_t type;
+  int i;
+
+  for (i = 0; i < RANGE_SLOTS; i++) {
+    range = l->ranges[i];
+
+    if (range == NULL || range == desc) continue;
+
+    if (range->status != LIVE) {
+      __sync_bool_compare_and_swap(&l->ranges[i], range, NULL);
+      continue;
+    }
+
+    for (uint32_t j = 0; j < desc->size; j++) {
+      type = desc->ops[j].type;
+
+      if (type & OP_DYNAMIC) {
+        if (GetProgram(desc)->steps[j].result != STEP_SUCCEEDED) continue;
+        type &= ~OP_DYNAMIC;
+      }
+
+      if (type == FIND || type == RANGE) continue;
+
+      if (in_range(range, desc->ops[j].key)) return false;
+    }
+  }
+
+  return true;
+}
+
+static inline bool help_ops(trans_skip* l, Desc* desc, uint32_t opid) {
+  bool ret = true;
+  finger_t finger;
+  ptst_t* ptst;
+  // For less than 1 million nodes, it is faster not to delete nodes
+  // std::vector<node_t*> deletedNodes;
+  // std::vector<node_t*> insertedNodes;
+
+  // Cyclic dependcy check
+  if (helpStack.Contain(desc)) {
+    abort_cycle(desc);
+    return false;
+  }
+
+  helpStack.Push(desc);
+
+  // Nodes the finger points at must not be freed between ops
+  ptst = fr_critical_enter();
+  init_finger(l, &finger);
+
+  for (uint32_t run = 1; desc->status == LIVE && ret && opid < desc->size;
+       run++) {
+    ret = execute_op(l, desc, opid, &finger);
+
+    opid++;
+
+    if (run % FINGER_OPS == 0) {
+      fr_critical_exit(ptst);
+      ptst = fr_critical_enter();
+      init_finger(l, &finger);
+    }
+  }
+
+  fr_critical_exit(ptst);
+
+  helpStack.Pop();
+
+  if (ret == true && !respect_ranges(l, desc)) {
+    ret = false;
+  }
+
+  if (ret == true) {
+    if (__sync_bool_compare_and_swap(&desc->status, LIVE, COMMITTED)) {
+      __sync_fetch_and_add(&g_count_commit, 1);
+
+      // Popped keys would otherwise pile up in front of the next DELETEMIN
+      for (uint32_t i = 0; i < desc->size; i++) {
+        if (desc->ops[i].type == DELETEMIN) {
+          unlink_deleted(l, desc, i);
+        }
+      }
+
+      // Mark nodes for physical deletion
+      // for(uint32_t i = 0; i < deletedNodes.size(); ++i)
+      //{
+      // node_t* x = deletedNodes[i];
       // if(x == NULL) { continue; }
 
       // NodeDesc* nodeDesc = x->nodeDesc;
@@ -801,13 +1481,247 @@ static inline bool help_ops(trans_skip* l, Desc* desc, uint8_t opid) {
 }
 
 bool execute_ops(trans_skip* l, Desc* desc) {
+  bool ranges = false;
+
+  for (uint32_t i = 0; i < desc->size; i++) {
+    if (desc->ops[i].type == RANGE) {
+      GetRangeResults(desc)[i] = NULL;
+      ranges = true;
+    }
+  }
+
   helpStack.Init();
+  l->size.Begin(desc);
 
   bool ret = help_ops(l, desc, 0);
 
+  l->size.End();
+
+  if (ranges) {
+    release_ranges(l, desc);
+    take_ranges(desc);
+  }
+
   return ret;
 }
 
+static void save_result(NodeDesc* nodeDesc) {
+  Desc* desc = nodeDesc->desc;
+  Operator& op = desc->ops[nodeDesc->opid];
+  uint8_t type = op.type & ~OP_DYNAMIC;
+  Step& step = GetProgram(desc)->steps[nodeDesc->opid];
+  bool succeeded = type == INSERT ? !nodeDesc->present : nodeDesc->present;
+
+  if (type == FIND && nodeDesc->present) op.value = nodeDesc->value;
+
+  __sync_bool_compare_and_swap(&step.result, STEP_PENDING,
+                               succeeded ? STEP_SUCCEEDED : STEP_FAILED);
+}
+
+/*
+ * Take the node of the key of op @opid over whether or not the op succeeds,
+ * so what it found holds until the transaction is done. A missing key gets a
+ * node that keeps it absent. Leaves the result in the step, unless the
+ * transaction is over.
+ */
+static void run_step(trans_skip* l, Desc* desc, uint32_t opid) {
+  Operator& op = desc->ops[opid];
+  uint8_t type = op.type & ~OP_DYNAMIC;
+  NodeDesc* nodeDesc = l->nodeDescAllocator->Alloc();
+  nodeDesc->desc = desc;
+  nodeDesc->opid = opid;
+
+  ptst_t* ptst;
+  node_t *preds[NUM_LEVELS], *succs[NUM_LEVELS];
+  node_t *succ, *new_node = NULL, *old_next;
+  int i, level;
+  setkey_t k = CALLER_TO_INTERNAL_KEY(op.key);
+
+  ptst = fr_critical_enter();
+
+  succ = weak_search_predecessors(l, k, preds, succs);
+
+  while (desc->status == LIVE) {
+    if (succ->k == k) {
+      NodeDesc* oldCurrDesc = succ->nodeDesc;
+
+      if (IS_MARKED(oldCurrDesc)) {
+        READ_FIELD(level, succ->level);
+        mark_deleted(succ, level & LEVEL_MASK);
+        succ = strong_search_predecessors(l, k, preds, succs);
+        continue;
+      }
+
+      if (oldCurrDesc->desc == desc) {
+        /* This op or a later one of ours got here first. */
+        if (oldCurrDesc->opid >= opid) {
+          if (oldCurrDesc->opid == opid) save_result(oldCurrDesc);
+          break;
+        }
+
+        nodeDesc->present = PresentAfter(oldCurrDesc);
+        nodeDesc->original = oldCurrDesc->original;
+        nodeDesc->value = oldCurrDesc->value;
+
+        /* An earlier op holds the key already, only a change needs a new
+         * hold. Otherwise @nodeDesc is not published and only carries what
+         * the op saw. */
+        if (type == FIND || (type == INSERT) == nodeDesc->present) {
+          nodeDesc->value = ValueAfter(oldCurrDesc);
+          save_result(nodeDesc);
+          break;
+        }
+      } else {
+        FinishPendingTxn(l, oldCurrDesc, desc);
+
+        if (desc->status != LIVE) break;
+
+        nodeDesc->present = IsKeyExist(oldCurrDesc);
+        nodeDesc->original = nodeDesc->present;
+        nodeDesc->value = CurrentValue(oldCurrDesc);
+      }
+
+      if (__sync_bool_compare_and_swap(&succ->nodeDesc, oldCurrDesc,
+                                       nodeDesc)) {
+        save_result(nodeDesc);
+        break;
+      }
+
+      continue;
+    }
+
+    /* Not in the list, link a node holding the key absent. */
+    if (new_node == NULL) {
+      new_node = alloc_node(ptst);
+      new_node->k = k;
+      new_node->v = (void*)0xf0f0f0f0;
+      new_node->nodeDesc = nodeDesc;
+    }
+    nodeDesc->present = false;
+    nodeDesc->original = false;
+    nodeDesc->value = 0;
+    level = new_node->level;
+
+    for (i = 0; i < level; i++) {
+      new_node->next[i] = succs[i];
+    }
+
+    WMB_NEAR_CAS();
+
+    old_next = CASPO(&preds[0]->next[0], succ, new_node);
+    if (old_next != succ) {
+      succ = strong_search_predecessors(l, k, preds, succs);
+      continue;
+    }
+
+    link_levels(l, ptst, new_node, level, preds, succs);
+    new_node = NULL;
+
+    save_result(nodeDesc);
+    break;
+  }
+
+  if (new_node != NULL) free_node(ptst, new_node);
+
+  fr_critical_exit(ptst);
+}
+
+static bool is_guard_open(Program* program, const Step& step) {
+  uint8_t result;
+
+  if (step.guard == STEP_ALWAYS) return true;
+
+  result = program->steps[step.dep].result;
+
+  return (step.guard == STEP_IF_SUCCEEDED && result == STEP_SUCCEEDED) ||
+         (step.guard == STEP_IF_FAILED && result == STEP_FAILED);
+}
+
+static void help_dynamic(trans_skip* l, Desc* desc, uint32_t opid) {
+  Program* program = GetProgram(desc);
+
+  if (desc->status != LIVE) return;
+
+  if (helpStack.Contain(desc)) {
+    abort_cycle(desc);
+    return;
+  }
+
+  helpStack.Push(desc);
+
+  for (; desc->status == LIVE && opid < desc->size; opid++) {
+    Step& step = program->steps[opid];
+
+    if (step.result != STEP_PENDING) continue;
+
+    if (!is_guard_open(program, step)) {
+      __sync_bool_compare_and_swap(&step.result, STEP_PENDING, STEP_SKIPPED);
+    } else if ((desc->ops[opid].type & ~OP_DYNAMIC) == DELETEMIN ||
+               (desc->ops[opid].type & ~OP_DYNAMIC) == RANGE) {
+      __sync_bool_compare_and_swap(&step.result, STEP_PENDING, STEP_FAILED);
+    } else {
+      run_step(l, desc, opid);
+    }
+  }
+
+  helpStack.Pop();
+
+  /* Failed ops are results, only a help cycle or a range aborts. */
+  if (!respect_ranges(l, desc)) {
+    if (__sync_bool_compare_and_swap(&desc->status, LIVE, ABORTED)) {
+      __sync_fetch_and_add(&g_count_abort, 1);
+    }
+  } else if (__sync_bool_compare_and_swap(&desc->status, LIVE, COMMITTED)) {
+    __sync_fetch_and_add(&g_count_commit, 1);
+  }
+}
+
+bool execute_dynamic(trans_skip* l, Desc*& desc, bool wait_free) {
+  Program* program = GetProgram(desc);
+  uint32_t i;
+
+  ASSERT(l->owner == NULL, "dynamic transactions do not go through an owner");
+
+  program->stamp = 0;
+
+  while (wait_free && program->stamp == 0) {
+    program->stamp = __sync_add_and_fetch(&l->stamp, 1);
+  }
+
+  for (i = 0; i < desc->size; i++) {
+    ASSERT(program->steps[i].guard == STEP_ALWAYS || program->steps[i].dep < i,
+           "guards read earlier ops");
+
+    desc->ops[i].type |= OP_DYNAMIC;
+    program->steps[i].result = STEP_PENDING;
+  }
+
+  for (;;) {
+    helpStack.Init();
+    l->size.Begin(desc);
+
+    help_dynamic(l, desc, 0);
+
+    l->size.End();
+
+    if (desc->status == COMMITTED || !wait_free) break;
+
+    /* Older transactions took precedence, go again with the same age. */
+    Desc* retry = l->descAllocator->Alloc();
+    memcpy(retry, desc, Desc::DynamicSizeOf(desc->size));
+    retry->status = LIVE;
+
+    program = GetProgram(retry);
+    for (i = 0; i < retry->size; i++) {
+      program->steps[i].result = STEP_PENDING;
+    }
+
+    desc = retry;
+  }
+
+  return desc->status == COMMITTED;
+}
+
 void transskip_print(trans_skip* l) {
   node_t* curr = l->head.next[0];
 
@@ -820,14 +1734,56 @@ void transskip_print(trans_skip* l) {
 }
 
 void transskip_free(trans_skip* l) {
-  printf("Total commit %u, abort (total/fake) %u/%u\n", g_count_commit,
-         g_count_abort, g_count_fake_abort);
-
   // transskip_print(l);
 }
 
-void ResetMetrics(trans_skip* l) {
-  g_count_commit = 0;
-  g_count_abort = 0;
-  g_count_fake_abort = 0;
+uint64_t transskip_size(trans_skip* l) { return l->size.Read(); }
+
+Metrics GetMetrics(trans_skip* l) {
+  Metrics metrics = {g_count_commit, g_count_abort, g_count_fake_abort};
+
+  metrics.parts = METRICS_TRAVERSAL | METRICS_MEMORY | METRICS_GC;
+  metrics.traversal = GetTraversalStats(l);
+  metrics.memory = GetMemoryStats(l);
+  fr_gc_get_stats(&metrics.gc);
+
+  return metrics;
+}
+
+TraversalStats GetTraversalStats(trans_skip* l) { return g_traversal.Sum(); }
+
+MemoryStats GetMemoryStats(trans_skip* l) {
+  MemoryStats stats = {};
+  node_t* x;
+  int i;
+
+  for (x = (node_t*)get_unmarked_ref(l->head.next[0]); x != l->tail;
+       x = (node_t*)get_unmarked_ref(x->next[0])) {
+    if (IsKeyExist(CLR_MARKD(x->nodeDesc))) {
+      stats.liveNodes++;
+    } else {
+      stats.deletedNodes++;
+    }
+  }
+
+  stats.descriptors = l->descAllocator->Allocated();
+
+  /* Head and tail come from the heap, nodes from the per-level GC pools. */
+  stats.bytesReserved =
+      2 * (sizeof(node_t) + (NUM_LEVELS - 1) * sizeof(node_t*));
+  stats.bytesUsed = stats.bytesReserved;
+
+  for (i = 0; i < NUM_LEVELS; i++) {
+    unsigned long reserved, used;
+    fr_gc_get_usage(gc_id[i], &reserved, &used);
+    stats.bytesReserved += reserved;
+    stats.bytesUsed += used;
+  }
+
+  stats.bytesReserved += l->descAllocator->BytesReserved() +
+                         l->nodeDescAllocator->BytesReserved();
+  stats.bytesUsed +=
+      l->descAllocator->BytesUsed() + l->nodeDescAllocator->BytesUsed();
+
+  return stats;
 }
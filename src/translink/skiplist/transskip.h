@@ -5,6 +5,10 @@
 
 #include "common/allocator.h"
 #include "common/assert.h"
+#include "common/memstats.h"
+#include "common/metrics.h"
+#include "common/sizecounter.h"
+#include "common/threadstats.h"
 
 typedef unsigned long setkey_t;
 typedef void* setval_t;
@@ -64,28 +68,69 @@ typedef void* setval_t;
  * Transaction Definitions
  */
 
+// Keys and values are 64 bits wide, so 64 bit ids and pointers to larger
+// values go in as they are
 struct Operator {
   uint8_t type;
-  uint32_t key;
+  setkey_t key;
+  uint64_t value;  // written by INSERT and UPDATE, read back by FIND
+};
+
+/*
+ * Behind the ops of a dynamic Desc, see execute_dynamic. A step runs its op
+ * when its guard holds for the result of the earlier op @dep, and records
+ * what became of it.
+ */
+struct Step {
+  uint32_t dep;
+  uint8_t guard;
+  volatile uint8_t result;
+};
+
+struct Program {
+  uint32_t stamp; /* age in wait-free mode, 0 otherwise */
+  Step steps[];
 };
 
 struct Desc {
-  static size_t SizeOf(uint8_t size) {
-    return sizeof(uint8_t) + sizeof(uint8_t) + sizeof(Operator) * size;
+  // Count the padding in front of ops too, or the last value overlaps the
+  // next descriptor in the pool
+  static size_t SizeOf(uint32_t size) {
+    return sizeof(Desc) + sizeof(Operator) * size;
+  }
+
+  static size_t DynamicSizeOf(uint32_t size) {
+    return SizeOf(size) + sizeof(Program) + sizeof(Step) * size;
+  }
+
+  // Room for the result of each OP_RANGE behind the ops, see GetRangeResults
+  static size_t RangeSizeOf(uint32_t size) {
+    return SizeOf(size) + sizeof(void*) * size;
   }
 
   volatile uint8_t status;
-  uint8_t size;
+  // Up to 16M ops. Packed in next to status, the header is no larger than
+  // with an 8 bit size.
+  uint32_t size : 24;
   Operator ops[];
 };
 
 struct NodeDesc {
-  NodeDesc(Desc* _desc, uint8_t _opid) : desc(_desc), opid(_opid) {}
+  NodeDesc(Desc* _desc, uint32_t _opid) : desc(_desc), opid(_opid), value(0) {}
 
   Desc* desc;
-  uint8_t opid;
+  uint32_t opid;
+  // Only kept for dynamic transactions: whether the op found the key, and
+  // whether it was there before the transaction
+  bool present;
+  bool original;
+  uint64_t value;  // value of the key before this operation
 };
 
+static inline Program* GetProgram(Desc* desc) {
+  return reinterpret_cast<Program*>(&desc->ops[desc->size]);
+}
+
 struct node_t {
   int level;
 #define LEVEL_MASK 0x0ff
@@ -98,10 +143,64 @@ struct node_t {
   node_t* next[1];
 };
 
+/*
+ * Range queries. An OP_RANGE operation collects the keys in [key, hi) into
+ * the Range its value points at, in order and up to limit of them. A range
+ * does not take the nodes it reads over. It registers with the set instead,
+ * and a transaction writing a key inside the live range of another one
+ * aborts when it would commit, so nothing the range read changes under it.
+ * Writers met on the way are helped first, and the range sees what earlier
+ * ops of its own transaction did. With RANGE_SLOTS ranges running, another
+ * one fails. Not for sets with an owner, and dynamic transactions fail
+ * ranges.
+ *
+ * Every thread running the range collects the keys on its own, and the first
+ * to finish publishes them in the Desc, which has to be laid out by
+ * Desc::RangeSizeOf. execute_ops copies them into @keys and @count once the
+ * transaction is over, so helpers that are late never write to the Range and
+ * the caller can reuse it right away.
+ */
+#define OP_RANGE 5
+#define RANGE_SLOTS 64
+
+struct Range {
+  setkey_t hi;
+  uint32_t limit;
+  uint32_t count; /* keys found */
+  setkey_t* keys;
+};
+
+struct RangeResult {
+  uint32_t count;
+  setkey_t keys[];
+};
+
+static inline RangeResult* volatile* GetRangeResults(Desc* desc) {
+  return reinterpret_cast<RangeResult* volatile*>(&desc->ops[desc->size]);
+}
+
+/*
+ * Structures built out of several containers share one Desc between them,
+ * and only the owner knows which container each op goes to. Helping then
+ * goes through it.
+ */
+typedef void (*transskip_help_fn)(void* owner, Desc* desc, uint32_t opid);
+
 struct trans_skip {
   Allocator<Desc>* descAllocator;
   Allocator<NodeDesc>* nodeDescAllocator;
 
+  unsigned int spray_width; /* 0 for an exact DELETEMIN */
+
+  void* owner; /* NULL unless the set shares its descriptors */
+  transskip_help_fn help;
+
+  unsigned int stamp; /* last age handed to a wait-free transaction */
+
+  Desc* volatile ranges[RANGE_SLOTS]; /* running range queries */
+
+  SizeCounter<Desc> size; /* see transskip_size */
+
   node_t* tail;
   node_t head;
 };
@@ -111,15 +210,75 @@ struct trans_skip {
  * We lose three values (conveniently at top end of key space).
  *  - Known invalid value to which all fields are initialised.
  *  - Sentinel key values for up to two dummy nodes.
+ * Prefixed, since the other skip lists define 32 bit ranges under the plain
+ * names.
+ */
+#define TRANSSKIP_KEY_MIN (0UL)
+#define TRANSSKIP_KEY_MAX ((~0UL) - 3)
+
+/*
+ * Operation type removing the smallest key, for using the set as a priority
+ * queue. The key is chosen while the transaction runs and stored back into
+ * the operation, so callers set it to DELETEMIN_KEY_UNSET; after commit it
+ * holds the removed key. An empty queue fails the operation. Unlike other
+ * deletes, the removed node is unlinked once the transaction commits, so
+ * the front of the list stays short.
+ */
+#define OP_DELETEMIN 3
+#define DELETEMIN_KEY_UNSET (~0UL)
+#define DELETEMIN_KEY_EMPTY ((~0UL) - 1)
+
+/*
+ * Using the set as a map. INSERT stores the value of its operation with the
+ * key, OP_UPDATE replaces the value of a key that is present and FIND copies
+ * the value it saw into its operation. A key's value is kept in the
+ * descriptors rather than in the node: it is the value of the last committed
+ * INSERT or UPDATE, and every NodeDesc records the value from before its own
+ * operation, so an aborted UPDATE or DELETE leaves the old value in place.
+ */
+#define OP_UPDATE 4
+
+/*
+ * Dynamic transactions. Each op has a Step: it runs if its guard holds for
+ * the result of an earlier op and is skipped otherwise, so the ops that run
+ * are picked from results as the transaction goes, and helpers replaying it
+ * read the same results from the Desc. Ops that fail do not abort, their
+ * step records it. An op sees what earlier ops of the transaction did to its
+ * key, and takes the key over either way, so what it found holds until the
+ * transaction is done. A FIND that finds the key copies its value into the
+ * op. DELETEMIN and OP_RANGE always fail.
  */
-#define KEY_MIN (0U)
-#define KEY_MAX ((~0U) - 3)
+#define OP_DYNAMIC 0x80
+
+#define STEP_ALWAYS 0
+#define STEP_IF_SUCCEEDED 1
+#define STEP_IF_FAILED 2
+
+#define STEP_PENDING 0
+#define STEP_SUCCEEDED 1
+#define STEP_FAILED 2
+#define STEP_SKIPPED 3
 
 void init_transskip_subsystem(void);
 void destroy_transskip_subsystem(void);
 
+/*
+ * Run @desc. Each op searches on from where the one before it left off when
+ * its key is not smaller, so transactions with their keys sorted ascending,
+ * like bulk loads, walk the list about once.
+ */
 bool execute_ops(trans_skip* l, Desc* desc);
 
+/*
+ * Run @desc, laid out by Desc::DynamicSizeOf, as a dynamic transaction. It
+ * only aborts in a help cycle or on writing into a live range. With
+ * @wait_free a cycle aborts the younger transaction, and an aborted one is
+ * rerun on a fresh copy keeping its age until it commits; @desc then points
+ * at that copy. Descriptors must come in DynamicSizeOf sized blocks. Not for
+ * sets with an owner.
+ */
+bool execute_dynamic(trans_skip* l, Desc*& desc, bool wait_free);
+
 /*
  * Allocate an empty set.
  */
@@ -128,6 +287,35 @@ trans_skip* transskip_alloc(Allocator<Desc>* _descAllocator,
 
 void transskip_free(trans_skip* l);
 
-void ResetMetrics(trans_skip* l);
+/*
+ * Relax DELETEMIN for @threads concurrent callers: instead of all contending
+ * for the smallest key, each one sprays to a random key near the front.
+ */
+void transskip_set_spray(trans_skip* l, unsigned int threads);
+
+/*
+ * Hand helping over to @owner, see transskip_help_fn. Every transaction on
+ * the set must then go through the owner.
+ */
+void transskip_set_owner(trans_skip* l, void* owner, transskip_help_fn help);
+
+/*
+ * Run op @opid of @desc on the set alone, for the owner of a shared
+ * descriptor. Returns false if the op failed.
+ */
+bool transskip_execute_op(trans_skip* l, Desc* desc, uint32_t opid);
+
+/*
+ * Number of keys in the set, as of one instant between the call and its
+ * return. Transactions run by execute_ops and execute_dynamic count, and
+ * those the owner runs for sets that have one.
+ */
+uint64_t transskip_size(trans_skip* l);
+
+Metrics GetMetrics(trans_skip* l);
+
+TraversalStats GetTraversalStats(trans_skip* l);
+
+MemoryStats GetMemoryStats(trans_skip* l);
 
 #endif /* __SET_H__ */
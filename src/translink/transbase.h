@@ -0,0 +1,188 @@
+#ifndef TRANSBASE_H
+#define TRANSBASE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "common/helpstack.h"
+
+// Descriptor of a transaction, laid out like the one of TransList
+template <typename Operator>
+struct TransDesc {
+  static size_t SizeOf(uint32_t size) {
+    return sizeof(TransDesc) + sizeof(Operator) * size;
+  }
+
+  // ACTIVE, COMMITTED or ABORTED, see TransBase::OpStatus
+  volatile uint8_t status;
+  // Up to 16M ops. Packed in next to status, the header is no larger than
+  // with an 8 bit size.
+  uint32_t size : 24;
+  Operator ops[];
+};
+
+// The op that last took over a node. Structures that keep more per op derive
+// from it.
+template <typename Desc>
+struct TransNodeDesc {
+  TransNodeDesc(Desc* _desc, uint32_t _opid) : desc(_desc), opid(_opid) {}
+
+  Desc* desc;
+  uint32_t opid;
+};
+
+// The transaction protocol of TransList, for the structures that run the ops
+// of a transaction one after another and take each node over with a NodeDesc
+// CAS. Derived runs a single op in
+//
+//   ReturnCode RunOp(Desc* desc, uint32_t opid);
+//
+// and gets the rest from here: an op that runs into a node held by a live
+// transaction finishes that transaction first, and a transaction met again in
+// its own help chain aborts. Derived is incomplete where it derives from
+// TransBase, so the members taking its Desc and NodeDesc are templates.
+//
+// Like TransList, a structure can also hand its Desc over to an owner that
+// spreads one transaction over several containers, see SetOwner.
+template <typename Derived>
+class TransBase {
+ public:
+  enum OpStatus {
+    ACTIVE = 0,
+    COMMITTED,
+    ABORTED,
+  };
+
+  enum ReturnCode { OK = 0, SKIP, FAIL };
+
+  // Ops of the sets and maps, only maps take UPDATE
+  enum OpType { FIND = 0, INSERT, DELETE, UPDATE };
+
+  // Structures built out of several containers share one Desc between them,
+  // and only the owner knows which container each op goes to. Helping then
+  // goes through it. The Desc is passed untyped, as Derived's is not known
+  // yet here.
+  typedef void (*HelpFn)(void* owner, void* desc, uint32_t opid);
+
+  void SetOwner(void* owner, HelpFn help) {
+    m_owner = owner;
+    m_help = help;
+  }
+
+  // Runs op opid of desc on this structure alone, for the owner of a shared
+  // Desc. Returns false if the op failed.
+  template <typename Desc>
+  bool ExecuteOp(Desc* desc, uint32_t opid) {
+    return static_cast<Derived*>(this)->RunOp(desc, opid) != FAIL;
+  }
+
+ protected:
+  template <typename Desc>
+  bool ExecuteDesc(Desc* desc) {
+    Helps<Desc>().Init();
+
+    HelpOps(desc, 0);
+
+    return desc->status != ABORTED;
+  }
+
+  template <typename Desc>
+  void HelpOps(Desc* desc, uint32_t opid) {
+    if (desc->status != ACTIVE) {
+      return;
+    }
+
+    HelpStack<Desc>& helps = Helps<Desc>();
+
+    // Cyclic dependcy check
+    if (helps.Contain(desc)) {
+      if (__sync_bool_compare_and_swap(&desc->status, ACTIVE, ABORTED)) {
+        __sync_fetch_and_add(&g_count_abort, 1);
+        __sync_fetch_and_add(&g_count_fake_abort, 1);
+      }
+
+      return;
+    }
+
+    ReturnCode ret = OK;
+
+    helps.Push(desc);
+
+    while (desc->status == ACTIVE && ret != FAIL && opid < desc->size) {
+      ret = static_cast<Derived*>(this)->RunOp(desc, opid);
+      opid++;
+    }
+
+    helps.Pop();
+
+    if (ret != FAIL) {
+      if (__sync_bool_compare_and_swap(&desc->status, ACTIVE, COMMITTED)) {
+        __sync_fetch_and_add(&g_count_commit, 1);
+      }
+    } else {
+      if (__sync_bool_compare_and_swap(&desc->status, ACTIVE, ABORTED)) {
+        __sync_fetch_and_add(&g_count_abort, 1);
+      }
+    }
+  }
+
+  template <typename NodeDesc, typename Desc>
+  void FinishPendingTxn(NodeDesc* nodeDesc, Desc* desc) {
+    // The node accessed by the operations in same transaction is always active
+    if (nodeDesc->desc == desc) {
+      return;
+    }
+
+    HelpTxn(nodeDesc->desc, nodeDesc->opid + 1);
+  }
+
+  // Helps desc on from op opid, through the owner when there is one
+  template <typename Desc>
+  void HelpTxn(Desc* desc, uint32_t opid) {
+    if (m_owner != NULL) {
+      m_help(m_owner, desc, opid);
+    } else {
+      HelpOps(desc, opid);
+    }
+  }
+
+  template <typename NodeDesc>
+  static bool IsSameOperation(NodeDesc* nodeDesc1, NodeDesc* nodeDesc2) {
+    return nodeDesc1->desc == nodeDesc2->desc &&
+           nodeDesc1->opid == nodeDesc2->opid;
+  }
+
+  template <typename NodeDesc>
+  static bool IsNodeActive(NodeDesc* nodeDesc) {
+    return nodeDesc->desc->status == COMMITTED;
+  }
+
+  // Whether the key of a node is in the set or map, for NodeDescs of OpType
+  // ops. A FIND or UPDATE only took the node over because the key was there.
+  template <typename NodeDesc>
+  static bool IsKeyExist(NodeDesc* nodeDesc) {
+    bool isNodeActive = IsNodeActive(nodeDesc);
+    uint8_t opType = nodeDesc->desc->ops[nodeDesc->opid].type;
+
+    return (opType == FIND) || (opType == UPDATE) ||
+           (isNodeActive && opType == INSERT) ||
+           (!isNodeActive && opType == DELETE);
+  }
+
+  // One stack per thread and Desc type, so the buffer goes with the thread
+  template <typename Desc>
+  static HelpStack<Desc>& Helps() {
+    static thread_local HelpStack<Desc> helps;
+
+    return helps;
+  }
+
+  void* m_owner = NULL;
+  HelpFn m_help = NULL;
+
+  uint32_t g_count_commit = 0;
+  uint32_t g_count_abort = 0;
+  uint32_t g_count_fake_abort = 0;
+};
+
+#endif /* end of include guard: TRANSBASE_H */
@@ -0,0 +1,300 @@
+//------------------------------------------------------------------------------
+//
+//
+//
+//------------------------------------------------------------------------------
+
+#include "translink/vector/transvector.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+TransVector::TransVector(Allocator<Desc>* descAllocator,
+                         Allocator<NodeDesc>* nodeDescAllocator,
+                         Allocator<SizeDesc>* sizeDescAllocator)
+    : m_descAllocator(descAllocator),
+      m_nodeDescAllocator(nodeDescAllocator),
+      m_sizeDescAllocator(sizeDescAllocator) {
+  for (uint32_t i = 0; i < BUCKETS; i++) {
+    m_buckets[i] = NULL;
+  }
+
+  // The vector starts out empty, as left behind by a committed transaction
+  Desc* desc = static_cast<Desc*>(malloc(Desc::SizeOf(0)));
+  desc->status = COMMITTED;
+  desc->size = 0;
+
+  m_size = new SizeDesc(desc, 0, 0, 0);
+}
+
+TransVector::~TransVector() {
+  for (uint32_t i = 0; i < BUCKETS; i++) {
+    free((void*)m_buckets[i]);
+  }
+}
+
+TransVector::Desc* TransVector::AllocateDesc(uint32_t size) {
+  Desc* desc = m_descAllocator->Alloc();
+  desc->size = size;
+  desc->status = ACTIVE;
+
+  return desc;
+}
+
+bool TransVector::ExecuteOps(Desc* desc) { return ExecuteDesc(desc); }
+
+TransVector::ReturnCode TransVector::RunOp(Desc* desc, uint32_t opid) {
+  const Operator& op = desc->ops[opid];
+
+  if (op.type == PUSH || op.type == POP) {
+    return Resize(desc, opid);
+  } else if (op.index > UINT32_MAX) {
+    // Past every bucket
+    return FAIL;
+  } else {
+    return UpdateSlot(op.index, desc, opid);
+  }
+}
+
+// A PUSH or POP first moves the size and then claims the slot it freed up or
+// took away
+inline TransVector::ReturnCode TransVector::Resize(Desc* desc, uint32_t opid) {
+  uint32_t index;
+  ReturnCode ret = SwapSize(desc, opid, index);
+
+  if (ret != OK) {
+    return ret;
+  }
+
+  return UpdateSlot(index, desc, opid);
+}
+
+// Moves the size one up for a PUSH or one down for a POP, and sets index to
+// the slot the op goes on. Returns SKIP when a later op of the transaction
+// already replaced the SizeDesc, which means this one is done.
+inline TransVector::ReturnCode TransVector::SwapSize(Desc* desc, uint32_t opid,
+                                                     uint32_t& index) {
+  bool push = desc->ops[opid].type == PUSH;
+  SizeDesc* sizeDesc = NULL;
+
+  while (true) {
+    SizeDesc* oldSizeDesc = m_size;
+
+    // The op that set the size may not have claimed its slot yet, so helping
+    // starts over from that op
+    if (oldSizeDesc->desc != desc) {
+      HelpTxn(oldSizeDesc->desc, oldSizeDesc->opid);
+    }
+
+    if (oldSizeDesc->desc == desc && oldSizeDesc->opid >= opid) {
+      if (oldSizeDesc->opid > opid) {
+        return SKIP;
+      }
+
+      index = push ? oldSizeDesc->after - 1 : oldSizeDesc->after;
+      return OK;
+    }
+
+    uint32_t size = CurrentSize(oldSizeDesc, desc);
+
+    if (!push && size == 0) {
+      return FAIL;
+    }
+
+    if (desc->status != ACTIVE) {
+      return FAIL;
+    }
+
+    if (sizeDesc == NULL) {
+      sizeDesc = m_sizeDescAllocator->Alloc();
+    }
+
+    // Earlier ops of the transaction already recorded the size to go back to
+    new (sizeDesc) SizeDesc(
+        desc, opid, oldSizeDesc->desc == desc ? oldSizeDesc->before : size,
+        push ? size + 1 : size - 1);
+
+    if (__sync_bool_compare_and_swap(&m_size, oldSizeDesc, sizeDesc)) {
+      index = push ? size : size - 1;
+      return OK;
+    }
+
+    m_traversal.Local().restarts++;
+  }
+}
+
+// Swaps the NodeDesc of op opid into the slot at index. PUSH needs the slot
+// dead and everything else needs it live.
+inline TransVector::ReturnCode TransVector::UpdateSlot(uint32_t index,
+                                                       Desc* desc,
+                                                       uint32_t opid) {
+  Operator& op = desc->ops[opid];
+  NodeDesc* volatile* slot = At(index, op.type == PUSH);
+
+  m_traversal.Local().searches++;
+
+  // Past every bucket pushed so far
+  if (slot == NULL) {
+    return FAIL;
+  }
+
+  NodeDesc* nodeDesc = new (m_nodeDescAllocator->Alloc()) NodeDesc(desc, opid);
+
+  while (true) {
+    NodeDesc* oldCurrDesc = *slot;
+
+    if (oldCurrDesc != NULL) {
+      FinishPendingTxn(oldCurrDesc, desc);
+
+      if (IsSameOperation(oldCurrDesc, nodeDesc)) {
+        if (op.type == READ || op.type == POP) {
+          op.value = oldCurrDesc->result;
+        }
+
+        return SKIP;
+      }
+    }
+
+    bool live = oldCurrDesc != NULL && IsSlotLive(oldCurrDesc, desc);
+
+    if (live == (op.type == PUSH)) {
+      return FAIL;
+    }
+
+    if (desc->status != ACTIVE) {
+      return FAIL;
+    }
+
+    if (oldCurrDesc != NULL) {
+      // Earlier ops of the transaction already recorded the slot to go back to
+      if (oldCurrDesc->desc == desc) {
+        nodeDesc->live = oldCurrDesc->live;
+        nodeDesc->value = oldCurrDesc->value;
+      } else {
+        nodeDesc->live = live;
+        nodeDesc->value = CurrentValue(oldCurrDesc, desc);
+      }
+
+      nodeDesc->result = CurrentValue(oldCurrDesc, desc);
+    }
+
+    if (__sync_bool_compare_and_swap(slot, oldCurrDesc, nodeDesc)) {
+      if (op.type == READ || op.type == POP) {
+        op.value = nodeDesc->result;
+      }
+
+      return OK;
+    }
+
+    m_traversal.Local().restarts++;
+  }
+}
+
+// Slot of index, allocating its bucket when asked to. Returns NULL for an
+// index in a bucket that is not there.
+inline TransVector::NodeDesc* volatile* TransVector::At(uint32_t index,
+                                                        bool allocate) {
+  uint64_t pos = (uint64_t)index + FIRST_BUCKET_SIZE;
+  uint32_t hibit = 63 - __builtin_clzll(pos);
+  uint32_t bucket = hibit - __builtin_ctz(FIRST_BUCKET_SIZE);
+  NodeDesc* volatile* slots = m_buckets[bucket];
+
+  if (slots == NULL) {
+    if (!allocate) {
+      return NULL;
+    }
+
+    uint64_t count = (uint64_t)FIRST_BUCKET_SIZE << bucket;
+    NodeDesc** fresh =
+        static_cast<NodeDesc**>(calloc(count, sizeof(NodeDesc*)));
+
+    ASSERT(fresh, "Bucket allocation failed.");
+
+    if (!__sync_bool_compare_and_swap(&m_buckets[bucket], NULL, fresh)) {
+      free(fresh);
+    }
+
+    slots = m_buckets[bucket];
+  }
+
+  return &slots[pos ^ (1ULL << hibit)];
+}
+
+// Whether desc sees the slot live. Ops of desc itself and of committed
+// transactions count, everything else leaves the slot as it was before.
+inline bool TransVector::IsSlotLive(NodeDesc* nodeDesc, Desc* desc) {
+  if (nodeDesc->desc == desc || IsNodeActive(nodeDesc)) {
+    return nodeDesc->desc->ops[nodeDesc->opid].type != POP;
+  }
+
+  return nodeDesc->live;
+}
+
+// Value desc sees in the slot, on the same terms as IsSlotLive
+inline uint64_t TransVector::CurrentValue(NodeDesc* nodeDesc, Desc* desc) {
+  if (nodeDesc->desc == desc || IsNodeActive(nodeDesc)) {
+    const Operator& op = nodeDesc->desc->ops[nodeDesc->opid];
+
+    return op.type == PUSH || op.type == WRITE ? op.value : nodeDesc->result;
+  }
+
+  return nodeDesc->value;
+}
+
+inline uint32_t TransVector::CurrentSize(SizeDesc* sizeDesc, Desc* desc) {
+  if (sizeDesc->desc == desc || sizeDesc->desc->status == COMMITTED) {
+    return sizeDesc->after;
+  }
+
+  return sizeDesc->before;
+}
+
+MemoryStats TransVector::GetMemoryStats() {
+  MemoryStats stats = {};
+  uint64_t bucketBytes = 0;
+
+  for (uint32_t b = 0; b < BUCKETS; b++) {
+    uint64_t count = (uint64_t)FIRST_BUCKET_SIZE << b;
+
+    if (m_buckets[b] == NULL) {
+      continue;
+    }
+
+    for (uint64_t i = 0; i < count; i++) {
+      NodeDesc* nodeDesc = m_buckets[b][i];
+
+      if (nodeDesc == NULL) {
+        continue;
+      }
+
+      if (IsSlotLive(nodeDesc, NULL)) {
+        stats.liveNodes++;
+      } else {
+        stats.deletedNodes++;
+      }
+    }
+
+    bucketBytes += count * sizeof(NodeDesc*);
+  }
+
+  stats.descriptors = m_descAllocator->Allocated();
+
+  // Buckets come from the heap, everything else from the pools
+  stats.AddHeap(bucketBytes);
+  stats.AddPool(m_descAllocator);
+  stats.AddPool(m_nodeDescAllocator);
+  stats.AddPool(m_sizeDescAllocator);
+
+  return stats;
+}
+
+Metrics TransVector::GetMetrics() {
+  Metrics metrics = {g_count_commit, g_count_abort, g_count_fake_abort};
+
+  metrics.parts = METRICS_TRAVERSAL | METRICS_MEMORY;
+  metrics.traversal = m_traversal.Sum();
+  metrics.memory = GetMemoryStats();
+
+  return metrics;
+}
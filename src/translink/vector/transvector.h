@@ -0,0 +1,106 @@
+#ifndef TRANSVECTOR_H
+#define TRANSVECTOR_H
+
+#include <cstdint>
+
+#include "common/allocator.h"
+#include "common/assert.h"
+#include "common/memstats.h"
+#include "common/metrics.h"
+#include "common/threadstats.h"
+#include "translink/transbase.h"
+
+// Transactional vector on the two-level bucket array of Dechev, Pirkelbauer
+// and Stroustrup ("Lock-free Dynamically Resizable Arrays"). Bucket b holds
+// FIRST_BUCKET_SIZE << b slots and is allocated by the first push that needs
+// it, so slots never move and the array grows without copying.
+//
+// Every slot holds the NodeDesc of the last op on it, which gives the slot
+// the logical status of a TransList node: a push makes it live once its
+// transaction commits, a pop makes it dead, and reads and writes need it
+// live. The value of a slot is carried in the NodeDesc like in TransSkip's
+// map ops, the op keeping the new value. The NodeDesc also keeps the status
+// and value the slot had before the transaction, so a transaction sees its
+// own pushes, pops and writes while an abort leaves the slot as it was.
+//
+// The size takes the place of the write descriptor of the original: pushes
+// and pops swap in a SizeDesc with the size before and after, and the size
+// only takes the new value when that transaction commits.
+class TransVector : public TransBase<TransVector> {
+ public:
+  enum OpType { READ = 0, PUSH, POP, WRITE };
+
+  // Laid out like the ops of TransSkip, so TransMulti can carry vector ops in
+  // its Desc
+  struct Operator {
+    uint8_t type;
+    uint64_t index;  // ignored by PUSH and POP
+    uint64_t value;  // for READ and POP, the value once it succeeds
+  };
+
+  typedef TransDesc<Operator> Desc;
+
+  struct NodeDesc : TransNodeDesc<Desc> {
+    NodeDesc(Desc* _desc, uint32_t _opid)
+        : TransNodeDesc<Desc>(_desc, _opid), live(false), value(0), result(0) {}
+
+    bool live;        // slot status before the transaction
+    uint64_t value;   // slot value before the transaction
+    uint64_t result;  // slot value before the op, what a READ or POP returns
+  };
+
+  struct SizeDesc {
+    SizeDesc(Desc* _desc, uint32_t _opid, uint32_t _before, uint32_t _after)
+        : desc(_desc), opid(_opid), before(_before), after(_after) {}
+
+    Desc* desc;
+    uint32_t opid;
+    uint32_t before;  // size if the transaction does not commit
+    uint32_t after;
+  };
+
+  static const uint32_t FIRST_BUCKET_SIZE = 8;
+  // Enough buckets for every 32 bit index
+  static const uint32_t BUCKETS = 30;
+
+  TransVector(Allocator<Desc>* descAllocator,
+              Allocator<NodeDesc>* nodeDescAllocator,
+              Allocator<SizeDesc>* sizeDescAllocator);
+  ~TransVector();
+
+  bool ExecuteOps(Desc* desc);
+
+  Desc* AllocateDesc(uint32_t size);
+
+  Metrics GetMetrics();
+
+  TraversalStats GetTraversalStats() const { return m_traversal.Sum(); }
+
+  MemoryStats GetMemoryStats();
+
+ private:
+  friend class TransBase<TransVector>;
+
+  ReturnCode RunOp(Desc* desc, uint32_t opid);
+  ReturnCode Resize(Desc* desc, uint32_t opid);
+
+  bool IsSlotLive(NodeDesc* nodeDesc, Desc* desc);
+  uint64_t CurrentValue(NodeDesc* nodeDesc, Desc* desc);
+  uint32_t CurrentSize(SizeDesc* sizeDesc, Desc* desc);
+
+  ReturnCode SwapSize(Desc* desc, uint32_t opid, uint32_t& index);
+  ReturnCode UpdateSlot(uint32_t index, Desc* desc, uint32_t opid);
+  NodeDesc* volatile* At(uint32_t index, bool allocate);
+
+ private:
+  NodeDesc* volatile* volatile m_buckets[BUCKETS];
+  SizeDesc* volatile m_size;
+
+  Allocator<Desc>* m_descAllocator;
+  Allocator<NodeDesc>* m_nodeDescAllocator;
+  Allocator<SizeDesc>* m_sizeDescAllocator;
+
+  ThreadStats<TraversalStats> m_traversal;
+};
+
+#endif /* end of include guard: TRANSVECTOR_H */